@@ -0,0 +1,157 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.hpp"
+
+#include <assets/level_loader.hpp>
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <benchmark/benchmark.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <vector>
+
+
+using namespace rigel;
+using namespace rigel::benchmarks;
+
+
+namespace
+{
+
+/** Maps of all levels available in the game data */
+const std::vector<data::map::Map>& allLevelMaps(GameDataEnvironment& env)
+{
+  static const auto maps = [&]() {
+    auto result = std::vector<data::map::Map>{};
+
+    for (auto i = 0; i < data::NUM_EPISODES * data::NUM_LEVELS_PER_EPISODE;
+         ++i)
+    {
+      const auto sessionId = sessionIdForBenchmarkArg(i);
+      const auto levelFile =
+        assets::levelFileName(sessionId.mEpisode, sessionId.mLevel);
+      if (env.mResources.hasFile(levelFile))
+      {
+        result.push_back(
+          assets::loadLevel(levelFile, env.mResources, sessionId.mDifficulty)
+            .mMap);
+      }
+    }
+
+    return result;
+  }();
+
+  return maps;
+}
+
+
+/** Returns the maps to use, or nullptr if the benchmark should be skipped */
+const std::vector<data::map::Map>* setUpSpanBenchmark(benchmark::State& state)
+{
+  auto pEnvironment = gameDataEnvironment();
+  if (!pEnvironment)
+  {
+    state.SkipWithError(
+      "Game data not found, set RIGEL_BENCHMARK_GAME_PATH to run this");
+    return nullptr;
+  }
+
+  return &allLevelMaps(*pEnvironment);
+}
+
+} // namespace
+
+
+/** Tests all horizontal spans of the given length on all maps */
+static void BMHorizontalSpanTests(benchmark::State& state)
+{
+  const auto pMaps = setUpSpanBenchmark(state);
+  if (!pMaps)
+  {
+    return;
+  }
+
+  const auto spanLength = int(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto numSolid = 0;
+
+    for (const auto& map : *pMaps)
+    {
+      for (auto y = 0; y < map.height(); ++y)
+      {
+        for (auto x = 0; x < map.width(); x += spanLength)
+        {
+          const auto endX = std::min(x + spanLength, map.width()) - 1;
+          numSolid +=
+            map.isSolidInRow(x, endX, y, data::map::SolidEdge::top());
+        }
+      }
+    }
+
+    benchmark::DoNotOptimize(numSolid);
+  }
+}
+
+BENCHMARK(BMHorizontalSpanTests)
+  ->Arg(3)
+  ->Arg(64)
+  ->Arg(1024)
+  ->Unit(benchmark::kMicrosecond);
+
+
+/** Tests all vertical spans of the given length on all maps */
+static void BMVerticalSpanTests(benchmark::State& state)
+{
+  const auto pMaps = setUpSpanBenchmark(state);
+  if (!pMaps)
+  {
+    return;
+  }
+
+  const auto spanLength = int(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto numSolid = 0;
+
+    for (const auto& map : *pMaps)
+    {
+      for (auto x = 0; x < map.width(); ++x)
+      {
+        for (auto y = 0; y < map.height(); y += spanLength)
+        {
+          const auto endY = std::min(y + spanLength, map.height()) - 1;
+          numSolid +=
+            map.isSolidInColumn(x, y, endY, data::map::SolidEdge::left());
+        }
+      }
+    }
+
+    benchmark::DoNotOptimize(numSolid);
+  }
+}
+
+BENCHMARK(BMVerticalSpanTests)
+  ->Arg(3)
+  ->Arg(64)
+  ->Arg(1024)
+  ->Unit(benchmark::kMicrosecond);
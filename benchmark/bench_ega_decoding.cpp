@@ -0,0 +1,194 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_utils.hpp"
+
+#include <assets/actor_image_package.hpp>
+#include <assets/ega_image_decoder.hpp>
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <benchmark/benchmark.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace rigel::benchmarks;
+using data::GameTraits;
+
+
+namespace
+{
+
+assets::ResourceLoader* resourcesOrSkip(benchmark::State& state)
+{
+  auto pEnvironment = gameDataEnvironment();
+  if (!pEnvironment)
+  {
+    state.SkipWithError(
+      "Game data not found, set RIGEL_BENCHMARK_GAME_PATH to run this");
+    return nullptr;
+  }
+
+  return &pEnvironment->mResources;
+}
+
+
+/** Names of all tile set files present in the game data */
+std::vector<std::string> tileSetFiles(const assets::ResourceLoader& resources)
+{
+  std::vector<std::string> result;
+
+  for (const auto suffix : std::string{"123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"})
+  {
+    auto name = std::string{"CZONE"} + suffix + ".MNI";
+    if (resources.hasFile(name))
+    {
+      result.push_back(std::move(name));
+    }
+  }
+
+  return result;
+}
+
+
+/** Frame headers of all decodable actor images, excluding the menu font */
+std::vector<assets::ActorFrameHeader> allActorFrames(
+  const assets::ActorImagePackage& package,
+  const std::size_t imageDataSize)
+{
+  std::vector<assets::ActorFrameHeader> result;
+
+  for (auto id = 0; id < data::TOTAL_NUM_ACTOR_IDS; ++id)
+  {
+    const auto actorId = static_cast<data::ActorID>(id);
+    if (actorId == data::ActorID::Menu_font_grayscale)
+    {
+      continue;
+    }
+
+    try
+    {
+      for (const auto& frame : package.loadActorInfo(actorId).mFrames)
+      {
+        const auto dataSize = std::size_t(
+          frame.mSizeInTiles.width * frame.mSizeInTiles.height *
+          int(GameTraits::bytesPerTile(data::TileImageType::Masked)));
+        if (frame.mFileOffset + dataSize <= imageDataSize)
+        {
+          result.push_back(frame);
+        }
+      }
+    }
+    catch (const std::invalid_argument&)
+    {
+      // Not all IDs are in use
+    }
+  }
+
+  return result;
+}
+
+} // namespace
+
+
+static void BMDecodeTileSets(benchmark::State& state)
+{
+  auto pResources = resourcesOrSkip(state);
+  if (!pResources)
+  {
+    return;
+  }
+
+  const auto tileSets = tileSetFiles(*pResources);
+
+  auto bytesProcessed = std::int64_t{0};
+  for (auto _ : state)
+  {
+    for (const auto& name : tileSets)
+    {
+      const auto data = pResources->file(name);
+      const auto tilesBegin =
+        data.begin() + GameTraits::CZone::attributeBytesTotal;
+      const auto maskedTilesBegin = tilesBegin +
+        GameTraits::CZone::numSolidTiles * GameTraits::CZone::tileBytes;
+
+      auto solidTiles = assets::loadTiledImage(
+        tilesBegin,
+        maskedTilesBegin,
+        GameTraits::CZone::tileSetImageWidth,
+        GameTraits::INGAME_PALETTE,
+        data::TileImageType::Unmasked);
+      auto maskedTiles = assets::loadTiledImage(
+        maskedTilesBegin,
+        data.end(),
+        GameTraits::CZone::tileSetImageWidth,
+        GameTraits::INGAME_PALETTE,
+        data::TileImageType::Masked);
+      benchmark::DoNotOptimize(solidTiles);
+      benchmark::DoNotOptimize(maskedTiles);
+
+      bytesProcessed += std::int64_t(std::distance(tilesBegin, data.end()));
+    }
+  }
+
+  state.SetBytesProcessed(bytesProcessed);
+}
+
+BENCHMARK(BMDecodeTileSets)->Unit(benchmark::kMillisecond);
+
+
+static void BMDecodeActorImages(benchmark::State& state)
+{
+  auto pResources = resourcesOrSkip(state);
+  if (!pResources)
+  {
+    return;
+  }
+
+  const auto imageData =
+    pResources->file(assets::ActorImagePackage::IMAGE_DATA_FILE);
+  const auto package = assets::ActorImagePackage{
+    imageData, pResources->file(assets::ActorImagePackage::ACTOR_INFO_FILE)};
+  const auto frames = allActorFrames(package, imageData.size());
+
+  auto bytesProcessed = std::int64_t{0};
+  for (auto _ : state)
+  {
+    for (const auto& frame : frames)
+    {
+      auto image = package.loadImage(frame, GameTraits::INGAME_PALETTE);
+      benchmark::DoNotOptimize(image);
+
+      bytesProcessed += std::int64_t{frame.mSizeInTiles.width} *
+        frame.mSizeInTiles.height *
+        std::int64_t(GameTraits::bytesPerTile(data::TileImageType::Masked));
+    }
+
+    auto font = package.loadFont();
+    benchmark::DoNotOptimize(font);
+  }
+
+  state.SetBytesProcessed(bytesProcessed);
+}
+
+BENCHMARK(BMDecodeActorImages)->Unit(benchmark::kMillisecond);
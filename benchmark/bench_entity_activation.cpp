@@ -0,0 +1,121 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <data/map.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <benchmark/benchmark.h>
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+constexpr auto MAP_WIDTH = 1024;
+constexpr auto MAP_HEIGHT = 256;
+
+
+/** Synthetic large level with the given number of actors
+ *
+ * Actors are spread out evenly across the map, using a fixed pseudo-random
+ * sequence so that all runs see the same layout.
+ */
+struct SyntheticLevel
+{
+  explicit SyntheticLevel(const int numActors)
+  {
+    auto seed = std::uint32_t{12345};
+    auto nextRandom = [&seed]() {
+      seed = seed * 1103515245u + 12345u;
+      return int((seed >> 16) & 0x7FFF);
+    };
+
+    for (auto i = 0; i < numActors; ++i)
+    {
+      auto entity = mEntityX.entities.create();
+      entity.assign<engine::components::WorldPosition>(
+        nextRandom() % MAP_WIDTH, nextRandom() % MAP_HEIGHT);
+      entity.assign<engine::components::BoundingBox>(
+        engine::components::BoundingBox{{0, 0}, {3, 3}});
+    }
+  }
+
+  /** Camera position for the given tick, scrolling across the map */
+  base::Vec2 cameraPosition(const int tick) const
+  {
+    const auto& viewportSize = data::GameTraits::mapViewportSize;
+    const auto maxX = MAP_WIDTH - viewportSize.width;
+    return {tick % maxX, (MAP_HEIGHT - viewportSize.height) / 2};
+  }
+
+  entityx::EntityX mEntityX;
+  data::map::Map mMap{
+    MAP_WIDTH,
+    MAP_HEIGHT,
+    data::map::TileAttributeDict{{0x0, 0xF}}};
+};
+
+} // namespace
+
+
+static void BMMarkActiveEntitiesFullScan(benchmark::State& state)
+{
+  auto level = SyntheticLevel{int(state.range(0))};
+
+  auto tick = 0;
+  for (auto _ : state)
+  {
+    engine::markActiveEntities(
+      level.mEntityX.entities,
+      level.cameraPosition(tick++),
+      data::GameTraits::mapViewportSize);
+  }
+}
+
+BENCHMARK(BMMarkActiveEntitiesFullScan)
+  ->RangeMultiplier(4)
+  ->Range(64, 16384)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMEntityActivationSystem(benchmark::State& state)
+{
+  auto level = SyntheticLevel{int(state.range(0))};
+  auto activationSystem = engine::EntityActivationSystem{
+    &level.mMap, level.mEntityX.entities, level.mEntityX.events};
+
+  auto tick = 0;
+  for (auto _ : state)
+  {
+    activationSystem.markActiveEntities(
+      level.cameraPosition(tick++), data::GameTraits::mapViewportSize);
+  }
+}
+
+BENCHMARK(BMEntityActivationSystem)
+  ->RangeMultiplier(4)
+  ->Range(64, 16384)
+  ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,378 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.hpp"
+
+#include <assets/level_loader.hpp>
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <frontend/game_runner.hpp>
+#include <game_logic/world_state.hpp>
+#include <game_logic_common/igame_world.hpp>
+#include <game_logic_common/rewind_history.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <benchmark/benchmark.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+
+using namespace rigel;
+using namespace rigel::benchmarks;
+
+
+namespace
+{
+
+constexpr auto NUM_LEVELS =
+  data::NUM_EPISODES * data::NUM_LEVELS_PER_EPISODE;
+
+
+/** A level loaded via assets::loadLevel(), ready for running systems on */
+struct LevelFixture
+{
+  LevelFixture(GameDataEnvironment& environment, data::GameSessionId sessionId)
+    : mpState(std::make_unique<game_logic::WorldState>(
+        &environment.mServiceProvider,
+        nullptr,
+        &environment.mResources,
+        &mPlayerState,
+        &environment.mUserProfile.mOptions,
+        &environment.mSpriteFactory,
+        sessionId,
+        assets::loadLevel(
+          assets::levelFileName(sessionId.mEpisode, sessionId.mLevel),
+          environment.mResources,
+          sessionId.mDifficulty)))
+  {
+    mpState->mCamera.centerViewOnPlayer();
+    markActiveEntities();
+  }
+
+  void markActiveEntities()
+  {
+    mpState->mEntityActivationSystem.markActiveEntities(
+      mpState->mCamera.position(), data::GameTraits::mapViewportSize);
+  }
+
+  data::PersistentPlayerState mPlayerState;
+  std::unique_ptr<game_logic::WorldState> mpState;
+};
+
+
+/** Returns environment if the level for the current benchmark is available
+ *
+ * Otherwise, marks the benchmark as skipped and returns nullptr.
+ */
+GameDataEnvironment* environmentForLevel(benchmark::State& state)
+{
+  auto pEnvironment = gameDataEnvironment();
+  if (!pEnvironment)
+  {
+    state.SkipWithError(
+      "Game data not found, set RIGEL_BENCHMARK_GAME_PATH to run this");
+    return nullptr;
+  }
+
+  const auto sessionId = sessionIdForBenchmarkArg(int(state.range(0)));
+  const auto levelFile =
+    assets::levelFileName(sessionId.mEpisode, sessionId.mLevel);
+  if (!pEnvironment->mResources.hasFile(levelFile))
+  {
+    state.SkipWithError("Level not available in this version of the game");
+    return nullptr;
+  }
+
+  state.SetLabel(levelFile);
+  return pEnvironment;
+}
+
+} // namespace
+
+
+static void BMGameWorldUpdate(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  auto playerState = data::PersistentPlayerState{};
+  auto pWorld = createGameWorld(
+    data::GameplayStyle::Enhanced,
+    &playerState,
+    sessionIdForBenchmarkArg(int(state.range(0))),
+    pEnvironment->context());
+
+  auto tick = 0;
+  for (auto _ : state)
+  {
+    pWorld->updateGameLogic(scriptedInput(tick));
+    pWorld->processEndOfFrameActions();
+    ++tick;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BMGameWorldUpdate)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMPhysicsSystem(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  auto fixture =
+    LevelFixture{*pEnvironment, sessionIdForBenchmarkArg(int(state.range(0)))};
+  auto& worldState = *fixture.mpState;
+
+  for (auto _ : state)
+  {
+    worldState.mPhysicsSystem.update(worldState.mEntities);
+  }
+}
+
+BENCHMARK(BMPhysicsSystem)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMBehaviorControllerSystem(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  auto fixture =
+    LevelFixture{*pEnvironment, sessionIdForBenchmarkArg(int(state.range(0)))};
+  auto& worldState = *fixture.mpState;
+
+  auto tick = 0;
+  for (auto _ : state)
+  {
+    worldState.mBehaviorControllerSystem.update(
+      worldState.mEntities,
+      game_logic::PerFrameState{
+        scriptedInput(tick),
+        data::GameTraits::mapViewportSize,
+        worldState.mRadarDishCounter.numRadarDishes(),
+        tick % 2 != 0,
+        false});
+    ++tick;
+  }
+}
+
+BENCHMARK(BMBehaviorControllerSystem)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMDamageInflictionSystem(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  auto fixture =
+    LevelFixture{*pEnvironment, sessionIdForBenchmarkArg(int(state.range(0)))};
+  auto& worldState = *fixture.mpState;
+
+  for (auto _ : state)
+  {
+    worldState.mDamageInflictionSystem.update(worldState.mEntities);
+  }
+}
+
+BENCHMARK(BMDamageInflictionSystem)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMMarkActiveEntities(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  auto fixture =
+    LevelFixture{*pEnvironment, sessionIdForBenchmarkArg(int(state.range(0)))};
+
+  for (auto _ : state)
+  {
+    fixture.markActiveEntities();
+  }
+}
+
+BENCHMARK(BMMarkActiveEntities)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMQuickSaveSnapshot(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  const auto sessionId = sessionIdForBenchmarkArg(int(state.range(0)));
+  auto fixture = LevelFixture{*pEnvironment, sessionId};
+
+  for (auto _ : state)
+  {
+    const auto snapshot =
+      game_logic::WorldStateSnapshot{*fixture.mpState, sessionId};
+    benchmark::DoNotOptimize(snapshot.mMap);
+  }
+}
+
+BENCHMARK(BMQuickSaveSnapshot)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+static void BMQuickLoadSnapshot(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  const auto sessionId = sessionIdForBenchmarkArg(int(state.range(0)));
+  auto fixture = LevelFixture{*pEnvironment, sessionId};
+  const auto snapshot =
+    game_logic::WorldStateSnapshot{*fixture.mpState, sessionId};
+
+  for (auto _ : state)
+  {
+    fixture.mpState->restoreFromSnapshot(
+      snapshot,
+      &pEnvironment->mServiceProvider,
+      &fixture.mPlayerState,
+      sessionId);
+  }
+}
+
+BENCHMARK(BMQuickLoadSnapshot)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+// Does the same as GameWorld::recordRewindState(). The level isn't updated
+// in between, so this covers the common case of the map staying unchanged.
+// The counters report the size of the map's tiles, and the average memory
+// used per history entry for the tiles and player state. Snapshots aren't
+// included in the latter, since their entities live on the heap.
+static void BMRewindRecording(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  const auto sessionId = sessionIdForBenchmarkArg(int(state.range(0)));
+  auto fixture = LevelFixture{*pEnvironment, sessionId};
+
+  auto history = game_logic::RewindHistory{game_logic::REWIND_HISTORY_LENGTH};
+  auto snapshots =
+    std::deque<std::unique_ptr<game_logic::WorldStateSnapshot>>{};
+  auto buffer = std::vector<std::uint8_t>{};
+
+  for (auto _ : state)
+  {
+    buffer.clear();
+    game_logic::appendMapTiles(fixture.mpState->mMap, buffer);
+    history.push(buffer, fixture.mPlayerState);
+
+    snapshots.push_back(std::make_unique<game_logic::WorldStateSnapshot>(
+      *fixture.mpState,
+      sessionId,
+      game_logic::SnapshotMapHandling::Exclude));
+
+    if (snapshots.size() > history.size())
+    {
+      snapshots.pop_front();
+    }
+  }
+
+  state.counters["mapTileBytes"] = double(buffer.size());
+  state.counters["historyBytesPerEntry"] =
+    double(history.storageSize()) / double(history.size());
+}
+
+BENCHMARK(BMRewindRecording)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
+
+
+// For comparison: Quick saves used to create a complete WorldState by loading
+// the level from disk, before copying over the current state. This
+// benchmark measures the loading part only, without any rendering resources.
+// The level is loaded via assets::loadLevel() directly, since the other
+// WorldState constructor goes through ResourceLoader's level cache.
+static void BMWorldStateFromLevelFile(benchmark::State& state)
+{
+  auto pEnvironment = environmentForLevel(state);
+  if (!pEnvironment)
+  {
+    return;
+  }
+
+  const auto sessionId = sessionIdForBenchmarkArg(int(state.range(0)));
+  const auto levelFile =
+    assets::levelFileName(sessionId.mEpisode, sessionId.mLevel);
+  auto playerState = data::PersistentPlayerState{};
+
+  for (auto _ : state)
+  {
+    const auto worldState = game_logic::WorldState{
+      &pEnvironment->mServiceProvider,
+      nullptr,
+      &pEnvironment->mResources,
+      &playerState,
+      &pEnvironment->mUserProfile.mOptions,
+      &pEnvironment->mSpriteFactory,
+      sessionId,
+      assets::loadLevel(
+        levelFile, pEnvironment->mResources, sessionId.mDifficulty)};
+    benchmark::DoNotOptimize(worldState.mMap);
+  }
+}
+
+BENCHMARK(BMWorldStateFromLevelFile)
+  ->DenseRange(0, NUM_LEVELS - 1)
+  ->Unit(benchmark::kMicrosecond);
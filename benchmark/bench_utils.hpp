@@ -0,0 +1,167 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <assets/resource_loader.hpp>
+#include <data/game_session_data.hpp>
+#include <data/player_model.hpp>
+#include <engine/sprite_factory.hpp>
+#include <frontend/command_line_options.hpp>
+#include <frontend/game_mode.hpp>
+#include <frontend/game_service_provider.hpp>
+#include <frontend/user_profile.hpp>
+#include <game_logic_common/input.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+
+namespace rigel::benchmarks
+{
+
+/** Service provider which does nothing, for running game logic headless */
+struct NullServiceProvider : public IGameServiceProvider
+{
+  void fadeOutScreen() override { }
+  void fadeInScreen() override { }
+  void playSound(data::SoundId) override { }
+  void stopSound(data::SoundId) override { }
+  void stopAllSounds() override { }
+  void playMusic(const std::string&) override { }
+  void stopMusic() override { }
+  void scheduleGameQuit() override { }
+  void switchGamePath(const std::filesystem::path&) override { }
+  void markCurrentFrameAsWidescreen() override { }
+  bool isSharewareVersion() const override { return false; }
+
+  const CommandLineOptions& commandLineOptions() const override
+  {
+    return mCommandLineOptions;
+  }
+
+  const GameControllerInfo& gameControllerInfo() const override
+  {
+    return mGameControllerInfo;
+  }
+
+  CommandLineOptions mCommandLineOptions;
+  GameControllerInfo mGameControllerInfo;
+};
+
+
+/** Everything needed to run game logic on the original game's data
+ *
+ * The game data is looked up in the directory given by the
+ * RIGEL_BENCHMARK_GAME_PATH environment variable. If that's not set, the game
+ * path from the user profile is used.
+ */
+struct GameDataEnvironment
+{
+  explicit GameDataEnvironment(const std::filesystem::path& gamePath)
+    : mResources(gamePath, false, {})
+    , mSpriteFactory(nullptr, &mResources)
+  {
+  }
+
+  GameMode::Context context()
+  {
+    return GameMode::Context{
+      &mResources,
+      nullptr,
+      &mServiceProvider,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      &mSpriteFactory,
+      &mUserProfile};
+  }
+
+  assets::ResourceLoader mResources;
+  engine::SpriteFactory mSpriteFactory;
+  NullServiceProvider mServiceProvider;
+  UserProfile mUserProfile;
+};
+
+
+/** Returns the shared game data environment, or nullptr if not available
+ *
+ * Loading the game data is fairly expensive, so this is only done once.
+ */
+inline GameDataEnvironment* gameDataEnvironment()
+{
+  static auto pEnvironment = []() -> std::unique_ptr<GameDataEnvironment> {
+    auto gamePath = std::filesystem::path{};
+
+    if (const auto pPathFromEnv = std::getenv("RIGEL_BENCHMARK_GAME_PATH"))
+    {
+      gamePath = std::filesystem::u8path(pPathFromEnv);
+    }
+    else
+    {
+      const auto profile = loadUserProfile();
+      if (profile && profile->mGamePath)
+      {
+        gamePath = *profile->mGamePath;
+      }
+    }
+
+    if (gamePath.empty() || !std::filesystem::exists(gamePath))
+    {
+      return nullptr;
+    }
+
+    return std::make_unique<GameDataEnvironment>(gamePath);
+  }();
+
+  return pEnvironment.get();
+}
+
+
+/** Maps a benchmark argument in range [0, 32) to a level */
+inline data::GameSessionId sessionIdForBenchmarkArg(const int arg)
+{
+  return data::GameSessionId{
+    arg / data::NUM_LEVELS_PER_EPISODE,
+    arg % data::NUM_LEVELS_PER_EPISODE,
+    data::Difficulty::Hard};
+}
+
+
+/** Deterministic input sequence which makes the player move around
+ *
+ * The player walks right and left in turns, jumping and shooting
+ * periodically. This exercises a good part of the game logic, as the player
+ * interacts with the environment and enemies.
+ */
+inline game_logic::PlayerInput scriptedInput(const int tick)
+{
+  const auto phase = tick % 64;
+
+  game_logic::PlayerInput input;
+  input.mRight = phase < 32;
+  input.mLeft = phase >= 32;
+  input.mJump.mIsPressed = phase % 16 < 4;
+  input.mJump.mWasTriggered = phase % 16 == 0;
+  input.mFire.mIsPressed = phase % 4 == 0;
+  input.mFire.mWasTriggered = phase % 4 == 0;
+  return input;
+}
+
+} // namespace rigel::benchmarks
@@ -35,8 +35,8 @@ using data::GameTraits;
 
 
 ActorImagePackage::ActorImagePackage(
-  ByteBuffer imageData,
-  const ByteBuffer& actorInfoData)
+  FileData imageData,
+  const ByteView actorInfoData)
   : mImageData(std::move(imageData))
 {
   LeStreamReader actorInfoReader(actorInfoData);
@@ -53,7 +53,12 @@ public:
   static constexpr auto IMAGE_DATA_FILE = "ACTORS.MNI";
   static constexpr auto ACTOR_INFO_FILE = "ACTRINFO.MNI";
 
-  ActorImagePackage(ByteBuffer imageData, const ByteBuffer& actorInfoData);
+  /** Parse the actor info
+   *
+   * The image data is not copied. The package keeps a reference to it
+   * instead, see FileData.
+   */
+  ActorImagePackage(FileData imageData, ByteView actorInfoData);
 
   const ActorHeader& loadActorInfo(data::ActorID id) const;
   data::Image loadImage(
@@ -73,7 +78,7 @@ public:
   }
 
 private:
-  const ByteBuffer mImageData;
+  const FileData mImageData;
   std::map<data::ActorID, ActorHeader> mHeadersById;
   std::vector<int> mDrawIndexById;
 };
@@ -38,7 +38,7 @@ struct AudioDictEntry
 };
 
 
-std::vector<AudioDictEntry> readAudioDict(const ByteBuffer& data)
+std::vector<AudioDictEntry> readAudioDict(const ByteView data)
 {
   const auto numOffsets = data.size() / sizeof(uint32_t);
 
@@ -94,8 +94,8 @@ AdlibSound parseAdlibSound(LeStreamReader& reader)
 
 
 AudioPackage loadAdlibSoundData(
-  const ByteBuffer& audioDictData,
-  const ByteBuffer& bundledAudioData)
+  const ByteView audioDictData,
+  const ByteView bundledAudioData)
 {
   AudioPackage sounds;
 
@@ -38,8 +38,7 @@ struct AdlibSound
 
 using AudioPackage = std::vector<AdlibSound>;
 
-AudioPackage loadAdlibSoundData(
-  const ByteBuffer& audioDictData,
-  const ByteBuffer& bundledAudioData);
+AudioPackage
+  loadAdlibSoundData(ByteView audioDictData, ByteView bundledAudioData);
 
 } // namespace rigel::assets
@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
+
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 
@@ -24,8 +27,59 @@ namespace rigel::assets
 {
 
 using ByteBuffer = std::vector<std::uint8_t>;
-using ByteBuferIter = ByteBuffer::iterator;
-using ByteBufferCIter = ByteBuffer::const_iterator;
+
+/** Read-only view of binary data
+ *
+ * Can refer to a ByteBuffer, or to memory-mapped file contents (see
+ * MappedFile). Functions which only read binary data should take a view,
+ * which avoids copying data that is already in memory.
+ */
+using ByteView = base::ArrayView<std::uint8_t>;
+
+// Iterators are plain pointers, so that they work with ByteBuffers as well
+// as with ByteViews
+using ByteBufferCIter = const std::uint8_t*;
+
+
+/** Contents of a game data file, see ResourceLoader::file()
+ *
+ * Behaves like a ByteView, and converts to one implicitly. Data which is
+ * owned by the loader for its entire lifetime (like the memory-mapped CMP
+ * package) is only viewed. Data with a shorter lifetime is shared, so that
+ * it stays alive as long as any FileData refers to it.
+ */
+class FileData
+{
+public:
+  FileData() = default;
+
+  explicit FileData(ByteView data)
+    : mData(data)
+  {
+  }
+
+  explicit FileData(std::shared_ptr<const ByteBuffer> pBuffer)
+    : mpOwner(std::move(pBuffer))
+    , mData(*mpOwner)
+  {
+  }
+
+  const std::uint8_t* data() const { return mData.data(); }
+  ByteView::size_type size() const { return mData.size(); }
+  bool empty() const { return mData.empty(); }
+
+  ByteBufferCIter begin() const { return mData.data(); }
+  ByteBufferCIter end() const { return mData.data() + mData.size(); }
+
+  std::uint8_t operator[](const ByteView::size_type index) const
+  {
+    return mData[index];
+  }
+
+private:
+  std::shared_ptr<const ByteBuffer> mpOwner;
+  ByteView mData;
+};
 
 
 } // namespace rigel::assets
@@ -41,9 +41,10 @@ std::string normalizedFileName(std::string_view fileName)
 
 
 CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
-  : mFileData(loadFile(filePath))
+  : mFile(filePath)
 {
-  LeStreamReader dictReader(mFileData.begin(), mFileData.end());
+  const auto fileData = mFile.data();
+  LeStreamReader dictReader(fileData);
 
   while (dictReader.hasData())
   {
@@ -55,7 +56,7 @@ CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
     {
       break;
     }
-    if (fileOffset + fileSize > mFileData.size())
+    if (std::uint64_t{fileOffset} + fileSize > fileData.size())
     {
       throw invalid_argument("Malformed dictionary in CMP file");
     }
@@ -66,7 +67,7 @@ CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
 }
 
 
-ByteBuffer CMPFilePackage::file(std::string_view name) const
+ByteView CMPFilePackage::file(std::string_view name) const
 {
   const auto it = findFileEntry(name);
   if (it == mFileDict.end())
@@ -76,8 +77,8 @@ ByteBuffer CMPFilePackage::file(std::string_view name) const
   }
 
   const auto& fileHeader = it->second;
-  const auto fileStart = mFileData.begin() + fileHeader.fileOffset;
-  return ByteBuffer(fileStart, fileStart + fileHeader.fileSize);
+  return ByteView{
+    mFile.data().data() + fileHeader.fileOffset, fileHeader.fileSize};
 }
 
 
@@ -17,24 +17,30 @@
 #pragma once
 
 #include "assets/byte_buffer.hpp"
+#include "assets/mapped_file.hpp"
 
 #include <cstddef>
 #include <filesystem>
 #include <string>
 #include <unordered_map>
-#include <vector>
 
 
 namespace rigel::assets
 {
 
 
+/** Provides access to the files contained in a CMP archive
+ *
+ * The archive is memory-mapped, and file() returns views into the mapping
+ * without copying any data. These views remain valid for the lifetime of
+ * the package.
+ */
 class CMPFilePackage
 {
 public:
   explicit CMPFilePackage(const std::filesystem::path& filePath);
 
-  ByteBuffer file(std::string_view name) const;
+  ByteView file(std::string_view name) const;
 
   bool hasFile(std::string_view name) const;
 
@@ -54,7 +60,7 @@ private:
   FileDict::const_iterator findFileEntry(std::string_view name) const;
 
 private:
-  std::vector<std::uint8_t> mFileData;
+  MappedFile mFile;
   FileDict mFileDict;
 };
 
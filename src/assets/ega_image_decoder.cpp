@@ -16,9 +16,7 @@
 
 #include "ega_image_decoder.hpp"
 
-#include "assets/bitwise_iter.hpp"
 #include "assets/file_utils.hpp"
-#include "base/container_utils.hpp"
 #include "base/math_utils.hpp"
 #include "data/unit_conversions.hpp"
 
@@ -38,9 +36,6 @@ using data::tilesToPixels;
 namespace
 {
 
-using PalettizedPixelBuffer = std::vector<std::uint8_t>;
-
-
 size_t inferHeight(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
@@ -53,102 +48,93 @@ size_t inferHeight(
 }
 
 
-/** Decode EGA mask plane
+/** Create lookup table for decoding EGA plane bytes
  *
- * Pre-conditions:
- *   source and target can be advanced pixelCount times.
+ * Entry n spreads the 8 bits of byte n out into the 8 bytes of a 64-bit
+ * value, with the most significant bit (i.e. the leftmost pixel) ending up
+ * in the lowest byte. Combining the entries for the 4 plane bytes of a group
+ * of pixels, each shifted by its plane number, then yields the color indices
+ * of all 8 pixels at once.
  */
-template <typename SourceIter, typename TargetIter>
-SourceIter readEgaMaskPlane(
-  SourceIter source,
-  TargetIter target,
-  const size_t pixelCount)
+constexpr array<uint64_t, 256> makePlaneByteTable()
 {
-  for (size_t i = 0; i < pixelCount; ++i)
+  array<uint64_t, 256> table{};
+
+  for (auto value = 0u; value < 256u; ++value)
   {
-    *target++ = *source++;
+    for (auto pixel = 0u; pixel < GameTraits::pixelsPerEgaByte; ++pixel)
+    {
+      if (value & (0x80u >> pixel))
+      {
+        table[value] |= uint64_t{1} << (pixel * 8u);
+      }
+    }
   }
 
-  return source;
+  return table;
 }
 
-/** Decode EGA color data (4 planes)
+
+constexpr auto PLANE_BYTE_TABLE = makePlaneByteTable();
+
+
+/** Decode color indices for a group of 8 pixels (4 planes)
  *
- * Pre-conditions:
- *   target points to zero-initialized buffer of bytes.
- *   target can be advanced pixelCount times.
- *   source can be advanced pixelCount*4 times.
+ * The plane bytes are planeStride bytes apart. The result holds one color
+ * index per byte, the leftmost pixel in the lowest byte.
  */
-template <typename SourceIter, typename TargetIter>
-SourceIter readEgaColorData(
-  SourceIter source,
-  TargetIter target,
-  const size_t pixelCount)
+uint64_t decodeEgaColorIndices(
+  const uint8_t* pPlaneBytes,
+  const size_t planeStride)
 {
-  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
-  {
-    auto targetIterForPlane = target;
+  return PLANE_BYTE_TABLE[pPlaneBytes[0]] |
+    (PLANE_BYTE_TABLE[pPlaneBytes[planeStride]] << 1) |
+    (PLANE_BYTE_TABLE[pPlaneBytes[planeStride * 2]] << 2) |
+    (PLANE_BYTE_TABLE[pPlaneBytes[planeStride * 3]] << 3);
+}
 
-    for (auto pixel = 0u; pixel < pixelCount; ++pixel)
-    {
-      const auto planeBit = *source++;
-      *targetIterForPlane++ |= planeBit << plane;
-    }
-  }
 
-  return source;
+void writeEgaPixels(
+  const uint64_t colorIndices,
+  const data::Palette16& palette,
+  data::Pixel* pTarget)
+{
+  for (auto i = 0u; i < GameTraits::pixelsPerEgaByte; ++i)
+  {
+    pTarget[i] = palette[(colorIndices >> (i * 8u)) & 0xF];
+  }
 }
 
 
-/** Decode EGA monochromatic data (1 plane)
- *
- * Pre-conditions:
- *   target points to buffer of Pixels.
- *   target can be advanced pixelCount times.
- *   source can be advanced pixelCount times.
- */
-template <typename SourceIter, typename TargetIter>
-SourceIter readEgaMonochromeData(
-  SourceIter source,
-  TargetIter target,
-  const size_t pixelCount)
+void writeEgaMonochromePixels(const uint8_t plane, data::Pixel* pTarget)
 {
-  for (size_t i = 0; i < pixelCount; ++i)
+  for (auto i = 0u; i < GameTraits::pixelsPerEgaByte; ++i)
   {
-    const auto pixelPresent = *source++ != 0;
-    *target++ = pixelPresent ? data::Pixel{255, 255, 255, 255}
-                             : data::Pixel{0, 0, 0, 255};
+    const auto pixelPresent = (plane & (0x80u >> i)) != 0;
+    pTarget[i] = pixelPresent ? data::Pixel{255, 255, 255, 255}
+                              : data::Pixel{0, 0, 0, 255};
   }
-
-  return source;
 }
 
 
-/** Apply mask to decoded pixels
- *
- * Pre-conditions:
- *   pixels points to buffer of Pixels.
- *   maskValues points to buffer of bools.
- *   pixels can be advanced pixelCount times.
- *   maskValues can be advanced pixelCount times.
- */
-template <typename MaskIter, typename PixelBufferIter>
-void applyEgaMask(
-  MaskIter maskValues,
-  PixelBufferIter pixels,
-  const size_t pixelCount)
+void applyEgaMask(const uint8_t mask, data::Pixel* pTarget)
 {
-  for (size_t i = 0; i < pixelCount; ++i, ++pixels)
+  for (auto i = 0u; i < GameTraits::pixelsPerEgaByte; ++i)
   {
-    const auto maskActive = *maskValues++;
-    if (maskActive)
+    if (mask & (0x80u >> i))
     {
-      pixels->a = 0;
+      pTarget[i].a = 0;
     }
   }
 }
 
 
+/** Decode tile-based EGA data
+ *
+ * decodeRow is invoked for each row of 8 pixels in each tile, in the order
+ * they appear in the source data. It receives a pointer to the row's source
+ * bytes and the target pixels, and returns a pointer to the next row's data.
+ */
 template <typename Callable>
 data::PixelBuffer decodeTiledEgaData(
   const ByteBufferCIter dataIter,
@@ -160,7 +146,7 @@ data::PixelBuffer decodeTiledEgaData(
   PixelBuffer pixels(
     widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
 
-  BitWiseIterator<ByteBufferCIter> bitsIter(dataIter);
+  auto pSource = dataIter;
   for (auto row = 0u; row < heightInTiles; ++row)
   {
     for (auto col = 0u; col < widthInTiles; ++col)
@@ -169,9 +155,8 @@ data::PixelBuffer decodeTiledEgaData(
       {
         const auto insertStart = tilesToPixels(col) +
           (tilesToPixels(row) + rowInTile) * targetBufferStride;
-        const auto targetPixelIter = pixels.begin() + insertStart;
 
-        bitsIter = decodeRow(bitsIter, targetPixelIter);
+        pSource = decodeRow(pSource, pixels.data() + insertStart);
       }
     }
   }
@@ -189,16 +174,18 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
 {
   const auto numBytes = distance(begin, end);
   assert(numBytes > 0);
-  const auto numPixels = static_cast<size_t>(numBytes / GameTraits::egaPlanes) *
-    GameTraits::pixelsPerEgaByte;
+  const auto planeSize = static_cast<size_t>(numBytes) / GameTraits::egaPlanes;
 
-  BitWiseIterator<ByteBufferCIter> bitsIter(begin);
-  PalettizedPixelBuffer indexedPixels(numPixels, 0);
-  readEgaColorData(bitsIter, indexedPixels.begin(), numPixels);
+  PixelBuffer pixels(planeSize * GameTraits::pixelsPerEgaByte);
+  for (size_t i = 0; i < planeSize; ++i)
+  {
+    writeEgaPixels(
+      decodeEgaColorIndices(begin + i, planeSize),
+      palette,
+      pixels.data() + i * GameTraits::pixelsPerEgaByte);
+  }
 
-  return utils::transformed(indexedPixels, [&palette](const auto colorIndex) {
-    return palette[colorIndex];
-  });
+  return pixels;
 }
 
 
@@ -216,31 +203,14 @@ data::Image loadTiledImage(
     begin,
     widthInTiles,
     heightInTiles,
-    [&palette, type](auto sourceBitsIter, const auto targetPixelIter) {
+    [&palette, type](auto pSource, data::Pixel* pTarget) {
       const auto isMasked = type == data::TileImageType::Masked;
-      array<bool, GameTraits::tileSize> pixelMask;
-      if (isMasked)
-      {
-        sourceBitsIter = readEgaMaskPlane(
-          sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
-      }
-
-      array<uint8_t, GameTraits::tileSize> indexedPixels;
-      indexedPixels.fill(0);
-      sourceBitsIter = readEgaColorData(
-        sourceBitsIter, indexedPixels.begin(), GameTraits::tileSize);
+      const auto mask = isMasked ? *pSource++ : uint8_t{0};
 
-      for (auto i = 0; i < GameTraits::tileSize; ++i)
-      {
-        *(targetPixelIter + i) = palette[indexedPixels[i]];
-      }
+      writeEgaPixels(decodeEgaColorIndices(pSource, 1), palette, pTarget);
+      applyEgaMask(mask, pTarget);
 
-      if (isMasked)
-      {
-        applyEgaMask(pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
-      }
-
-      return sourceBitsIter;
+      return pSource + GameTraits::egaPlanes;
     });
 
   return data::Image(
@@ -262,15 +232,12 @@ data::Image loadTiledFontBitmap(
     begin,
     widthInTiles,
     heightInTiles,
-    [](auto sourceBitsIter, const auto targetPixelIter) {
-      array<bool, GameTraits::tileSize> pixelMask;
-      sourceBitsIter = readEgaMaskPlane(
-        sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
-
-      sourceBitsIter = readEgaMonochromeData(
-        sourceBitsIter, targetPixelIter, GameTraits::tileSize);
-      applyEgaMask(pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
-      return sourceBitsIter;
+    [](auto pSource, data::Pixel* pTarget) {
+      const auto mask = pSource[0];
+      writeEgaMonochromePixels(pSource[1], pTarget);
+      applyEgaMask(mask, pTarget);
+
+      return pSource + GameTraits::fontEgaPlanes;
     });
 
   return data::Image(
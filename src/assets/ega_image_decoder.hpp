@@ -40,7 +40,7 @@ data::Image loadTiledImage(
 
 
 inline data::Image loadTiledImage(
-  const ByteBuffer& data,
+  const ByteView data,
   std::size_t widthInTiles,
   const data::Palette16& palette,
   const data::TileImageType type = data::TileImageType::Unmasked)
@@ -80,14 +80,14 @@ void saveToFile(
 }
 
 
-std::string asText(const ByteBuffer& buffer)
+std::string asText(const ByteView data)
 {
-  const auto pBytesAsChars = reinterpret_cast<const char*>(buffer.data());
-  return std::string(pBytesAsChars, pBytesAsChars + buffer.size());
+  const auto pBytesAsChars = reinterpret_cast<const char*>(data.data());
+  return std::string(pBytesAsChars, pBytesAsChars + data.size());
 }
 
 
-LeStreamReader::LeStreamReader(const ByteBuffer& data)
+LeStreamReader::LeStreamReader(const ByteView data)
   : LeStreamReader(data.begin(), data.end())
 {
 }
@@ -44,7 +44,7 @@ void saveToFile(
   const assets::ByteBuffer& buffer,
   const std::filesystem::path& filePath);
 
-std::string asText(const ByteBuffer& buffer);
+std::string asText(ByteView data);
 
 
 /** Offers checked reading of little-endian data from a byte buffer
@@ -54,7 +54,7 @@ std::string asText(const ByteBuffer& buffer);
 class LeStreamReader
 {
 public:
-  explicit LeStreamReader(const ByteBuffer& data);
+  explicit LeStreamReader(ByteView data);
   LeStreamReader(ByteBufferCIter begin, ByteBufferCIter end);
 
   std::uint8_t readU8();
@@ -0,0 +1,177 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mapped_file.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+  #define NOMINMAX
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+
+namespace rigel::assets
+{
+
+using namespace std;
+
+
+namespace
+{
+
+[[noreturn]] void throwError(
+  const char* message,
+  const std::filesystem::path& path)
+{
+  throw runtime_error(string(message) + path.u8string());
+}
+
+
+void checkSize(const std::uint64_t size, const std::filesystem::path& path)
+{
+  if (size > numeric_limits<ByteView::size_type>::max())
+  {
+    throwError("File too large for mapping: ", path);
+  }
+}
+
+} // namespace
+
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  const auto fileHandle = CreateFileW(
+    path.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+  {
+    throwError("File can't be opened: ", path);
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(fileHandle, &fileSize))
+  {
+    CloseHandle(fileHandle);
+    throwError("File can't be opened: ", path);
+  }
+
+  checkSize(static_cast<std::uint64_t>(fileSize.QuadPart), path);
+  mSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+  // Mapping an empty file is not possible, but also not needed
+  if (mSize == 0)
+  {
+    CloseHandle(fileHandle);
+    return;
+  }
+
+  const auto mappingHandle =
+    CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(fileHandle);
+
+  if (!mappingHandle)
+  {
+    throwError("File can't be mapped: ", path);
+  }
+
+  // The view keeps the mapping alive, so the handle isn't needed anymore
+  mpData = static_cast<const std::uint8_t*>(
+    MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  CloseHandle(mappingHandle);
+
+  if (!mpData)
+  {
+    throwError("File can't be mapped: ", path);
+  }
+}
+
+
+MappedFile::~MappedFile()
+{
+  if (mpData)
+  {
+    UnmapViewOfFile(mpData);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  const auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    throwError("File can't be opened: ", path);
+  }
+
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) != 0)
+  {
+    close(fd);
+    throwError("File can't be opened: ", path);
+  }
+
+  checkSize(static_cast<std::uint64_t>(fileInfo.st_size), path);
+  mSize = static_cast<std::size_t>(fileInfo.st_size);
+
+  // Mapping an empty file is not possible, but also not needed
+  if (mSize == 0)
+  {
+    close(fd);
+    return;
+  }
+
+  // The mapping stays valid after closing the file descriptor
+  const auto pMapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    throwError("File can't be mapped: ", path);
+  }
+
+  mpData = static_cast<const std::uint8_t*>(pMapping);
+}
+
+
+MappedFile::~MappedFile()
+{
+  if (mpData)
+  {
+    munmap(const_cast<std::uint8_t*>(mpData), mSize);
+  }
+}
+
+#endif
+
+} // namespace rigel::assets
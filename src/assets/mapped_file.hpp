@@ -0,0 +1,57 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "assets/byte_buffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+
+namespace rigel::assets
+{
+
+/** Read-only memory mapping of a file's entire contents
+ *
+ * The file's data is only paged in by the OS when accessed, and doesn't
+ * count against the process' private memory. Views returned by data()
+ * remain valid for the lifetime of the MappedFile.
+ *
+ * Throws an exception if the file can't be opened or mapped.
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ByteView data() const
+  {
+    return ByteView{mpData, static_cast<ByteView::size_type>(mSize)};
+  }
+
+private:
+  const std::uint8_t* mpData = nullptr;
+  std::size_t mSize = 0;
+};
+
+} // namespace rigel::assets
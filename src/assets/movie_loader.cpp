@@ -219,7 +219,7 @@ vector<data::MovieFrame> readAnimationFrames(
 } // namespace
 
 
-data::Movie loadMovie(const ByteBuffer& file)
+data::Movie loadMovie(const ByteView file)
 {
   LeStreamReader reader(file);
 
@@ -23,7 +23,7 @@
 namespace rigel::assets
 {
 
-data::Movie loadMovie(const ByteBuffer& file);
+data::Movie loadMovie(ByteView file);
 
 
 }
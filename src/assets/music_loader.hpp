@@ -23,6 +23,6 @@
 namespace rigel::assets
 {
 
-data::Song loadSong(const ByteBuffer& imfData);
+data::Song loadSong(ByteView imfData);
 
 }
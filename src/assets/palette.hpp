@@ -27,15 +27,15 @@ data::Palette16 load6bitPalette16(ByteBufferCIter begin, ByteBufferCIter end);
 data::Palette256 load6bitPalette256(ByteBufferCIter begin, ByteBufferCIter end);
 
 
-inline data::Palette16 load6bitPalette16(const ByteBuffer& buffer)
+inline data::Palette16 load6bitPalette16(const ByteView data)
 {
-  return load6bitPalette16(buffer.begin(), buffer.end());
+  return load6bitPalette16(data.begin(), data.end());
 }
 
 
-inline data::Palette256 load6bitPalette256(const ByteBuffer& buffer)
+inline data::Palette256 load6bitPalette256(const ByteView data)
 {
-  return load6bitPalette256(buffer.begin(), buffer.end());
+  return load6bitPalette256(data.begin(), data.end());
 }
 
 } // namespace rigel::assets
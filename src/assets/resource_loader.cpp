@@ -18,6 +18,7 @@
 
 #include "assets/ega_image_decoder.hpp"
 #include "assets/file_utils.hpp"
+#include "assets/level_loader.hpp"
 #include "assets/movie_loader.hpp"
 #include "assets/music_loader.hpp"
 #include "assets/png_image.hpp"
@@ -26,6 +27,7 @@
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
@@ -45,6 +47,9 @@ namespace
 
 const auto ANTI_PIRACY_SCREEN_FILENAME = "LCR.MNI";
 
+// Enough to cover the levels used by the demo loop
+constexpr auto LEVEL_CACHE_SIZE = std::size_t{8};
+
 const auto FULL_SCREEN_IMAGE_DATA_SIZE =
   (GameTraits::viewportWidthPx * GameTraits::viewportHeightPx) /
   (GameTraits::pixelsPerEgaByte / GameTraits::egaPlanes);
@@ -412,6 +417,45 @@ TileSet ResourceLoader::loadCZone(std::string_view name) const
 }
 
 
+data::map::LevelData ResourceLoader::loadLevel(
+  std::string_view mapName,
+  const data::Difficulty difficulty) const
+{
+  std::lock_guard guard{mLevelCacheMutex};
+
+  // Level files, tile sets and backdrops can be overridden by loose files.
+  if (forgetModifiedLooseFiles())
+  {
+    mLevelCache.clear();
+  }
+
+  const auto iCachedLevel = std::find_if(
+    mLevelCache.begin(), mLevelCache.end(), [&](const CachedLevel& level) {
+      return level.mMapName == mapName && level.mDifficulty == difficulty;
+    });
+
+  if (iCachedLevel != mLevelCache.end())
+  {
+    // Move the entry to the end, to mark it as most recently used
+    std::rotate(iCachedLevel, std::next(iCachedLevel), mLevelCache.end());
+  }
+  else
+  {
+    if (mLevelCache.size() == LEVEL_CACHE_SIZE)
+    {
+      mLevelCache.erase(mLevelCache.begin());
+    }
+
+    mLevelCache.push_back(CachedLevel{
+      std::string{mapName},
+      difficulty,
+      assets::loadLevel(mapName, *this, difficulty)});
+  }
+
+  return mLevelCache.back().mLevelData;
+}
+
+
 data::Movie ResourceLoader::loadMovie(std::string_view name) const
 {
   // We don't use tryLoadReplacement here, because we don't look for movies
@@ -512,7 +556,7 @@ data::LevelHints ResourceLoader::loadHintMessages() const
 }
 
 
-ByteBuffer ResourceLoader::file(std::string_view name) const
+FileData ResourceLoader::file(std::string_view name) const
 {
   // TODO: Eliminate duplication with tryLoadReplacement?
   for (auto iPath = mModPaths.rbegin(); iPath != mModPaths.rend(); ++iPath)
@@ -520,7 +564,7 @@ ByteBuffer ResourceLoader::file(std::string_view name) const
     const auto unpackedFilePath = *iPath / fs::u8path(name);
     if (fs::exists(unpackedFilePath))
     {
-      return loadFile(unpackedFilePath);
+      return looseFile(unpackedFilePath);
     }
   }
 
@@ -529,11 +573,57 @@ ByteBuffer ResourceLoader::file(std::string_view name) const
     const auto unpackedFilePath = mGamePath / fs::u8path(name);
     if (fs::exists(unpackedFilePath))
     {
-      return loadFile(unpackedFilePath);
+      return looseFile(unpackedFilePath);
+    }
+  }
+
+  // The package is mapped for the loader's entire lifetime
+  return FileData{mFilePackage.file(name)};
+}
+
+
+FileData ResourceLoader::looseFile(const fs::path& path) const
+{
+  std::lock_guard guard{mLooseFilesMutex};
+
+  const auto lastWriteTime = fs::last_write_time(path);
+  auto& file = mLooseFiles[path.u8string()];
+
+  if (!file.mpData || file.mLastWriteTime != lastWriteTime)
+  {
+    file.mpData = std::make_shared<const ByteBuffer>(loadFile(path));
+    file.mLastWriteTime = lastWriteTime;
+  }
+
+  return FileData{file.mpData};
+}
+
+
+bool ResourceLoader::forgetModifiedLooseFiles() const
+{
+  std::lock_guard guard{mLooseFilesMutex};
+
+  // Forgotten files are read again on their next use. FileData instances
+  // referring to the previous contents keep them alive until then.
+  auto anyModified = false;
+  for (auto iFile = mLooseFiles.begin(); iFile != mLooseFiles.end();)
+  {
+    auto error = std::error_code{};
+    const auto lastWriteTime =
+      fs::last_write_time(fs::u8path(iFile->first), error);
+
+    if (error || lastWriteTime != iFile->second.mLastWriteTime)
+    {
+      iFile = mLooseFiles.erase(iFile);
+      anyModified = true;
+    }
+    else
+    {
+      ++iFile;
     }
   }
 
-  return mFilePackage.file(name);
+  return anyModified;
 }
 
 
@@ -23,13 +23,18 @@
 #include "base/array_view.hpp"
 #include "base/audio_buffer.hpp"
 #include "base/image.hpp"
+#include "data/game_session_data.hpp"
+#include "data/map.hpp"
 #include "data/movie.hpp"
 #include "data/song.hpp"
 #include "data/sound_ids.hpp"
 #include "data/tile_attributes.hpp"
 
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -103,6 +108,20 @@ public:
 
   data::Image loadBackdrop(std::string_view name) const;
   TileSet loadCZone(std::string_view name) const;
+
+  /** Load a level, see assets::loadLevel()
+   *
+   * The most recently loaded levels are kept in memory, so that loading one
+   * of them again (e.g. when restarting a level, or in the demo loop) doesn't
+   * need to parse the level file or decode any images. The returned copy
+   * shares its images with the cached one, see data::Image.
+   *
+   * If any loose file read so far (see file()) has been modified on disk
+   * since, the cache is cleared, as the cached levels might be based on the
+   * previous contents.
+   */
+  data::map::LevelData
+    loadLevel(std::string_view mapName, data::Difficulty difficulty) const;
   data::Movie loadMovie(std::string_view name) const;
 
   data::Song loadMusic(std::string_view name) const;
@@ -117,7 +136,16 @@ public:
 
   data::LevelHints loadHintMessages() const;
 
-  ByteBuffer file(std::string_view name) const;
+  /** Contents of the given game data file
+   *
+   * Files from the game's CMP package are returned directly from its memory
+   * mapping. Loose files which override them (see mod paths) are read into
+   * memory instead, and cached until they are modified on disk. That way,
+   * they can be edited or replaced while the game is running.
+   *
+   * The returned data stays valid even if the file is modified afterwards.
+   */
+  FileData file(std::string_view name) const;
   std::string fileAsText(std::string_view name) const;
   bool hasFile(std::string_view name) const;
 
@@ -132,6 +160,9 @@ private:
   std::optional<data::Image>
     tryLoadPngReplacement(std::string_view filename) const;
 
+  FileData looseFile(const std::filesystem::path& path) const;
+  bool forgetModifiedLooseFiles() const;
+
   data::Image loadEmbeddedImageAsset(
     const char* replacementName,
     base::ArrayView<std::uint8_t> data) const;
@@ -146,8 +177,33 @@ private:
   std::vector<std::filesystem::path> mModPaths;
   bool mEnableTopLevelMods;
 
+  struct CachedLevel
+  {
+    std::string mMapName;
+    data::Difficulty mDifficulty;
+    data::map::LevelData mLevelData;
+  };
+
+  struct LooseFile
+  {
+    std::filesystem::file_time_type mLastWriteTime;
+
+    // Shared with all FileData instances handed out for this version of the
+    // file. When the file is read again, the previous contents are freed
+    // once no FileData refers to them anymore.
+    std::shared_ptr<const ByteBuffer> mpData;
+  };
+
+  // Loose files overriding the ones in the CMP package, see file()
+  mutable std::unordered_map<std::string, LooseFile> mLooseFiles;
+  mutable std::mutex mLooseFilesMutex;
+
   assets::CMPFilePackage mFilePackage;
   assets::ActorImagePackage mActorImagePackage;
+
+  // Ordered from least to most recently used
+  mutable std::vector<CachedLevel> mLevelCache;
+  mutable std::mutex mLevelCacheMutex;
 };
 
 } // namespace rigel::assets
@@ -23,6 +23,6 @@
 namespace rigel::assets
 {
 
-base::AudioBuffer decodeVoc(const ByteBuffer& data);
+base::AudioBuffer decodeVoc(ByteView data);
 
 }
@@ -21,6 +21,7 @@
 #include "audio/adlib_emulator.hpp"
 #include "audio/software_imf_player.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "base/string_utils.hpp"
 #include "sdl_utils/error.hpp"
 
@@ -650,6 +651,8 @@ void SoundSystem::hookMusic() const
 {
   Mix_HookMusic(
     [](void* pUserData, Uint8* pOutBuffer, int bytesRequired) {
+      RIGEL_PROFILE_SCOPE("SoundSystem (music rendering)");
+
       auto pWrapper = static_cast<ImfPlayerWrapper*>(pUserData);
       pWrapper->render(pOutBuffer, bytesRequired);
     },
@@ -0,0 +1,69 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bit_scan.hpp"
+
+#include <cassert>
+
+
+namespace rigel::base
+{
+
+namespace
+{
+
+constexpr auto BITS_PER_WORD = std::size_t{64};
+
+} // namespace
+
+
+bool anyBitSet(
+  const std::uint64_t* pWords,
+  const std::size_t first,
+  const std::size_t last)
+{
+  assert(first <= last);
+
+  const auto firstWord = first / BITS_PER_WORD;
+  const auto lastWord = last / BITS_PER_WORD;
+  const auto firstMask = ~std::uint64_t{0} << (first % BITS_PER_WORD);
+  const auto lastMask =
+    ~std::uint64_t{0} >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD);
+
+  if (firstWord == lastWord)
+  {
+    return (pWords[firstWord] & firstMask & lastMask) != 0;
+  }
+
+  if (
+    (pWords[firstWord] & firstMask) != 0 ||
+    (pWords[lastWord] & lastMask) != 0)
+  {
+    return true;
+  }
+
+  for (auto word = firstWord + 1; word < lastWord; ++word)
+  {
+    if (pWords[word] != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace rigel::base
@@ -0,0 +1,37 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rigel::base
+{
+
+/** Test if any bit in the inclusive range [first, last] is set
+ *
+ * Bits are numbered starting at the least significant bit of the first
+ * word. Words which are completely covered by the range are tested as a
+ * whole, instead of bit by bit.
+ */
+bool anyBitSet(
+  const std::uint64_t* pWords,
+  std::size_t first,
+  std::size_t last);
+
+} // namespace rigel::base
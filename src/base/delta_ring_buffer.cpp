@@ -0,0 +1,255 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "delta_ring_buffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+namespace rigel::base
+{
+
+namespace
+{
+
+// Shorter stretches of zero bytes are stored as part of a literal run,
+// since starting a new run costs at least two bytes.
+constexpr auto MIN_ZERO_RUN_LENGTH = std::size_t{4};
+
+
+void appendVarInt(std::vector<std::uint8_t>& output, std::size_t value)
+{
+  while (value >= 0x80)
+  {
+    output.push_back(static_cast<std::uint8_t>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+
+  output.push_back(static_cast<std::uint8_t>(value));
+}
+
+
+std::size_t readVarInt(const std::uint8_t*& pData)
+{
+  auto value = std::size_t{0};
+  auto shift = 0;
+
+  for (;;)
+  {
+    const auto byte = *pData++;
+    value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+
+    if ((byte & 0x80) == 0)
+    {
+      return value;
+    }
+
+    shift += 7;
+  }
+}
+
+
+/** Run-length encode the XOR of two states
+ *
+ * The shorter of the two is treated as if it was padded with zeroes. The
+ * result is a sequence of runs, each consisting of the number of zero bytes,
+ * the number of literal bytes, and the literal bytes themselves. Zeroes at
+ * the end are omitted.
+ */
+std::vector<std::uint8_t>
+  encodeDelta(ArrayView<std::uint8_t> a, ArrayView<std::uint8_t> b)
+{
+  const auto size = std::size_t{std::max(a.size(), b.size())};
+
+  auto diffAt = [&](const std::size_t i) -> std::uint8_t {
+    const auto valueA = i < a.size() ? a[i] : 0;
+    const auto valueB = i < b.size() ? b[i] : 0;
+    return static_cast<std::uint8_t>(valueA ^ valueB);
+  };
+
+  auto startsZeroRun = [&](const std::size_t i) {
+    const auto end = std::min(i + MIN_ZERO_RUN_LENGTH, size);
+
+    for (auto j = i; j < end; ++j)
+    {
+      if (diffAt(j) != 0)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  // Where both states overlap, zero runs are just stretches of identical
+  // bytes. These can be skipped over a word at a time, which is much faster
+  // than checking each byte's XOR individually.
+  auto skipIdenticalBytes = [&](std::size_t i) {
+    const auto commonSize = std::min(a.size(), b.size());
+
+    while (i + sizeof(std::uint64_t) <= commonSize)
+    {
+      std::uint64_t wordA;
+      std::uint64_t wordB;
+      std::memcpy(&wordA, a.data() + i, sizeof(wordA));
+      std::memcpy(&wordB, b.data() + i, sizeof(wordB));
+
+      if (wordA != wordB)
+      {
+        break;
+      }
+
+      i += sizeof(std::uint64_t);
+    }
+
+    return i;
+  };
+
+  std::vector<std::uint8_t> result;
+  auto pos = std::size_t{0};
+
+  while (pos < size)
+  {
+    const auto zeroRunStart = pos;
+    pos = skipIdenticalBytes(pos);
+    while (pos < size && diffAt(pos) == 0)
+    {
+      ++pos;
+    }
+
+    if (pos == size)
+    {
+      break;
+    }
+
+    const auto literalStart = pos;
+    while (pos < size && !startsZeroRun(pos))
+    {
+      ++pos;
+    }
+
+    appendVarInt(result, literalStart - zeroRunStart);
+    appendVarInt(result, pos - literalStart);
+
+    for (auto i = literalStart; i < pos; ++i)
+    {
+      result.push_back(diffAt(i));
+    }
+  }
+
+  result.shrink_to_fit();
+  return result;
+}
+
+
+void applyDelta(
+  std::vector<std::uint8_t>& state,
+  const std::vector<std::uint8_t>& encodedDelta)
+{
+  auto pData = encodedDelta.data();
+  const auto pEnd = pData + encodedDelta.size();
+  auto pos = std::size_t{0};
+
+  while (pData != pEnd)
+  {
+    pos += readVarInt(pData);
+    const auto literalLength = readVarInt(pData);
+
+    for (auto i = std::size_t{0}; i < literalLength; ++i)
+    {
+      state[pos++] ^= *pData++;
+    }
+  }
+}
+
+} // namespace
+
+
+DeltaRingBuffer::DeltaRingBuffer(const std::size_t capacity)
+  : mCapacity(capacity)
+{
+  assert(capacity > 0);
+}
+
+
+void DeltaRingBuffer::push(ArrayView<std::uint8_t> state)
+{
+  if (mHasNewestState)
+  {
+    mDeltas.push_back(
+      Delta{encodeDelta(mNewestState, state), mNewestState.size()});
+
+    if (size() > mCapacity)
+    {
+      mDeltas.pop_front();
+    }
+  }
+
+  mNewestState.assign(state.begin(), state.end());
+  mHasNewestState = true;
+}
+
+
+void DeltaRingBuffer::dropNewest()
+{
+  assert(!empty());
+
+  if (mDeltas.empty())
+  {
+    clear();
+    return;
+  }
+
+  const auto& delta = mDeltas.back();
+  mNewestState.resize(
+    std::max(mNewestState.size(), delta.mPreviousStateSize));
+  applyDelta(mNewestState, delta.mEncodedBytes);
+  mNewestState.resize(delta.mPreviousStateSize);
+
+  mDeltas.pop_back();
+}
+
+
+void DeltaRingBuffer::clear()
+{
+  mDeltas.clear();
+  mNewestState.clear();
+  mHasNewestState = false;
+}
+
+
+std::size_t DeltaRingBuffer::size() const
+{
+  return mHasNewestState ? mDeltas.size() + 1 : 0;
+}
+
+
+std::size_t DeltaRingBuffer::storageSize() const
+{
+  auto result = mNewestState.size();
+
+  for (const auto& delta : mDeltas)
+  {
+    result += delta.mEncodedBytes.size();
+  }
+
+  return result;
+}
+
+} // namespace rigel::base
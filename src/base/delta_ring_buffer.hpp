@@ -0,0 +1,80 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/array_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** History of binary state blobs, stored as deltas between consecutive ones
+ *
+ * Only the most recently pushed state is kept in full. For each older state,
+ * the buffer stores the XOR of that state and its successor, run-length
+ * encoded. Since consecutive game states usually differ in a small fraction
+ * of their bytes, these deltas consist mostly of zeroes and compress very
+ * well.
+ *
+ * States can only be taken out again in reverse order, via dropNewest().
+ * Once the capacity is exceeded, the oldest state is discarded.
+ */
+class DeltaRingBuffer
+{
+public:
+  explicit DeltaRingBuffer(std::size_t capacity);
+
+  void push(ArrayView<std::uint8_t> state);
+
+  /** Discard the newest state, making the one before it the newest
+   *
+   * Must not be called on an empty buffer.
+   */
+  void dropNewest();
+
+  void clear();
+
+  /** Must not be called on an empty buffer */
+  const std::vector<std::uint8_t>& newest() const { return mNewestState; }
+
+  std::size_t size() const;
+  std::size_t capacity() const { return mCapacity; }
+  bool empty() const { return size() == 0; }
+
+  /** Total size in bytes of the stored states, including the deltas */
+  std::size_t storageSize() const;
+
+private:
+  struct Delta
+  {
+    std::vector<std::uint8_t> mEncodedBytes;
+    std::size_t mPreviousStateSize;
+  };
+
+  std::deque<Delta> mDeltas;
+  std::vector<std::uint8_t> mNewestState;
+  std::size_t mCapacity;
+  bool mHasNewestState = false;
+};
+
+} // namespace rigel::base
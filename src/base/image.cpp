@@ -29,7 +29,7 @@ Image::Image(
   const PixelBuffer& pixels,
   const std::size_t width,
   const std::size_t height)
-  : mPixels(pixels)
+  : mpPixels(std::make_shared<PixelBuffer>(pixels))
   , mWidth(width)
   , mHeight(height)
 {
@@ -40,7 +40,7 @@ Image::Image(
   PixelBuffer&& pixels,
   const std::size_t width,
   const std::size_t height)
-  : mPixels(std::move(pixels))
+  : mpPixels(std::make_shared<PixelBuffer>(std::move(pixels)))
   , mWidth(width)
   , mHeight(height)
 {
@@ -91,16 +91,28 @@ void Image::insertImage(
     throw invalid_argument("Source image doesn't fit");
   }
 
+  auto& targetPixels = mutablePixelData();
   auto sourceIter = pixels.begin();
   for (size_t row = 0; row < inferredHeight; ++row)
   {
     for (size_t col = 0; col < sourceWidth; ++col)
     {
       const auto targetOffset = (x + col) + (y + row) * mWidth;
-      mPixels[targetOffset] = *sourceIter++;
+      targetPixels[targetOffset] = *sourceIter++;
     }
   }
 }
 
 
+PixelBuffer& Image::mutablePixelData()
+{
+  if (mpPixels.use_count() > 1)
+  {
+    mpPixels = std::make_shared<PixelBuffer>(*mpPixels);
+  }
+
+  return *mpPixels;
+}
+
+
 } // namespace rigel::data
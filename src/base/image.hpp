@@ -19,6 +19,7 @@
 #include "base/color.hpp"
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 
@@ -32,6 +33,10 @@ using PixelBuffer = std::vector<Pixel>;
 /** Simple technology-agnostic image data holder.
  *
  * Always RGBA, 8-bit to keep things simple.
+ *
+ * Copies of an image share the same pixel data, which is only duplicated
+ * when one of them is modified (copy-on-write). This makes it cheap to hand
+ * out copies of images which are kept in a cache.
  */
 class Image
 {
@@ -40,7 +45,7 @@ public:
   Image(const PixelBuffer& pixels, std::size_t width, std::size_t height);
   Image(std::size_t width, std::size_t height);
 
-  const PixelBuffer& pixelData() const { return mPixels; }
+  const PixelBuffer& pixelData() const { return *mpPixels; }
 
   std::size_t width() const { return mWidth; }
 
@@ -56,7 +61,9 @@ public:
     std::size_t sourceWidth);
 
 private:
-  PixelBuffer mPixels;
+  PixelBuffer& mutablePixelData();
+
+  std::shared_ptr<PixelBuffer> mpPixels;
   std::size_t mWidth;
   std::size_t mHeight;
 };
@@ -0,0 +1,79 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Invoke func(i) for each i in [0, count), spread out over worker threads
+ *
+ * Blocks until all invocations have finished. The calling thread takes part
+ * in the work. func must be safe to call concurrently for different indices,
+ * and the order of invocations is unspecified. If any invocation throws, the
+ * exception is propagated to the caller once all workers are done.
+ *
+ * On platforms without thread support (WebAssembly), everything runs on the
+ * calling thread.
+ */
+template <typename Func>
+void parallelFor(const std::size_t count, Func&& func)
+{
+#if defined(__EMSCRIPTEN__)
+  for (auto i = std::size_t{0}; i < count; ++i)
+  {
+    func(i);
+  }
+#else
+  const auto numThreads =
+    std::max(std::size_t{std::thread::hardware_concurrency()}, std::size_t{1});
+  const auto numChunks = std::min(numThreads, count);
+
+  // Indices are interleaved between chunks, so that the work is distributed
+  // evenly even if some areas of the input are more expensive than others.
+  auto runChunk = [&](const std::size_t chunk) {
+    for (auto i = chunk; i < count; i += numChunks)
+    {
+      func(i);
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+  for (auto chunk = std::size_t{1}; chunk < numChunks; ++chunk)
+  {
+    workers.push_back(std::async(std::launch::async, runChunk, chunk));
+  }
+
+  if (numChunks > 0)
+  {
+    runChunk(0);
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.get();
+  }
+#endif
+}
+
+} // namespace rigel::base
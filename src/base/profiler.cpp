@@ -0,0 +1,294 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+
+namespace rigel::base::profiler
+{
+
+namespace
+{
+
+struct ProfilerState
+{
+  std::mutex mMutex;
+  // One extra slot for the frame that's currently being recorded
+  std::vector<Frame> mFrames = std::vector<Frame>(NUM_RECORDED_FRAMES + 1);
+  std::size_t mCurrentFrame = 0;
+  std::size_t mNumFinishedFrames = 0;
+  const Clock::time_point mEpoch = Clock::now();
+};
+
+
+ProfilerState& profilerState()
+{
+  static ProfilerState instance;
+  return instance;
+}
+
+
+std::atomic<int> gNextThreadIndex{0};
+thread_local int tThreadIndex = -1;
+thread_local std::vector<const char*> tScopeStack;
+
+
+int currentThreadIndex()
+{
+  if (tThreadIndex < 0)
+  {
+    tThreadIndex = gNextThreadIndex++;
+  }
+
+  return tThreadIndex;
+}
+
+
+std::int64_t nanosecondsSinceEpoch(
+  const ProfilerState& state,
+  const Clock::time_point time)
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(time - state.mEpoch).count();
+}
+
+
+void writeJsonString(std::ostream& stream, const char* pString)
+{
+  stream << '"';
+
+  for (auto pChar = pString; *pChar; ++pChar)
+  {
+    if (*pChar == '"' || *pChar == '\\')
+    {
+      stream << '\\';
+    }
+
+    stream << *pChar;
+  }
+
+  stream << '"';
+}
+
+
+void writeCompleteEvent(
+  std::ostream& stream,
+  const char* pName,
+  const std::int64_t startNs,
+  const std::int64_t durationNs,
+  const int threadIndex)
+{
+  // Trace event timestamps are in microseconds
+  stream << "{\"name\":";
+  writeJsonString(stream, pName);
+  stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIndex
+         << ",\"ts\":" << startNs / 1000.0 << ",\"dur\":" << durationNs / 1000.0
+         << '}';
+}
+
+
+void writeCounterEvent(
+  std::ostream& stream,
+  const char* pName,
+  const std::int64_t timeNs,
+  const std::int64_t value)
+{
+  stream << "{\"name\":";
+  writeJsonString(stream, pName);
+  stream << ",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":" << timeNs / 1000.0
+         << ",\"args\":{\"value\":" << value << "}}";
+}
+
+} // namespace
+
+
+std::atomic<bool> detail::gIsEnabled{false};
+
+
+void setEnabled(const bool enabled)
+{
+  auto& state = profilerState();
+  std::lock_guard lock{state.mMutex};
+
+  if (enabled && !isEnabled())
+  {
+    // Start a fresh recording
+    for (auto& frame : state.mFrames)
+    {
+      frame.mSamples.clear();
+      frame.mCounters.clear();
+    }
+
+    state.mCurrentFrame = 0;
+    state.mNumFinishedFrames = 0;
+    state.mFrames[0].mStartNs = nanosecondsSinceEpoch(state, Clock::now());
+  }
+
+  detail::gIsEnabled = enabled;
+}
+
+
+void beginFrame()
+{
+  // Make sure the main thread is always thread 0
+  currentThreadIndex();
+
+  if (!isEnabled())
+  {
+    return;
+  }
+
+  auto& state = profilerState();
+  const auto now = nanosecondsSinceEpoch(state, Clock::now());
+
+  std::lock_guard lock{state.mMutex};
+
+  auto& finishedFrame = state.mFrames[state.mCurrentFrame];
+  finishedFrame.mDurationNs = now - finishedFrame.mStartNs;
+
+  state.mCurrentFrame = (state.mCurrentFrame + 1) % state.mFrames.size();
+  state.mNumFinishedFrames =
+    std::min(state.mNumFinishedFrames + 1, state.mFrames.size() - 1);
+
+  auto& newFrame = state.mFrames[state.mCurrentFrame];
+  newFrame.mStartNs = now;
+  newFrame.mDurationNs = 0;
+  newFrame.mSamples.clear();
+  newFrame.mCounters.clear();
+}
+
+
+void recordCounter(const char* pName, const std::int64_t value)
+{
+  if (!isEnabled())
+  {
+    return;
+  }
+
+  auto& state = profilerState();
+  std::lock_guard lock{state.mMutex};
+  state.mFrames[state.mCurrentFrame].mCounters.push_back(
+    Counter{pName, value});
+}
+
+
+std::vector<Frame> recordedFrames()
+{
+  auto& state = profilerState();
+  std::lock_guard lock{state.mMutex};
+
+  const auto numFrames = state.mFrames.size();
+  const auto firstIndex =
+    state.mCurrentFrame + numFrames - state.mNumFinishedFrames;
+
+  std::vector<Frame> result;
+  result.reserve(state.mNumFinishedFrames);
+
+  for (auto i = std::size_t{0}; i < state.mNumFinishedFrames; ++i)
+  {
+    result.push_back(state.mFrames[(firstIndex + i) % numFrames]);
+  }
+
+  return result;
+}
+
+
+void writeChromeTrace(const std::filesystem::path& path)
+{
+  const auto frames = recordedFrames();
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    throw std::runtime_error("Cannot open file for writing");
+  }
+
+  file << std::fixed << std::setprecision(3);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+          "\"args\":{\"name\":\"Main thread\"}}";
+
+  for (const auto& frame : frames)
+  {
+    file << ",\n";
+    writeCompleteEvent(file, "Frame", frame.mStartNs, frame.mDurationNs, 0);
+
+    for (const auto& sample : frame.mSamples)
+    {
+      file << ",\n";
+      writeCompleteEvent(
+        file,
+        sample.mpName,
+        sample.mStartNs,
+        sample.mDurationNs,
+        sample.mThreadIndex);
+    }
+
+    for (const auto& counter : frame.mCounters)
+    {
+      file << ",\n";
+      writeCounterEvent(file, counter.mpName, frame.mStartNs, counter.mValue);
+    }
+  }
+
+  file << "\n]}\n";
+
+  if (!file.good())
+  {
+    throw std::runtime_error("Failed to write trace file");
+  }
+}
+
+
+const char* currentScope()
+{
+  return tScopeStack.empty() ? nullptr : tScopeStack.back();
+}
+
+
+int detail::enterScope(const char* pName)
+{
+  tScopeStack.push_back(pName);
+  return int(tScopeStack.size()) - 1;
+}
+
+
+void detail::leaveScope(
+  const char* pName,
+  const Clock::time_point startTime,
+  const Clock::time_point endTime,
+  const int depth)
+{
+  tScopeStack.pop_back();
+
+  auto& state = profilerState();
+  const auto threadIndex = currentThreadIndex();
+  const auto startNs = nanosecondsSinceEpoch(state, startTime);
+  const auto durationNs = nanosecondsSinceEpoch(state, endTime) - startNs;
+
+  std::lock_guard lock{state.mMutex};
+  state.mFrames[state.mCurrentFrame].mSamples.push_back(
+    Sample{pName, startNs, durationNs, depth, threadIndex});
+}
+
+} // namespace rigel::base::profiler
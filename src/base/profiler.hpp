@@ -0,0 +1,177 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+/** Lightweight instrumentation for finding out where time is spent
+ *
+ * Code sections are instrumented by placing RIGEL_PROFILE_SCOPE("Name") at
+ * the beginning of a block. While profiling is enabled, each scope records
+ * its start time and duration into the current frame. The most recent
+ * frames are kept in a ring buffer, which can be viewed in the debug UI
+ * (see ui/profiler_display.hpp) or exported in Chrome's trace event format,
+ * for viewing in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Scopes can be used from any thread, e.g. the audio callback. Samples are
+ * assigned to the frame that's current at the time the scope ends.
+ *
+ * When profiling is disabled (the default), a scope costs a single check of
+ * an atomic flag.
+ */
+namespace rigel::base::profiler
+{
+
+constexpr auto NUM_RECORDED_FRAMES = 256;
+
+
+struct Sample
+{
+  /** Must be a string literal, or otherwise outlive the profiler */
+  const char* mpName;
+
+  /** Start time in nanoseconds, relative to the start of profiling */
+  std::int64_t mStartNs;
+  std::int64_t mDurationNs;
+
+  /** Nesting level of the scope on its thread, 0 being the outermost */
+  int mDepth;
+
+  /** Threads are numbered in order of their first recorded sample */
+  int mThreadIndex;
+};
+
+
+struct Counter
+{
+  /** Must be a string literal, or otherwise outlive the profiler */
+  const char* mpName;
+  std::int64_t mValue;
+};
+
+
+struct Frame
+{
+  std::int64_t mStartNs = 0;
+  std::int64_t mDurationNs = 0;
+  std::vector<Sample> mSamples;
+  std::vector<Counter> mCounters;
+};
+
+
+void setEnabled(bool enabled);
+
+/** Mark the start of a new frame
+ *
+ * Should be called once per frame by the main loop. Finishes the current
+ * frame and makes it available via recordedFrames().
+ */
+void beginFrame();
+
+/** Record a value for the current frame
+ *
+ * Meant for things that are better expressed as a number than a duration,
+ * like the amount of data uploaded to the GPU. Does nothing when profiling
+ * is disabled.
+ */
+void recordCounter(const char* pName, std::int64_t value);
+
+/** Returns all finished frames in the ring buffer, oldest first */
+std::vector<Frame> recordedFrames();
+
+/** Write all recorded frames to a file, in Chrome's trace event format
+ *
+ * Throws an exception if the file can't be written.
+ */
+void writeChromeTrace(const std::filesystem::path& path);
+
+/** Name of the innermost scope currently active on the calling thread
+ *
+ * Returns nullptr if there is none. Scopes are only tracked while profiling
+ * is enabled.
+ */
+const char* currentScope();
+
+
+namespace detail
+{
+
+extern std::atomic<bool> gIsEnabled;
+
+int enterScope(const char* pName);
+void leaveScope(
+  const char* pName,
+  Clock::time_point startTime,
+  Clock::time_point endTime,
+  int depth);
+
+} // namespace detail
+
+
+inline bool isEnabled()
+{
+  return detail::gIsEnabled.load(std::memory_order_relaxed);
+}
+
+
+/** Records a sample covering its own lifetime, see RIGEL_PROFILE_SCOPE */
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(const char* pName)
+  {
+    if (isEnabled())
+    {
+      mpName = pName;
+      mDepth = detail::enterScope(pName);
+      mStartTime = Clock::now();
+    }
+  }
+
+  ~ScopedTimer()
+  {
+    if (mpName)
+    {
+      detail::leaveScope(mpName, mStartTime, Clock::now(), mDepth);
+    }
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  const char* mpName = nullptr;
+  Clock::time_point mStartTime;
+  int mDepth = 0;
+};
+
+} // namespace rigel::base::profiler
+
+
+#define RIGEL_PROFILER_CONCAT_IMPL(a, b) a##b
+#define RIGEL_PROFILER_CONCAT(a, b) RIGEL_PROFILER_CONCAT_IMPL(a, b)
+
+/** Measure time spent in the enclosing scope, see base/profiler.hpp */
+#define RIGEL_PROFILE_SCOPE(name)                                              \
+  const ::rigel::base::profiler::ScopedTimer RIGEL_PROFILER_CONCAT(            \
+    rigelProfilerScope, __LINE__)(name)
@@ -0,0 +1,69 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace rigel::base
+{
+
+/** Incremental, non-cryptographic hash for detecting game state divergence
+ *
+ * Feed in all relevant parts of the state via add() and addBytes(), then
+ * query the result via value(). Uses 64-bit FNV-1a, which is cheap to compute
+ * and good enough to make accidental collisions between different game
+ * states very unlikely.
+ *
+ * Values are hashed according to their in-memory representation, so the
+ * result is only comparable between builds targeting the same platform.
+ */
+class StateHasher
+{
+public:
+  void addBytes(const void* pData, const std::size_t size)
+  {
+    const auto pBytes = static_cast<const std::uint8_t*>(pData);
+
+    for (auto i = std::size_t{0}; i < size; ++i)
+    {
+      mHash ^= pBytes[i];
+      mHash *= FNV_PRIME;
+    }
+  }
+
+  template <typename T>
+  void add(const T& value)
+  {
+    static_assert(
+      std::is_arithmetic_v<T> || std::is_enum_v<T>,
+      "Only plain values can be hashed directly");
+    addBytes(&value, sizeof(T));
+  }
+
+  std::uint64_t value() const { return mHash; }
+
+private:
+  static constexpr std::uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+  static constexpr std::uint64_t FNV_PRIME = 0x100000001B3;
+
+  std::uint64_t mHash = FNV_OFFSET_BASIS;
+};
+
+} // namespace rigel::base
@@ -131,6 +131,9 @@ struct GameOptions
   bool mEnableScreenFlashes = true;
   UpscalingFilter mUpscalingFilter = UpscalingFilter::None;
   bool mAspectRatioCorrectionEnabled = true;
+  bool mDeferredDrawBatching = false;
+  bool mMultiTextureBatching = false;
+  bool mSinglePassMapRendering = false;
 
   // Sound
   float mMusicVolume = MUSIC_VOLUME_DEFAULT;
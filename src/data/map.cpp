@@ -16,6 +16,8 @@
 
 #include "map.hpp"
 
+#include "base/bit_scan.hpp"
+#include "base/state_hasher.hpp"
 #include "data/game_traits.hpp"
 
 #include <algorithm>
@@ -30,6 +32,28 @@ namespace rigel::data::map
 using namespace std;
 
 
+namespace
+{
+
+constexpr auto BITS_PER_WORD = 64;
+
+
+size_t numWords(const size_t numBits)
+{
+  return (numBits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+
+void setBit(vector<uint64_t>& words, const size_t index, const bool value)
+{
+  const auto mask = uint64_t{1} << (index % BITS_PER_WORD);
+  auto& word = words[index / BITS_PER_WORD];
+  word = value ? (word | mask) : (word & ~mask);
+}
+
+} // namespace
+
+
 Map::Map(
   const int widthInTiles,
   const int heightInTiles,
@@ -40,9 +64,29 @@ Map::Map(
   , mWidthInTiles(static_cast<size_t>(widthInTiles))
   , mHeightInTiles(static_cast<size_t>(heightInTiles))
   , mAttributes(std::move(attributes))
+  , mWordsPerRow(numWords(mWidthInTiles))
+  , mWordsPerColumn(numWords(mHeightInTiles))
 {
   assert(widthInTiles >= 0);
   assert(heightInTiles >= 0);
+
+  for (auto& plane : mSolidEdgeRows)
+  {
+    plane.resize(mWordsPerRow * mHeightInTiles);
+  }
+
+  for (auto& plane : mSolidEdgeColumns)
+  {
+    plane.resize(mWordsPerColumn * mWidthInTiles);
+  }
+
+  for (auto y = 0; y < heightInTiles; ++y)
+  {
+    for (auto x = 0; x < widthInTiles; ++x)
+    {
+      updateSolidEdgeBits(x, y);
+    }
+  }
 }
 
 
@@ -59,6 +103,13 @@ void Map::setTileAt(const int layer, const int x, const int y, TileIndex index)
     throw invalid_argument("Tile index too large for tile set");
   }
   tileRefAt(layer, x, y) = index;
+  updateSolidEdgeBits(x, y);
+}
+
+
+base::ArrayView<TileIndex> Map::layerData(const int layer) const
+{
+  return mLayers[static_cast<std::size_t>(layer)];
 }
 
 
@@ -125,16 +176,102 @@ CollisionData Map::collisionData(const int x, const int y) const
     return CollisionData{};
   }
 
-  if (tileAt(0, x, y) != 0 && tileAt(1, x, y) != 0)
+  return tileCollisionData(x, y);
+}
+
+
+bool Map::isSolidInRow(
+  const int startX,
+  const int endX,
+  const int y,
+  const SolidEdge edge) const
+{
+  if (startX > endX)
   {
-    // "Composite" tiles (content on both layers) are ignored for collision
-    // checking
-    return CollisionData{};
+    return false;
   }
 
-  const auto data1 = mAttributes.collisionData(tileAt(0, x, y));
-  const auto data2 = mAttributes.collisionData(tileAt(1, x, y));
-  return CollisionData{data1, data2};
+  if (startX < 0 || static_cast<size_t>(endX) >= mWidthInTiles)
+  {
+    // Left/right edge of the map are always solid
+    return true;
+  }
+
+  if (static_cast<size_t>(y) >= mHeightInTiles)
+  {
+    return false;
+  }
+
+  for (auto i = 0u; i < mSolidEdgeRows.size(); ++i)
+  {
+    if ((edge.mFlagsBitPack & (1 << i)) == 0)
+    {
+      continue;
+    }
+
+    const auto pRow = mSolidEdgeRows[i].data() + y * mWordsPerRow;
+    if (base::anyBitSet(pRow, startX, endX))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool Map::isSolidInColumn(
+  const int x,
+  const int startY,
+  const int endY,
+  const SolidEdge edge) const
+{
+  if (startY > endY)
+  {
+    return false;
+  }
+
+  if (static_cast<size_t>(x) >= mWidthInTiles)
+  {
+    return true;
+  }
+
+  // Bottom/top edge of the map are never solid, so we only need to look at
+  // the part of the span that's inside the map.
+  const auto firstY = std::max(startY, 0);
+  const auto lastY = std::min(endY, static_cast<int>(mHeightInTiles) - 1);
+  if (firstY > lastY)
+  {
+    return false;
+  }
+
+  for (auto i = 0u; i < mSolidEdgeColumns.size(); ++i)
+  {
+    if ((edge.mFlagsBitPack & (1 << i)) == 0)
+    {
+      continue;
+    }
+
+    const auto pColumn = mSolidEdgeColumns[i].data() + x * mWordsPerColumn;
+    if (base::anyBitSet(pColumn, firstY, lastY))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void Map::addToHash(base::StateHasher& hasher) const
+{
+  hasher.add(mWidthInTiles);
+  hasher.add(mHeightInTiles);
+
+  for (const auto& layer : mLayers)
+  {
+    hasher.addBytes(layer.data(), layer.size() * sizeof(TileIndex));
+  }
 }
 
 
@@ -168,4 +305,37 @@ map::TileIndex& Map::tileRefAt(const int layer, const int x, const int y)
 }
 
 
+CollisionData Map::tileCollisionData(const int x, const int y) const
+{
+  if (tileAt(0, x, y) != 0 && tileAt(1, x, y) != 0)
+  {
+    // "Composite" tiles (content on both layers) are ignored for collision
+    // checking
+    return CollisionData{};
+  }
+
+  const auto data1 = mAttributes.collisionData(tileAt(0, x, y));
+  const auto data2 = mAttributes.collisionData(tileAt(1, x, y));
+  return CollisionData{data1, data2};
+}
+
+
+void Map::updateSolidEdgeBits(const int x, const int y)
+{
+  const auto data = tileCollisionData(x, y);
+  const auto col = static_cast<size_t>(x);
+  const auto row = static_cast<size_t>(y);
+  const auto rowBitIndex = row * mWordsPerRow * BITS_PER_WORD + col;
+  const auto columnBitIndex = col * mWordsPerColumn * BITS_PER_WORD + row;
+
+  for (auto i = 0u; i < mSolidEdgeRows.size(); ++i)
+  {
+    const auto isSolid =
+      data.isSolidOn(SolidEdge{static_cast<uint8_t>(1 << i)});
+    setBit(mSolidEdgeRows[i], rowBitIndex, isSolid);
+    setBit(mSolidEdgeColumns[i], columnBitIndex, isSolid);
+  }
+}
+
+
 } // namespace rigel::data::map
@@ -16,17 +16,25 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/spatial_types.hpp"
 #include "data/actor_ids.hpp"
 #include "data/tile_attributes.hpp"
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
 
+namespace rigel::base
+{
+class StateHasher;
+}
+
+
 namespace rigel::data::map
 {
 
@@ -58,6 +66,9 @@ public:
 
   void setTileAt(int layer, int x, int y, TileIndex index);
 
+  /** Tile indices of the given layer, row by row */
+  base::ArrayView<TileIndex> layerData(int layer) const;
+
   int width() const { return static_cast<int>(mWidthInTiles); }
 
   int height() const { return static_cast<int>(mHeightInTiles); }
@@ -69,10 +80,33 @@ public:
 
   CollisionData collisionData(int x, int y) const;
 
+  /** Test if any tile in the given horizontal span is solid on given edge
+   *
+   * Gives the same result as checking collisionData() for each tile in the
+   * span, but works on precomputed bit planes, testing up to 64 tiles at
+   * once.
+   */
+  bool isSolidInRow(int startX, int endX, int y, SolidEdge edge) const;
+
+  /** Test if any tile in the given vertical span is solid on given edge
+   *
+   * See isSolidInRow().
+   */
+  bool isSolidInColumn(int x, int startY, int endY, SolidEdge edge) const;
+
+  /** Feed the contents of both layers into the given hasher
+   *
+   * Used for detecting divergence between replays, see frontend/replay.hpp
+   */
+  void addToHash(base::StateHasher& hasher) const;
+
 private:
   const TileIndex& tileRefAt(int layer, int x, int y) const;
   TileIndex& tileRefAt(int layer, int x, int y);
 
+  CollisionData tileCollisionData(int x, int y) const;
+  void updateSolidEdgeBits(int x, int y);
+
 private:
   using TileArray = std::vector<TileIndex>;
   std::array<TileArray, 2> mLayers;
@@ -81,6 +115,16 @@ private:
   std::size_t mHeightInTiles;
 
   TileAttributeDict mAttributes;
+
+  // Collision data for each of the 4 edges (in order of SolidEdge's bits),
+  // as one bit per tile. Stored both row by row and column by column, so
+  // that horizontal as well as vertical spans can be tested word-wise.
+  // Derived from the tiles, and kept up to date by setTileAt().
+  using BitPlane = std::vector<std::uint64_t>;
+  std::array<BitPlane, 4> mSolidEdgeRows;
+  std::array<BitPlane, 4> mSolidEdgeColumns;
+  std::size_t mWordsPerRow = 0;
+  std::size_t mWordsPerColumn = 0;
 };
 
 
@@ -38,6 +38,7 @@ public:
   static SolidEdge any();
 
   friend class CollisionData;
+  friend class Map;
 
 private:
   explicit SolidEdge(const std::uint8_t bitPack)
@@ -29,18 +29,69 @@ using data::map::SolidEdge;
 using namespace engine::components;
 
 
+namespace
+{
+
+// Size of a grid cell for static solid bodies, in tiles
+constexpr auto GRID_BLOCK_SIZE = 16;
+
+
+int numGridBlocks(const int sizeInTiles)
+{
+  return std::max(1, (sizeInTiles + GRID_BLOCK_SIZE - 1) / GRID_BLOCK_SIZE);
+}
+
+
+bool intersectsSolidBody(
+  const ex::Entity& entity,
+  const BoundingBox& worldSpaceBbox)
+{
+  if (
+    entity.has_component<BoundingBox>() &&
+    entity.has_component<WorldPosition>())
+  {
+    const auto solidBodyBbox = engine::toWorldSpace(
+      *entity.component<const BoundingBox>(),
+      *entity.component<const WorldPosition>());
+    return solidBodyBbox.intersects(worldSpaceBbox);
+  }
+
+  return false;
+}
+
+
+template <typename Container>
+void eraseEntity(Container& container, const ex::Entity& entity)
+{
+  const auto it = find(begin(container), end(container), entity);
+  if (it != end(container))
+  {
+    *it = container.back();
+    container.pop_back();
+  }
+}
+
+} // namespace
+
+
 CollisionChecker::CollisionChecker(
   const data::map::Map* pMap,
   ex::EntityManager& entities,
   ex::EventManager& eventManager)
-  : mpMap(pMap)
+  : mGridWidth(numGridBlocks(pMap->width()))
+  , mGridHeight(numGridBlocks(pMap->height()))
+  , mpMap(pMap)
 {
+  mGrid.resize(mGridWidth * mGridHeight);
+
   entities.each<SolidBody>([this](ex::Entity entity, const SolidBody&) {
-    mSolidBodies.push_back(entity);
+    addSolidBody(entity);
   });
 
   eventManager.subscribe<ex::ComponentAddedEvent<SolidBody>>(*this);
   eventManager.subscribe<ex::ComponentRemovedEvent<SolidBody>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<MovingBody>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<MovingBody>>(*this);
 }
 
 
@@ -95,15 +146,7 @@ bool CollisionChecker::testHorizontalSpan(
     }
   }
 
-  for (int x = startX; x <= endX; ++x)
-  {
-    if (mpMap->collisionData(x, y).isSolidOn(edge))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return mpMap->isSolidInRow(startX, endX, y, edge);
 }
 
 
@@ -122,37 +165,41 @@ bool CollisionChecker::testVerticalSpan(
     }
   }
 
-  for (int y = startY; y <= endY; ++y)
-  {
-    if (mpMap->collisionData(x, y).isSolidOn(edge))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return mpMap->isSolidInColumn(x, startY, endY, edge);
 }
 
 
 bool CollisionChecker::testSolidBodyCollision(
   const BoundingBox& bboxToTest) const
 {
-  return any_of(
-    begin(mSolidBodies),
-    end(mSolidBodies),
-    [&bboxToTest](const ex::Entity& entity) {
-      if (
-        entity.has_component<BoundingBox>() &&
-        entity.has_component<WorldPosition>())
+  auto intersects = [&bboxToTest](const ex::Entity& entity) {
+    return intersectsSolidBody(entity, bboxToTest);
+  };
+
+  if (any_of(begin(mDynamicSolidBodies), end(mDynamicSolidBodies), intersects))
+  {
+    return true;
+  }
+
+  if (mHasUnplacedBodies)
+  {
+    placeUnplacedBodiesInGrid();
+  }
+
+  const auto cells = gridCellsFor(bboxToTest);
+  for (auto row = cells.top(); row <= cells.bottom(); ++row)
+  {
+    for (auto col = cells.left(); col <= cells.right(); ++col)
+    {
+      const auto& cell = gridCell(col, row);
+      if (any_of(begin(cell), end(cell), intersects))
       {
-        const auto solidBodyBbox = engine::toWorldSpace(
-          *entity.component<const BoundingBox>(),
-          *entity.component<const WorldPosition>());
-        return solidBodyBbox.intersects(bboxToTest);
+        return true;
       }
+    }
+  }
 
-      return false;
-    });
+  return false;
 }
 
 
@@ -201,22 +248,195 @@ bool CollisionChecker::isTouchingRightWall(
 
 void CollisionChecker::receive(const ex::ComponentAddedEvent<SolidBody>& event)
 {
-  mSolidBodies.push_back(event.entity);
+  addSolidBody(event.entity);
 }
 
 
 void CollisionChecker::receive(
   const ex::ComponentRemovedEvent<SolidBody>& event)
 {
+  removeSolidBody(event.entity);
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentAddedEvent<MovingBody>& event)
+{
+  // A static solid body became dynamic
+  auto entity = event.entity;
+  if (entity.has_component<SolidBody>())
+  {
+    removeSolidBody(entity);
+    mDynamicSolidBodies.push_back(entity);
+  }
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentRemovedEvent<MovingBody>& event)
+{
+  // A dynamic solid body became static
+  auto entity = event.entity;
+  if (entity.has_component<SolidBody>())
+  {
+    removeSolidBody(entity);
+    mStaticSolidBodies.push_back(StaticSolidBody{entity, std::nullopt});
+    placeInGrid(mStaticSolidBodies.back());
+  }
+}
+
+
+void CollisionChecker::updateSolidBody(ex::Entity entity) const
+{
+  const auto it = find_if(
+    begin(mStaticSolidBodies),
+    end(mStaticSolidBodies),
+    [&entity](const StaticSolidBody& body) { return body.mEntity == entity; });
+
+  if (it != end(mStaticSolidBodies))
+  {
+    placeInGrid(*it);
+  }
+}
+
+
+void CollisionChecker::synchronizeSolidBodies() const
+{
+  for (auto& body : mStaticSolidBodies)
+  {
+    placeInGrid(body);
+  }
+
+  mHasUnplacedBodies = false;
+}
+
+
+void CollisionChecker::addSolidBody(ex::Entity entity)
+{
+  if (entity.has_component<MovingBody>())
+  {
+    mDynamicSolidBodies.push_back(entity);
+  }
+  else
+  {
+    mStaticSolidBodies.push_back(StaticSolidBody{entity, std::nullopt});
+    placeInGrid(mStaticSolidBodies.back());
+  }
+}
+
+
+void CollisionChecker::removeSolidBody(ex::Entity entity)
+{
+  eraseEntity(mDynamicSolidBodies, entity);
+
   const auto it = find_if(
-    begin(mSolidBodies), end(mSolidBodies), [&event](const auto& entity) {
-      return entity == event.entity;
-    });
+    begin(mStaticSolidBodies),
+    end(mStaticSolidBodies),
+    [&entity](const StaticSolidBody& body) { return body.mEntity == entity; });
 
-  if (it != end(mSolidBodies))
+  if (it != end(mStaticSolidBodies))
   {
-    mSolidBodies.erase(it);
+    removeFromGrid(*it);
+    mStaticSolidBodies.erase(it);
   }
 }
 
+
+void CollisionChecker::placeInGrid(StaticSolidBody& body) const
+{
+  const auto& entity = body.mEntity;
+  if (
+    !entity.has_component<BoundingBox>() ||
+    !entity.has_component<WorldPosition>())
+  {
+    // Components might be assigned after the SolidBody, e.g. when cloning
+    // entities for quick loading. We retry on the next query.
+    removeFromGrid(body);
+    mHasUnplacedBodies = true;
+    return;
+  }
+
+  const auto cells = gridCellsFor(engine::toWorldSpace(
+    *entity.component<const BoundingBox>(),
+    *entity.component<const WorldPosition>()));
+
+  if (body.mCells == cells)
+  {
+    return;
+  }
+
+  removeFromGrid(body);
+
+  for (auto row = cells.top(); row <= cells.bottom(); ++row)
+  {
+    for (auto col = cells.left(); col <= cells.right(); ++col)
+    {
+      gridCell(col, row).push_back(entity);
+    }
+  }
+
+  body.mCells = cells;
+}
+
+
+void CollisionChecker::removeFromGrid(StaticSolidBody& body) const
+{
+  if (!body.mCells)
+  {
+    return;
+  }
+
+  const auto& cells = *body.mCells;
+  for (auto row = cells.top(); row <= cells.bottom(); ++row)
+  {
+    for (auto col = cells.left(); col <= cells.right(); ++col)
+    {
+      eraseEntity(gridCell(col, row), body.mEntity);
+    }
+  }
+
+  body.mCells.reset();
+}
+
+
+void CollisionChecker::placeUnplacedBodiesInGrid() const
+{
+  mHasUnplacedBodies = false;
+
+  for (auto& body : mStaticSolidBodies)
+  {
+    if (!body.mCells)
+    {
+      placeInGrid(body);
+    }
+  }
+}
+
+
+base::Rect<int>
+  CollisionChecker::gridCellsFor(const BoundingBox& worldSpaceBbox) const
+{
+  // Anything outside of the map is assigned to the cells at the edges.
+  const auto toCol = [this](const int x) {
+    return std::clamp(x / GRID_BLOCK_SIZE, 0, mGridWidth - 1);
+  };
+  const auto toRow = [this](const int y) {
+    return std::clamp(y / GRID_BLOCK_SIZE, 0, mGridHeight - 1);
+  };
+
+  const auto left = toCol(worldSpaceBbox.left());
+  const auto top = toRow(worldSpaceBbox.top());
+  const auto right = toCol(worldSpaceBbox.right());
+  const auto bottom = toRow(worldSpaceBbox.bottom());
+
+  return base::Rect<int>{{left, top}, {right - left + 1, bottom - top + 1}};
+}
+
+
+std::vector<ex::Entity>&
+  CollisionChecker::gridCell(const int col, const int row) const
+{
+  return mGrid[col + row * mGridWidth];
+}
+
 } // namespace rigel::engine
@@ -21,6 +21,7 @@
 #include "engine/base_components.hpp"
 #include "engine/physical_components.hpp"
 
+#include <optional>
 #include <vector>
 
 RIGEL_DISABLE_WARNINGS
@@ -31,6 +32,19 @@ RIGEL_RESTORE_WARNINGS
 namespace rigel::engine
 {
 
+/** Answers collision queries against the map and solid bodies
+ *
+ * Solid bodies (entities with a SolidBody component) are divided into two
+ * groups: Those which also have a MovingBody are considered dynamic, and are
+ * always tested. All others are assumed to be mostly static, and are kept in
+ * a grid of map blocks, so that a query only needs to look at bodies in its
+ * vicinity.
+ *
+ * Adding and removing solid bodies is tracked automatically. When changing
+ * position or bounding box of a static solid body, updateSolidBody() needs
+ * to be called afterwards. The grid is also fully re-synchronized at the
+ * start of each physics update, see synchronizeSolidBodies().
+ */
 class CollisionChecker : public entityx::Receiver<CollisionChecker>
 {
 public:
@@ -70,12 +84,47 @@ public:
     receive(const entityx::ComponentAddedEvent<components::SolidBody>& event);
   void
     receive(const entityx::ComponentRemovedEvent<components::SolidBody>& event);
+  void
+    receive(const entityx::ComponentAddedEvent<components::MovingBody>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::MovingBody>& event);
+
+  /** Update grid placement of a static solid body after it has changed */
+  void updateSolidBody(entityx::Entity entity) const;
+
+  /** Update grid placement of all static solid bodies */
+  void synchronizeSolidBodies() const;
 
 private:
+  struct StaticSolidBody
+  {
+    entityx::Entity mEntity;
+
+    // Range of grid cells the body is currently registered in. Empty if the
+    // body is lacking a position or bounding box.
+    std::optional<base::Rect<int>> mCells;
+  };
+
   bool
     testSolidBodyCollision(const engine::components::BoundingBox& bbox) const;
 
-  std::vector<entityx::Entity> mSolidBodies;
+  void addSolidBody(entityx::Entity entity);
+  void removeSolidBody(entityx::Entity entity);
+  void placeInGrid(StaticSolidBody& body) const;
+  void removeFromGrid(StaticSolidBody& body) const;
+  void placeUnplacedBodiesInGrid() const;
+  base::Rect<int> gridCellsFor(
+    const engine::components::BoundingBox& worldSpaceBbox) const;
+  std::vector<entityx::Entity>& gridCell(int col, int row) const;
+
+  // The grid is a cache which is lazily kept up to date during queries,
+  // hence mutable.
+  std::vector<entityx::Entity> mDynamicSolidBodies;
+  mutable std::vector<StaticSolidBody> mStaticSolidBodies;
+  mutable std::vector<std::vector<entityx::Entity>> mGrid;
+  mutable bool mHasUnplacedBodies = false;
+  int mGridWidth;
+  int mGridHeight;
   const data::map::Map* mpMap;
 };
 
@@ -16,10 +16,16 @@
 
 #include "entity_activation_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/game_traits.hpp"
+#include "data/map.hpp"
 #include "engine/base_components.hpp"
 #include "engine/entity_tools.hpp"
 #include "engine/physical_components.hpp"
+#include "engine/visual_components.hpp"
+
+#include <algorithm>
+#include <cassert>
 
 
 namespace rigel::engine
@@ -31,6 +37,15 @@ using namespace components;
 namespace
 {
 
+constexpr auto GRID_BLOCK_SIZE = 16;
+
+
+int numGridBlocks(const int sizeInTiles)
+{
+  return std::max(1, (sizeInTiles + GRID_BLOCK_SIZE - 1) / GRID_BLOCK_SIZE);
+}
+
+
 bool determineActiveState(entityx::Entity entity, const bool inActiveRegion)
 {
   using Policy = ActivationSettings::Policy;
@@ -61,6 +76,23 @@ bool determineActiveState(entityx::Entity entity, const bool inActiveRegion)
   return inActiveRegion;
 }
 
+
+bool updateActiveState(
+  entityx::Entity entity,
+  const BoundingBox& worldSpaceBbox,
+  const BoundingBox& activeRegionBox)
+{
+  const auto inActiveRegion = worldSpaceBbox.intersects(activeRegionBox);
+  const auto active = determineActiveState(entity, inActiveRegion);
+  setTag<Active>(entity, active);
+  if (active)
+  {
+    entity.component<Active>()->mIsOnScreen = inActiveRegion;
+  }
+
+  return active;
+}
+
 } // namespace
 
 
@@ -87,15 +119,306 @@ void markActiveEntities(
                                         entityx::Entity entity,
                                         const WorldPosition& position,
                                         const BoundingBox& bbox) {
-    const auto worldSpaceBbox = toWorldSpace(bbox, position);
-    const auto inActiveRegion = worldSpaceBbox.intersects(activeRegionBox);
-    const auto active = determineActiveState(entity, inActiveRegion);
-    setTag<Active>(entity, active);
-    if (active)
+    updateActiveState(entity, toWorldSpace(bbox, position), activeRegionBox);
+  });
+}
+
+
+EntityActivationSystem::EntityActivationSystem(
+  const data::map::Map* pMap,
+  entityx::EntityManager& entities,
+  entityx::EventManager& eventManager)
+  : mGridWidth(numGridBlocks(pMap->width()))
+  , mGridHeight(numGridBlocks(pMap->height()))
+{
+  mGrid.resize(mGridWidth * mGridHeight);
+
+  entities.each<WorldPosition, BoundingBox>(
+    [this](entityx::Entity entity, const WorldPosition&, const BoundingBox&) {
+      mPendingEntities.push_back(entity);
+    });
+
+  eventManager.subscribe<entityx::EntityDestroyedEvent>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<BoundingBox>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<ActivationSettings>>(
+    *this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<Active>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<MovingBody>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<AnimationLoop>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<AnimationSequence>>(
+    *this);
+}
+
+
+void EntityActivationSystem::markActiveEntities(
+  const base::Vec2& cameraPosition,
+  const base::Size& viewportSize)
+{
+  RIGEL_PROFILE_SCOPE("EntityActivationSystem::markActiveEntities");
+
+  const BoundingBox activeRegionBox{cameraPosition, viewportSize};
+
+  // Assigning the Active tag below triggers our own event handlers, which
+  // we don't need.
+  mIsUpdating = true;
+
+  // Gather all entities which might have changed their active state: Those
+  // which were examined on the last frame, those which changed since then,
+  // and those in grid blocks overlapping the active region.
+  mCandidates.clear();
+
+  for (const auto entity : mExaminedEntities)
+  {
+    addCandidate(entity);
+  }
+
+  mExaminedEntities.clear();
+
+  for (const auto entity : mPendingEntities)
+  {
+    addCandidate(entity);
+  }
+
+  mPendingEntities.clear();
+
+  // Removing entities from the grid modifies the grid cells, so we can't do
+  // that while iterating over them.
+  mGridCandidates.clear();
+
+  const auto cells = gridCellsFor(activeRegionBox);
+  for (auto row = cells.top(); row <= cells.bottom(); ++row)
+  {
+    for (auto col = cells.left(); col <= cells.right(); ++col)
     {
-      entity.component<Active>()->mIsOnScreen = inActiveRegion;
+      const auto& cell = gridCell(col, row);
+      mGridCandidates.insert(mGridCandidates.end(), cell.begin(), cell.end());
     }
-  });
+  }
+
+  for (const auto entity : mGridCandidates)
+  {
+    addCandidate(entity);
+  }
+
+  // Now determine the active state for all candidates, and decide whether to
+  // keep examining them each frame or put them into the grid.
+  for (auto entity : mCandidates)
+  {
+    auto& info = trackingInfo(entity);
+
+    if (
+      !entity.has_component<WorldPosition>() ||
+      !entity.has_component<BoundingBox>())
+    {
+      info.mState = TrackingState::Untracked;
+      continue;
+    }
+
+    const auto worldSpaceBbox = toWorldSpace(
+      *entity.component<BoundingBox>(), *entity.component<WorldPosition>());
+    const auto active =
+      updateActiveState(entity, worldSpaceBbox, activeRegionBox);
+
+    // Animated entities can change their bounding box while inactive, see
+    // engine::updateAnimatedSprites
+    const auto mightChangeBounds = entity.has_component<MovingBody>() ||
+      entity.has_component<AnimationLoop>() ||
+      entity.has_component<AnimationSequence>();
+
+    if (active || mightChangeBounds)
+    {
+      info.mState = TrackingState::Examined;
+      mExaminedEntities.push_back(entity);
+    }
+    else
+    {
+      placeInGrid(info, worldSpaceBbox);
+    }
+  }
+
+  mIsUpdating = false;
+}
+
+
+void EntityActivationSystem::receive(const entityx::EntityDestroyedEvent& event)
+{
+  auto& info = trackingInfo(event.entity);
+  if (info.mState == TrackingState::InGrid)
+  {
+    removeFromGrid(info);
+  }
+
+  // Entity handles in mExaminedEntities and mPendingEntities are checked for
+  // validity when processing them. Since entity IDs might be reused, we
+  // reset the tracking state here.
+  info.mState = TrackingState::Untracked;
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<WorldPosition>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<BoundingBox>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<ActivationSettings>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<Active>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<MovingBody>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<AnimationLoop>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<AnimationSequence>& event)
+{
+  addPendingEntity(event.entity);
+}
+
+
+EntityActivationSystem::TrackedEntity&
+  EntityActivationSystem::trackingInfo(entityx::Entity entity)
+{
+  const auto index = entity.id().index();
+  if (index >= mTrackingInfo.size())
+  {
+    mTrackingInfo.resize(index + 1);
+  }
+
+  auto& info = mTrackingInfo[index];
+  if (info.mEntity != entity)
+  {
+    // Entity ID has been reused since we last saw this index
+    assert(info.mState != TrackingState::InGrid);
+    info = TrackedEntity{entity};
+  }
+
+  return info;
+}
+
+
+void EntityActivationSystem::addCandidate(entityx::Entity entity)
+{
+  if (!entity.valid())
+  {
+    return;
+  }
+
+  auto& info = trackingInfo(entity);
+  if (info.mState == TrackingState::Candidate)
+  {
+    return;
+  }
+
+  if (info.mState == TrackingState::InGrid)
+  {
+    removeFromGrid(info);
+  }
+
+  info.mState = TrackingState::Candidate;
+  mCandidates.push_back(entity);
+}
+
+
+void EntityActivationSystem::addPendingEntity(entityx::Entity entity)
+{
+  if (!mIsUpdating)
+  {
+    mPendingEntities.push_back(entity);
+  }
+}
+
+
+void EntityActivationSystem::placeInGrid(
+  TrackedEntity& info,
+  const BoundingBox& worldSpaceBbox)
+{
+  info.mState = TrackingState::InGrid;
+  info.mCells = gridCellsFor(worldSpaceBbox);
+
+  for (auto row = info.mCells.top(); row <= info.mCells.bottom(); ++row)
+  {
+    for (auto col = info.mCells.left(); col <= info.mCells.right(); ++col)
+    {
+      gridCell(col, row).push_back(info.mEntity);
+    }
+  }
+}
+
+
+void EntityActivationSystem::removeFromGrid(TrackedEntity& info)
+{
+  for (auto row = info.mCells.top(); row <= info.mCells.bottom(); ++row)
+  {
+    for (auto col = info.mCells.left(); col <= info.mCells.right(); ++col)
+    {
+      auto& cell = gridCell(col, row);
+      const auto iEntity = std::find(cell.begin(), cell.end(), info.mEntity);
+      assert(iEntity != cell.end());
+
+      *iEntity = cell.back();
+      cell.pop_back();
+    }
+  }
+
+  info.mState = TrackingState::Untracked;
+}
+
+
+base::Rect<int> EntityActivationSystem::gridCellsFor(
+  const BoundingBox& worldSpaceBbox) const
+{
+  // Entities outside of the map are put into the blocks at the map's edges.
+  // That's fine since the actual bounding box is checked when examining
+  // candidates.
+  const auto toCell = [](const int coordinate, const int numBlocks) {
+    return std::clamp(coordinate / GRID_BLOCK_SIZE, 0, numBlocks - 1);
+  };
+
+  const auto left = toCell(worldSpaceBbox.left(), mGridWidth);
+  const auto top = toCell(worldSpaceBbox.top(), mGridHeight);
+  const auto right = toCell(
+    std::max(worldSpaceBbox.left(), worldSpaceBbox.right()), mGridWidth);
+  const auto bottom = toCell(
+    std::max(worldSpaceBbox.top(), worldSpaceBbox.bottom()), mGridHeight);
+
+  return base::Rect<int>{{left, top}, {right - left + 1, bottom - top + 1}};
+}
+
+
+std::vector<entityx::Entity>&
+  EntityActivationSystem::gridCell(const int col, const int row)
+{
+  return mGrid[col + row * mGridWidth];
 }
 
 } // namespace rigel::engine
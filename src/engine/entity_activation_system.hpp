@@ -18,18 +18,130 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <vector>
+
+
+namespace rigel::data::map
+{
+class Map;
+}
+
+namespace rigel::engine::components
+{
+struct AnimationLoop;
+struct AnimationSequence;
+} // namespace rigel::engine::components
+
 
 namespace rigel::engine
 {
 
+/** Assign or remove the Active tag for all entities
+ *
+ * Looks at all entities with a position and bounding box, and determines
+ * whether they are active based on their ActivationSettings and whether they
+ * are currently within the active region (camera position + viewport size).
+ */
 void markActiveEntities(
   entityx::EntityManager& es,
   const base::Vec2& cameraPosition,
   const base::Size& viewportSize);
 
-}
+
+/** Incremental version of markActiveEntities()
+ *
+ * Gives the same results, but without looking at all entities every frame.
+ * Inactive entities are kept in a grid of map blocks, and only those in
+ * blocks overlapping the active region are examined. Entities which are
+ * active, have a MovingBody, or are animated (AnimationLoop or
+ * AnimationSequence), are examined every frame.
+ *
+ * This relies on gridded entities not changing their position or bounding
+ * box. Game logic and physics only operate on active entities, but sprite
+ * animations also run for inactive ones, and adjust the bounding box to the
+ * current animation frame (see engine::updateAnimatedSprites). That's why
+ * animated entities are never put into the grid. Newly created entities,
+ * and entities which get a position, bounding box, activation settings,
+ * animation or Active tag assigned, are picked up automatically.
+ */
+class EntityActivationSystem
+  : public entityx::Receiver<EntityActivationSystem>
+{
+public:
+  EntityActivationSystem(
+    const data::map::Map* pMap,
+    entityx::EntityManager& entities,
+    entityx::EventManager& eventManager);
+
+  void markActiveEntities(
+    const base::Vec2& cameraPosition,
+    const base::Size& viewportSize);
+
+  void receive(const entityx::EntityDestroyedEvent& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::BoundingBox>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::ActivationSettings>& event);
+  void receive(const entityx::ComponentAddedEvent<components::Active>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::MovingBody>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::AnimationLoop>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::AnimationSequence>& event);
+
+private:
+  enum class TrackingState
+  {
+    Untracked,
+    Examined,
+    InGrid,
+    Candidate
+  };
+
+  struct TrackedEntity
+  {
+    entityx::Entity mEntity;
+    TrackingState mState = TrackingState::Untracked;
+
+    // Range of grid cells the entity is registered in, if in grid
+    base::Rect<int> mCells;
+  };
+
+  TrackedEntity& trackingInfo(entityx::Entity entity);
+  void addCandidate(entityx::Entity entity);
+  void addPendingEntity(entityx::Entity entity);
+  void placeInGrid(
+    TrackedEntity& info,
+    const components::BoundingBox& worldSpaceBbox);
+  void removeFromGrid(TrackedEntity& info);
+  base::Rect<int>
+    gridCellsFor(const components::BoundingBox& worldSpaceBbox) const;
+  std::vector<entityx::Entity>& gridCell(int col, int row);
+
+  std::vector<TrackedEntity> mTrackingInfo;
+  std::vector<std::vector<entityx::Entity>> mGrid;
+
+  // Entities which need to be examined on each frame
+  std::vector<entityx::Entity> mExaminedEntities;
+
+  // Entities which have changed since the last update
+  std::vector<entityx::Entity> mPendingEntities;
+
+  std::vector<entityx::Entity> mCandidates;
+  std::vector<entityx::Entity> mGridCandidates;
+  int mGridWidth;
+  int mGridHeight;
+  bool mIsUpdating = false;
+};
+
+} // namespace rigel::engine
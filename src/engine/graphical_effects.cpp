@@ -16,6 +16,7 @@
 
 #include "graphical_effects.hpp"
 
+#include "base/profiler.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "renderer/renderer.hpp"
@@ -398,6 +399,8 @@ void SpecialEffectsRenderer::rebuildBackgroundBuffer(
 
 void SpecialEffectsRenderer::drawBackgroundBuffer()
 {
+  RIGEL_PROFILE_SCOPE("SpecialEffectsRenderer::drawBackgroundBuffer");
+
   auto saved = renderer::saveState(mpRenderer);
   mpRenderer->setGlobalScale({1.0f, 1.0f});
   mpRenderer->setGlobalTranslation({});
@@ -409,6 +412,8 @@ void SpecialEffectsRenderer::drawWaterEffect(
   base::ArrayView<WaterEffectArea> areas,
   int surfaceAnimationStep)
 {
+  RIGEL_PROFILE_SCOPE("SpecialEffectsRenderer::drawWaterEffect");
+
   if (areas.empty())
   {
     return;
@@ -16,6 +16,7 @@
 
 #include "life_time_system.hpp"
 
+#include "base/profiler.hpp"
 #include "engine/physical_components.hpp"
 
 
@@ -27,6 +28,8 @@ void LifeTimeSystem::update(
   const base::Vec2& cameraPosition,
   const base::Size& viewportSize)
 {
+  RIGEL_PROFILE_SCOPE("LifeTimeSystem::update");
+
   namespace c = components;
   using Condition = components::AutoDestroy::Condition;
 
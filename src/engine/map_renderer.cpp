@@ -17,12 +17,16 @@
 #include "map_renderer.hpp"
 
 #include "base/math_utils.hpp"
+#include "base/parallel_for.hpp"
+#include "base/profiler.hpp"
 #include "base/static_vector.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
+#include "renderer/custom_quad_batch.hpp"
 #include "renderer/vertex_buffer_utils.hpp"
 #include "renderer/viewport_utils.hpp"
 
+#include <algorithm>
 #include <cfenv>
 #include <iostream>
 
@@ -52,6 +56,167 @@ const auto AUTO_SCROLL_PX_PER_SECOND_HORIZONTAL = 30.0f;
 const auto AUTO_SCROLL_PX_PER_SECOND_VERTICAL = 60.0f;
 
 
+const char* VERTEX_SOURCE_TILES = R"shd(
+ATTRIBUTE HIGHP vec2 position;
+ATTRIBUTE HIGHP vec2 texCoord;
+ATTRIBUTE float animationType;
+
+OUT HIGHP vec2 texCoordFrag;
+
+uniform mat4 transform;
+uniform HIGHP vec2 animationOffsets;
+
+void main() {
+  gl_Position = transform * vec4(position, 0.0, 1.0);
+
+  // Animated tiles have their frames next to each other in the tile set.
+  // Offsetting the texture coordinates by the width of a tile thus
+  // selects the next frame.
+  HIGHP float offset = 0.0;
+  if (animationType > 1.5) {
+    offset = animationOffsets.y;
+  } else if (animationType > 0.5) {
+    offset = animationOffsets.x;
+  }
+
+  texCoordFrag = vec2(texCoord.x + offset, 1.0 - texCoord.y);
+}
+)shd";
+
+
+const char* FRAGMENT_SOURCE_TILES = R"shd(
+DEFAULT_PRECISION_DECLARATION
+OUTPUT_COLOR_DECLARATION
+
+IN HIGHP vec2 texCoordFrag;
+
+uniform sampler2D textureData;
+
+void main() {
+  OUTPUT_COLOR = TEXTURE_LOOKUP(textureData, texCoordFrag);
+}
+)shd";
+
+
+constexpr auto TILE_SHADER_TEXTURE_UNIT_NAMES = std::array{"textureData"};
+
+const renderer::ShaderSpec TILE_SHADER{
+  renderer::VertexLayout::PositionTexCoordsAndAnimationType,
+  TILE_SHADER_TEXTURE_UNIT_NAMES,
+  VERTEX_SOURCE_TILES,
+  FRAGMENT_SOURCE_TILES};
+
+
+const char* VERTEX_SOURCE_TILE_MAP = R"shd(
+ATTRIBUTE HIGHP vec2 position;
+ATTRIBUTE HIGHP vec2 texCoord;
+
+OUT HIGHP vec2 mapPosition;
+
+uniform mat4 transform;
+
+void main() {
+  gl_Position = transform * vec4(position, 0.0, 1.0);
+  mapPosition = texCoord;
+}
+)shd";
+
+
+const char* FRAGMENT_SOURCE_TILE_MAP = R"shd(
+DEFAULT_PRECISION_DECLARATION
+OUTPUT_COLOR_DECLARATION
+
+IN HIGHP vec2 mapPosition;
+
+uniform sampler2D tileSetData;
+uniform sampler2D mapData;
+
+uniform HIGHP vec2 mapSize;
+uniform HIGHP vec2 tileSetSize;
+uniform HIGHP vec2 animationFrames;
+
+HIGHP float decodeTileValue(HIGHP vec2 bytes) {
+  return floor(bytes.x * 255.0 + 0.5) + floor(bytes.y * 255.0 + 0.5) * 256.0;
+}
+
+vec4 tileColor(HIGHP float value, HIGHP vec2 positionInTile) {
+  if (value < 0.5) {
+    return vec4(0.0);
+  }
+
+  // Upper 4 bits are the animation type, lower 12 bits the tile index
+  HIGHP float animationType = floor(value / 4096.0);
+  HIGHP float tileIndex = value - animationType * 4096.0;
+
+  if (animationType > 1.5) {
+    tileIndex += animationFrames.y;
+  } else if (animationType > 0.5) {
+    tileIndex += animationFrames.x;
+  }
+
+  HIGHP float row = floor((tileIndex + 0.5) / tileSetSize.x);
+  HIGHP float column = tileIndex - row * tileSetSize.x;
+  HIGHP vec2 texCoord = (vec2(column, row) + positionInTile) / tileSetSize;
+  return TEXTURE_LOOKUP(tileSetData, vec2(texCoord.x, 1.0 - texCoord.y));
+}
+
+void main() {
+  HIGHP vec2 mapCell = floor(mapPosition);
+  HIGHP vec2 positionInTile = mapPosition - mapCell;
+  HIGHP vec4 cellData = TEXTURE_LOOKUP(mapData, (mapCell + 0.5) / mapSize);
+
+  vec4 layer0 = tileColor(decodeTileValue(cellData.rg), positionInTile);
+  vec4 layer1 = tileColor(decodeTileValue(cellData.ba), positionInTile);
+  OUTPUT_COLOR = mix(layer0, layer1, layer1.a);
+}
+)shd";
+
+
+constexpr auto TILE_MAP_SHADER_TEXTURE_UNIT_NAMES =
+  std::array{"tileSetData", "mapData"};
+
+const renderer::ShaderSpec TILE_MAP_SHADER{
+  renderer::VertexLayout::PositionAndTexCoords,
+  TILE_MAP_SHADER_TEXTURE_UNIT_NAMES,
+  VERTEX_SOURCE_TILE_MAP,
+  FRAGMENT_SOURCE_TILE_MAP};
+
+
+// Animation types, as understood by the tile shaders
+constexpr auto ANIMATION_TYPE_NONE = 0;
+constexpr auto ANIMATION_TYPE_FAST = 1;
+constexpr auto ANIMATION_TYPE_SLOW = 2;
+
+// Position of the animation type in the tile map texture's tile values
+constexpr auto TILE_MAP_ANIMATION_TYPE_SHIFT = 12;
+
+static_assert(
+  GameTraits::CZone::numTilesTotal <= (1 << TILE_MAP_ANIMATION_TYPE_SHIFT));
+
+
+int animationType(const map::TileAttributes& attributes)
+{
+  if (!attributes.isAnimated())
+  {
+    return ANIMATION_TYPE_NONE;
+  }
+
+  return attributes.isFastAnimation() ? ANIMATION_TYPE_FAST
+                                      : ANIMATION_TYPE_SLOW;
+}
+
+
+bool canAnimateInShader(
+  const map::TileIndex tileIndex,
+  const TiledTexture& tileSetTexture)
+{
+  // The shader can only select animation frames which are in the same row
+  // of the tile set image as the first frame.
+  const auto tilesPerRow = tileSetTexture.tilesPerRow();
+  return int(tileIndex) % tilesPerRow + ANIM_STATES <= tilesPerRow;
+}
+
+
 struct TileBlockData
 {
   std::vector<float> mVertices;
@@ -80,22 +245,29 @@ std::array<TileBlockData, 2> createBlockData(
         return;
       }
 
-      const auto isForeground =
-        map.attributeDict().attributes(tileIndex).isForeGround();
-      const auto targetIndex = isForeground ? 1 : 0;
+      const auto attributes = map.attributeDict().attributes(tileIndex);
+      const auto targetIndex = attributes.isForeGround() ? 1 : 0;
       auto& targetBlockData = blockData[targetIndex];
 
-      const auto isAnimated =
-        map.attributeDict().attributes(tileIndex).isAnimated();
-      if (isAnimated)
+      if (
+        attributes.isAnimated() &&
+        !canAnimateInShader(tileIndex, tileSetTexture))
       {
         targetBlockData.mAnimatedTiles.push_back({{x, y}, tileIndex});
       }
       else
       {
+        // 4 * (x, y, u, v), each vertex gets the animation type appended
         const auto vertices = tileSetTexture.generateVertices(tileIndex, x, y);
-        targetBlockData.mVertices.insert(
-          targetBlockData.mVertices.end(), vertices.begin(), vertices.end());
+        for (auto i = 0u; i < vertices.size(); i += 4)
+        {
+          targetBlockData.mVertices.insert(
+            targetBlockData.mVertices.end(),
+            vertices.begin() + i,
+            vertices.begin() + i + 4);
+          targetBlockData.mVertices.push_back(
+            float(animationType(attributes)));
+        }
       }
     };
 
@@ -113,23 +285,19 @@ std::array<TileBlockData, 2> createBlockData(
 }
 
 
-void buildBlock(
-  const int blockX,
-  const int blockY,
+void addBlock(
+  std::array<TileBlockData, 2>& blockData,
   TileRenderData& renderData,
-  const data::map::Map& map,
-  const TiledTexture& tileSetTexture,
   renderer::Renderer* pRenderer)
 {
-  const auto blockData = createBlockData(blockX, blockY, map, tileSetTexture);
-
   for (auto layer = 0; layer < 2; ++layer)
   {
     auto& data = blockData[layer];
 
     auto buffer = data.mVertices.empty()
       ? renderer::INVALID_VERTEX_BUFFER_ID
-      : pRenderer->createVertexBuffer(data.mVertices);
+      : pRenderer->createVertexBuffer(
+          data.mVertices, TILE_SHADER.mVertexLayout);
 
     renderData.mLayers[layer].push_back(
       {buffer, std::move(data.mAnimatedTiles)});
@@ -155,7 +323,8 @@ void rebuildBlock(
 
     auto buffer = data.mVertices.empty()
       ? renderer::INVALID_VERTEX_BUFFER_ID
-      : pRenderer->createVertexBuffer(data.mVertices);
+      : pRenderer->createVertexBuffer(
+          data.mVertices, TILE_SHADER.mVertexLayout);
 
     auto& block = renderData.mLayers[layer][blockIndex];
 
@@ -177,13 +346,77 @@ TileRenderData buildRenderData(
   const auto numBlocksX = base::integerDivCeil(map.width(), BLOCK_SIZE);
   const auto numBlocksY = base::integerDivCeil(map.height(), BLOCK_SIZE);
 
+  // Generating vertices only needs the map and tile set, so it can be done
+  // on worker threads. Creating the vertex buffers needs to happen on the
+  // render thread.
+  auto blockData =
+    std::vector<std::array<TileBlockData, 2>>(numBlocksX * numBlocksY);
+  base::parallelFor(blockData.size(), [&](const size_t blockIndex) {
+    const auto blockX = int(blockIndex) % numBlocksX;
+    const auto blockY = int(blockIndex) / numBlocksX;
+    blockData[blockIndex] =
+      createBlockData(blockX, blockY, map, tileSetTexture);
+  });
+
   TileRenderData result{{numBlocksX, numBlocksY}, pRenderer};
 
-  for (auto blockY = 0; blockY < numBlocksY; ++blockY)
+  for (auto& data : blockData)
+  {
+    addBlock(data, result, pRenderer);
+  }
+
+  return result;
+}
+
+
+base::Rect<int> blockSection(
+  const int blockIndex,
+  const base::Size& numBlocks,
+  const base::Size& mapSize)
+{
+  const auto left = blockIndex % numBlocks.width * BLOCK_SIZE;
+  const auto top = blockIndex / numBlocks.width * BLOCK_SIZE;
+  return {
+    {left, top},
+    {std::min(BLOCK_SIZE, mapSize.width - left),
+     std::min(BLOCK_SIZE, mapSize.height - top)}};
+}
+
+
+/** Create data for the tile map textures used in single-pass rendering
+ *
+ * There's one RGBA texel per map cell, holding the tiles of both map layers
+ * as 16-bit values (low byte first): The tile index in the lower 12 bits,
+ * and the animation type above that. Tiles which aren't drawn in the given
+ * draw mode are stored as 0, i.e. empty.
+ */
+std::vector<std::uint8_t> createTileMapTextureData(
+  const data::map::Map& map,
+  const base::Rect<int>& section,
+  const MapRenderer::DrawMode drawMode)
+{
+  const auto isForegroundPass = drawMode == MapRenderer::DrawMode::Foreground;
+
+  auto result = std::vector<std::uint8_t>{};
+  result.reserve(section.size.width * section.size.height * 4);
+
+  for (auto y = section.top(); y <= section.bottom(); ++y)
   {
-    for (auto blockX = 0; blockX < numBlocksX; ++blockX)
+    for (auto x = section.left(); x <= section.right(); ++x)
     {
-      buildBlock(blockX, blockY, result, map, tileSetTexture, pRenderer);
+      for (auto layer = 0; layer < 2; ++layer)
+      {
+        const auto tileIndex = map.tileAt(layer, x, y);
+        const auto attributes = map.attributeDict().attributes(tileIndex);
+        const auto value =
+          tileIndex != 0 && attributes.isForeGround() == isForegroundPass
+          ? int(tileIndex) |
+            animationType(attributes) << TILE_MAP_ANIMATION_TYPE_SHIFT
+          : 0;
+
+        result.push_back(std::uint8_t(value & 0xFF));
+        result.push_back(std::uint8_t(value >> 8));
+      }
     }
   }
 
@@ -292,7 +525,12 @@ MapRenderer::MapRenderer(
       TILE_SET_IMAGE_LOGICAL_SIZE,
       pRenderer)
   , mBackdropTexture(mpRenderer, renderData.mBackdropImage)
+  , mTileShader(TILE_SHADER)
   , mRenderData(buildRenderData(map, mTileSetTexture, pRenderer))
+  , mBlockIsOutOfDate(mRenderData.mLayers[0].size(), false)
+  , mTileMapShader(TILE_MAP_SHADER)
+  , mTileMapBlockIsOutOfDate(mRenderData.mLayers[0].size(), false)
+  , mMapSize{map.width(), map.height()}
   , mScrollMode(renderData.mBackdropScrollMode)
 {
   if (renderData.mSecondaryBackdropImage)
@@ -303,10 +541,16 @@ MapRenderer::MapRenderer(
 }
 
 
-void MapRenderer::synchronizeTo(const MapRenderer& other)
+auto MapRenderer::animationState() const -> AnimationState
+{
+  return {mBackdropAutoScrollOffset, mElapsedFrames};
+}
+
+
+void MapRenderer::setAnimationState(const AnimationState& state)
 {
-  mBackdropAutoScrollOffset = other.mBackdropAutoScrollOffset;
-  mElapsedFrames = other.mElapsedFrames;
+  mBackdropAutoScrollOffset = state.mBackdropAutoScrollOffset;
+  mElapsedFrames = state.mElapsedFrames;
 }
 
 
@@ -331,26 +575,74 @@ void MapRenderer::markAsChanged(const base::Vec2& position)
   const auto blockIndex =
     position.x / BLOCK_SIZE + position.y / BLOCK_SIZE * mRenderData.mSize.width;
 
-  mOutOfDateBlocks.set(blockIndex);
+  if (!mBlockIsOutOfDate[blockIndex])
+  {
+    mBlockIsOutOfDate[blockIndex] = true;
+    mOutOfDateBlocks.push_back(blockIndex);
+  }
+
+  if (mSinglePassRenderingEnabled && !mTileMapBlockIsOutOfDate[blockIndex])
+  {
+    mTileMapBlockIsOutOfDate[blockIndex] = true;
+    mOutOfDateTileMapBlocks.push_back(blockIndex);
+  }
 }
 
 
-void MapRenderer::rebuildChangedBlocks(const data::map::Map& map)
+void MapRenderer::rebuildChangedBlocks(
+  const data::map::Map& map,
+  const base::Rect<int>& visibleSection)
 {
-  if (mOutOfDateBlocks.none())
+  if (mOutOfDateBlocks.empty() && mOutOfDateTileMapBlocks.empty())
   {
     return;
   }
 
-  for (auto i = 0u; i < mOutOfDateBlocks.size(); ++i)
+  RIGEL_PROFILE_SCOPE("MapRenderer::rebuildChangedBlocks");
+
+  // Updating the tile map textures only requires uploading a few bytes per
+  // tile, so there's no need to spread it out.
+  for (const auto blockIndex : mOutOfDateTileMapBlocks)
+  {
+    updateTileMapTextures(
+      map, blockSection(blockIndex, mRenderData.mSize, mMapSize));
+    mTileMapBlockIsOutOfDate[blockIndex] = false;
+  }
+
+  mOutOfDateTileMapBlocks.clear();
+
+  const auto firstBlockX = visibleSection.left() / BLOCK_SIZE;
+  const auto firstBlockY = visibleSection.top() / BLOCK_SIZE;
+  const auto lastBlockX = visibleSection.right() / BLOCK_SIZE;
+  const auto lastBlockY = visibleSection.bottom() / BLOCK_SIZE;
+
+  auto isVisible = [&](const int blockIndex) {
+    const auto blockX = blockIndex % mRenderData.mSize.width;
+    const auto blockY = blockIndex / mRenderData.mSize.width;
+    return blockX >= firstBlockX && blockX <= lastBlockX &&
+      blockY >= firstBlockY && blockY <= lastBlockY;
+  };
+
+  // Blocks are rebuilt in the order in which they were marked as changed.
+  // Visible blocks can't wait, everything else is subject to the budget.
+  auto numOffscreenRebuilds = 0;
+  auto iRemaining = mOutOfDateBlocks.begin();
+  for (const auto blockIndex : mOutOfDateBlocks)
   {
-    if (mOutOfDateBlocks.test(i))
+    if (
+      !isVisible(blockIndex) &&
+      numOffscreenRebuilds++ >= MAX_OFFSCREEN_BLOCK_REBUILDS_PER_UPDATE)
     {
-      rebuildBlock(mRenderData, map, mTileSetTexture, mpRenderer, i);
+      *iRemaining++ = blockIndex;
+      continue;
     }
+
+    rebuildBlock(
+      mRenderData, map, mTileSetTexture, mpRenderer, size_t(blockIndex));
+    mBlockIsOutOfDate[blockIndex] = false;
   }
 
-  mOutOfDateBlocks.reset();
+  mOutOfDateBlocks.erase(iRemaining, mOutOfDateBlocks.end());
 }
 
 
@@ -360,6 +652,60 @@ void MapRenderer::rebuildAllBlocks(const data::map::Map& map)
   {
     rebuildBlock(mRenderData, map, mTileSetTexture, mpRenderer, i);
   }
+
+  std::fill(mBlockIsOutOfDate.begin(), mBlockIsOutOfDate.end(), false);
+  mOutOfDateBlocks.clear();
+
+  if (mSinglePassRenderingEnabled)
+  {
+    updateTileMapTextures(map, {{}, mMapSize});
+    std::fill(
+      mTileMapBlockIsOutOfDate.begin(), mTileMapBlockIsOutOfDate.end(), false);
+    mOutOfDateTileMapBlocks.clear();
+  }
+}
+
+
+void MapRenderer::setSinglePassRenderingEnabled(
+  const bool enabled,
+  const data::map::Map& map)
+{
+  if (enabled == mSinglePassRenderingEnabled)
+  {
+    return;
+  }
+
+  mSinglePassRenderingEnabled = enabled;
+
+  // The tile map textures are only kept around while needed. They are
+  // created from the current state of the map, so there's no need to track
+  // changes while disabled.
+  for (auto i = 0u; i < mTileMapTextures.size(); ++i)
+  {
+    mTileMapTextures[i] = enabled
+      ? renderer::DataTexture(
+          mpRenderer,
+          createTileMapTextureData(map, {{}, mMapSize}, DrawMode(i)),
+          mMapSize.width,
+          mMapSize.height)
+      : renderer::DataTexture{};
+  }
+
+  std::fill(
+    mTileMapBlockIsOutOfDate.begin(), mTileMapBlockIsOutOfDate.end(), false);
+  mOutOfDateTileMapBlocks.clear();
+}
+
+
+void MapRenderer::updateTileMapTextures(
+  const data::map::Map& map,
+  const base::Rect<int>& section)
+{
+  for (auto i = 0u; i < mTileMapTextures.size(); ++i)
+  {
+    mTileMapTextures[i].update(
+      section, createTileMapTextureData(map, section, DrawMode(i)));
+  }
 }
 
 
@@ -491,6 +837,12 @@ void MapRenderer::renderMapTiles(
   const base::Size& sectionSize,
   const DrawMode drawMode) const
 {
+  if (mSinglePassRenderingEnabled)
+  {
+    renderMapTilesSinglePass(sectionStart, sectionSize, drawMode);
+    return;
+  }
+
   const auto blockX = sectionStart.x / BLOCK_SIZE;
   const auto blockY = sectionStart.y / BLOCK_SIZE;
   const auto offsetInBlockX = sectionStart.x % BLOCK_SIZE;
@@ -518,7 +870,8 @@ void MapRenderer::renderMapTiles(
   };
 
 
-  base::static_vector<renderer::VertexBufferId, MAX_NUM_BLOCKS> blocksToRender;
+  base::static_vector<renderer::VertexBufferId, MAX_VISIBLE_BLOCKS>
+    blocksToRender;
 
   forEachVisibleBlock([&](const TileBlock& block) {
     if (block.mTilesBuffer != renderer::INVALID_VERTEX_BUFFER_ID)
@@ -532,7 +885,16 @@ void MapRenderer::renderMapTiles(
   const auto saved = renderer::saveState(mpRenderer);
   renderer::setLocalTranslation(mpRenderer, translation);
 
-  mpRenderer->submitVertexBuffers(blocksToRender, mTileSetTexture.textureId());
+  // Make sure that pending draws and state changes are processed before
+  // activating our own shader, since they would otherwise make use of it.
+  mpRenderer->submitBatch();
+
+  mTileShader.use();
+  mTileShader.setUniform(
+    "transform", renderer::computeTransformationMatrix(mpRenderer));
+  mTileShader.setUniform("animationOffsets", animationOffsets());
+  mpRenderer->submitVertexBuffers(
+    blocksToRender, mTileSetTexture.textureId(), mTileShader);
 
   forEachVisibleBlock([&](const TileBlock& block) {
     for (const auto& animated : block.mAnimatedTiles)
@@ -545,8 +907,57 @@ void MapRenderer::renderMapTiles(
 }
 
 
+void MapRenderer::renderMapTilesSinglePass(
+  const base::Vec2& sectionStart,
+  const base::Size& sectionSize,
+  const DrawMode drawMode) const
+{
+  // Only the part of the section which is inside the map needs to be drawn
+  const auto left = std::max(sectionStart.x, 0);
+  const auto top = std::max(sectionStart.y, 0);
+  const auto right =
+    std::min(sectionStart.x + sectionSize.width, mMapSize.width);
+  const auto bottom =
+    std::min(sectionStart.y + sectionSize.height, mMapSize.height);
+  if (right <= left || bottom <= top)
+  {
+    return;
+  }
+
+  // Texture coordinates are given in tiles, the shader derives the map cell
+  // and the position within the tile from them.
+  const auto offset = base::Vec2{left - sectionStart.x, top - sectionStart.y};
+  const auto vertices = renderer::createTexturedQuadVertices(
+    renderer::TexCoords{float(left), float(top), float(right), float(bottom)},
+    {data::tilesToPixels(offset),
+     data::tilesToPixels(base::Size{right - left, bottom - top})});
+  const auto textures = std::array{
+    mTileSetTexture.textureId(),
+    mTileMapTextures[static_cast<size_t>(drawMode)].data()};
+
+  // Make sure that pending draws and state changes are processed before
+  // activating our own shader, since they would otherwise make use of it.
+  mpRenderer->submitBatch();
+
+  mTileMapShader.use();
+  mTileMapShader.setUniform(
+    "transform", renderer::computeTransformationMatrix(mpRenderer));
+  mTileMapShader.setUniform(
+    "mapSize", glm::vec2{float(mMapSize.width), float(mMapSize.height)});
+  mTileMapShader.setUniform(
+    "tileSetSize",
+    glm::vec2{
+      float(GameTraits::CZone::tileSetImageWidth),
+      float(GameTraits::CZone::tileSetImageHeight)});
+  mTileMapShader.setUniform("animationFrames", animationFrames());
+  mpRenderer->drawCustomQuadBatch({textures, vertices, &mTileMapShader});
+}
+
+
 void MapRenderer::updateAnimatedMapTiles()
 {
+  RIGEL_PROFILE_SCOPE("MapRenderer::updateAnimatedMapTiles");
+
   ++mElapsedFrames;
 }
 
@@ -701,4 +1112,22 @@ map::TileIndex
   }
 }
 
+
+glm::vec2 MapRenderer::animationFrames() const
+{
+  const auto fastAnimOffset =
+    (mElapsedFrames / FAST_ANIM_FRAME_DELAY) % ANIM_STATES;
+  const auto slowAnimOffset =
+    (mElapsedFrames / SLOW_ANIM_FRAME_DELAY) % ANIM_STATES;
+
+  return {float(fastAnimOffset), float(slowAnimOffset)};
+}
+
+
+glm::vec2 MapRenderer::animationOffsets() const
+{
+  const auto tileWidth = 1.0f / mTileSetTexture.tilesPerRow();
+  return animationFrames() * tileWidth;
+}
+
 } // namespace rigel::engine
@@ -21,6 +21,7 @@
 #include "engine/tiled_texture.hpp"
 #include "engine/timing.hpp"
 #include "renderer/renderer.hpp"
+#include "renderer/shader.hpp"
 #include "renderer/texture.hpp"
 
 #include <array>
@@ -34,7 +35,13 @@ using PackedTileData = std::uint32_t;
 
 
 constexpr auto BLOCK_SIZE = 32;
-constexpr auto MAX_NUM_BLOCKS = 32;
+
+// Upper limit for the number of blocks overlapping the visible section
+constexpr auto MAX_VISIBLE_BLOCKS = 32;
+
+// How many out-of-date blocks outside of the visible section to rebuild
+// per call to MapRenderer::rebuildChangedBlocks()
+constexpr auto MAX_OFFSCREEN_BLOCK_REBUILDS_PER_UPDATE = 2;
 
 
 struct AnimatedTile
@@ -47,6 +54,8 @@ struct AnimatedTile
 struct TileBlock
 {
   renderer::VertexBufferId mTilesBuffer;
+
+  /** Animated tiles which can't be animated by the tile shader */
   std::vector<AnimatedTile> mAnimatedTiles;
 };
 
@@ -87,6 +96,17 @@ public:
     Foreground = 1
   };
 
+  /** State of backdrop scrolling and tile animations
+   *
+   * This is part of the game's simulation state, as opposed to the
+   * rendering resources, so it's saved and restored with quick saves.
+   */
+  struct AnimationState
+  {
+    float mBackdropAutoScrollOffset = 0.0f;
+    std::uint32_t mElapsedFrames = 0;
+  };
+
   struct MapRenderData
   {
     data::Image mTileSetImage;
@@ -101,16 +121,42 @@ public:
     const data::map::TileAttributeDict* pTileAttributes,
     MapRenderData&& renderData);
 
-  void synchronizeTo(const MapRenderer& other);
+  AnimationState animationState() const;
+  void setAnimationState(const AnimationState& state);
 
   bool hasHighResReplacements() const;
 
   void switchBackdrops();
 
   void markAsChanged(const base::Vec2& position);
-  void rebuildChangedBlocks(const data::map::Map& map);
+
+  /** Rebuild render data for blocks marked as changed
+   *
+   * Blocks overlapping the given section (in tiles) are always rebuilt
+   * right away, so that the next frame shows the current state of the map.
+   * Rebuilding the remaining ones is spread out over multiple calls, with
+   * at most MAX_OFFSCREEN_BLOCK_REBUILDS_PER_UPDATE per call. This avoids
+   * frame time spikes when large parts of the map change at once.
+   */
+  void rebuildChangedBlocks(
+    const data::map::Map& map,
+    const base::Rect<int>& visibleSection);
   void rebuildAllBlocks(const data::map::Map& map);
 
+  /** Select how map tiles are drawn
+   *
+   * By default, each block of tiles is drawn from a static vertex buffer.
+   * With single-pass rendering enabled, the map's tile indices are instead
+   * kept in a texture, and the entire visible section is drawn using a single
+   * quad per draw mode, with the tile map shader looking up the tiles to
+   * display. This makes the cost of drawing the map independent of the
+   * number of tiles on screen. The tile map textures are only created and
+   * kept up to date while single-pass rendering is enabled. They are
+   * created from the given map when enabling it, so this can be switched at
+   * any time.
+   */
+  void setSinglePassRenderingEnabled(bool enabled, const data::map::Map& map);
+
   void renderBackdrop(
     const base::Vec2f& cameraPosition,
     const base::Size& viewportSize) const;
@@ -147,7 +193,16 @@ private:
     const base::Vec2& sectionStart,
     const base::Size& sectionSize,
     DrawMode drawMode) const;
+  void renderMapTilesSinglePass(
+    const base::Vec2& sectionStart,
+    const base::Size& sectionSize,
+    DrawMode drawMode) const;
+  void updateTileMapTextures(
+    const data::map::Map& map,
+    const base::Rect<int>& section);
   data::map::TileIndex animatedTileIndex(data::map::TileIndex) const;
+  glm::vec2 animationFrames() const;
+  glm::vec2 animationOffsets() const;
 
 private:
   renderer::Renderer* mpRenderer;
@@ -156,9 +211,19 @@ private:
   TiledTexture mTileSetTexture;
   renderer::Texture mBackdropTexture;
   renderer::Texture mAlternativeBackdropTexture;
+  renderer::Shader mTileShader;
 
   TileRenderData mRenderData;
-  std::bitset<MAX_NUM_BLOCKS> mOutOfDateBlocks;
+  std::vector<bool> mBlockIsOutOfDate;
+  std::vector<int> mOutOfDateBlocks;
+
+  // Tile indices for single-pass rendering, one texture per draw mode
+  renderer::Shader mTileMapShader;
+  std::array<renderer::DataTexture, 2> mTileMapTextures;
+  std::vector<int> mOutOfDateTileMapBlocks;
+  std::vector<bool> mTileMapBlockIsOutOfDate;
+  base::Size mMapSize;
+  bool mSinglePassRenderingEnabled = false;
 
   data::map::BackdropScrollMode mScrollMode;
 
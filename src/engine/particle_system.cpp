@@ -16,6 +16,7 @@
 
 #include "particle_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/unit_conversions.hpp"
 #include "engine/motion_smoothing.hpp"
 #include "engine/random_number_generator.hpp"
@@ -200,6 +201,8 @@ void ParticleSystem::spawnParticles(
 
 void ParticleSystem::update()
 {
+  RIGEL_PROFILE_SCOPE("ParticleSystem::update");
+
   using namespace std;
 
   const auto it = remove_if(
@@ -16,6 +16,7 @@
 
 #include "physics_system.hpp"
 
+#include "base/profiler.hpp"
 #include "engine/entity_tools.hpp"
 #include "engine/physics.hpp"
 
@@ -46,6 +47,9 @@ PhysicsSystem::PhysicsSystem(
 
 void PhysicsSystem::update(ex::EntityManager& es)
 {
+  // Pick up any changes made to static solid bodies since the last update
+  mpCollisionChecker->synchronizeSolidBodies();
+
   es.each<MovingBody, WorldPosition, BoundingBox, components::Active>(
     [this](
       ex::Entity entity,
@@ -60,6 +64,8 @@ void PhysicsSystem::update(ex::EntityManager& es)
 
 void PhysicsSystem::updatePhase1(ex::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("PhysicsSystem::updatePhase1");
+
   update(es);
   mShouldCollectForPhase2 = true;
 }
@@ -67,6 +73,8 @@ void PhysicsSystem::updatePhase1(ex::EntityManager& es)
 
 void PhysicsSystem::updatePhase2(ex::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("PhysicsSystem::updatePhase2");
+
   for (auto entity : mPhysicsObjectsForPhase2)
   {
     assert(entity.has_component<MovingBody>());
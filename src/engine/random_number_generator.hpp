@@ -31,6 +31,14 @@ class RandomNumberGenerator
 public:
   int gen();
 
+  /** Index of the last number taken from the table
+   *
+   * Together with the level and player input, this determines all future
+   * random numbers. Used for recording and replaying gameplay.
+   */
+  std::uint8_t state() const { return mNextNumberIndex; }
+  void setState(const std::uint8_t state) { mNextNumberIndex = state; }
+
 private:
   std::uint8_t mNextNumberIndex = 0;
 };
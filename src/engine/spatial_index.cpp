@@ -0,0 +1,181 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+
+namespace rigel::engine
+{
+
+namespace
+{
+
+constexpr auto MIN_CELL_SIZE = 8;
+
+// Limits memory usage in case entities are spread out very far (e.g. due to
+// some of them being positioned way outside of the map).
+constexpr auto MAX_CELLS_PER_AXIS = 256;
+
+} // namespace
+
+
+void SpatialIndex::clear()
+{
+  mEntries.clear();
+  mColumns = 0;
+  mRows = 0;
+}
+
+
+void SpatialIndex::insert(
+  entityx::Entity entity,
+  const components::BoundingBox& bbox)
+{
+  mEntries.push_back(Entry{entity, bbox});
+}
+
+
+void SpatialIndex::build()
+{
+  if (mEntries.empty())
+  {
+    return;
+  }
+
+  auto minX = mEntries.front().mBbox.left();
+  auto minY = mEntries.front().mBbox.top();
+  auto maxX = minX;
+  auto maxY = minY;
+  for (const auto& entry : mEntries)
+  {
+    const auto& bbox = entry.mBbox;
+    minX = std::min(minX, bbox.left());
+    minY = std::min(minY, bbox.top());
+    maxX = std::max({maxX, bbox.left(), bbox.right()});
+    maxY = std::max({maxY, bbox.top(), bbox.bottom()});
+  }
+
+  const auto extent = std::max(maxX - minX + 1, maxY - minY + 1);
+
+  mOrigin = {minX, minY};
+  mCellSize = std::max(
+    MIN_CELL_SIZE, (extent + MAX_CELLS_PER_AXIS - 1) / MAX_CELLS_PER_AXIS);
+  mColumns = (maxX - minX) / mCellSize + 1;
+  mRows = (maxY - minY) / mCellSize + 1;
+
+  // Counting sort of all entries into the cells they overlap. Entries are
+  // visited in insertion order, so each cell's list ends up sorted.
+  mCellStarts.assign(static_cast<std::size_t>(mColumns * mRows) + 1, 0);
+
+  const auto forEachCell = [this](const Entry& entry, auto&& func) {
+    const auto range = cellRangeFor(entry.mBbox);
+    for (auto row = range.mFirstRow; row <= range.mLastRow; ++row)
+    {
+      for (auto col = range.mFirstCol; col <= range.mLastCol; ++col)
+      {
+        func(static_cast<std::size_t>(col + row * mColumns));
+      }
+    }
+  };
+
+  for (const auto& entry : mEntries)
+  {
+    forEachCell(entry, [this](const std::size_t cell) {
+      ++mCellStarts[cell + 1];
+    });
+  }
+
+  std::partial_sum(mCellStarts.begin(), mCellStarts.end(), mCellStarts.begin());
+
+  mCellContents.resize(mCellStarts.back());
+  mWriteCursors.assign(mCellStarts.begin(), std::prev(mCellStarts.end()));
+
+  for (auto i = std::size_t{0}; i < mEntries.size(); ++i)
+  {
+    forEachCell(mEntries[i], [this, i](const std::size_t cell) {
+      mCellContents[mWriteCursors[cell]++] = i;
+    });
+  }
+}
+
+
+const std::vector<entityx::Entity>&
+  SpatialIndex::entitiesIntersecting(const components::BoundingBox& area) const
+{
+  mQueryResult.clear();
+
+  if (mColumns == 0 || mRows == 0)
+  {
+    return mQueryResult;
+  }
+
+  mCandidates.clear();
+
+  const auto range = cellRangeFor(area);
+  for (auto row = range.mFirstRow; row <= range.mLastRow; ++row)
+  {
+    for (auto col = range.mFirstCol; col <= range.mLastCol; ++col)
+    {
+      const auto cell = static_cast<std::size_t>(col + row * mColumns);
+      mCandidates.insert(
+        mCandidates.end(),
+        mCellContents.begin() + mCellStarts[cell],
+        mCellContents.begin() + mCellStarts[cell + 1]);
+    }
+  }
+
+  // Entries spanning multiple cells show up more than once
+  std::sort(mCandidates.begin(), mCandidates.end());
+  mCandidates.erase(
+    std::unique(mCandidates.begin(), mCandidates.end()), mCandidates.end());
+
+  for (const auto index : mCandidates)
+  {
+    const auto& entry = mEntries[index];
+    if (entry.mBbox.intersects(area))
+    {
+      mQueryResult.push_back(entry.mEntity);
+    }
+  }
+
+  return mQueryResult;
+}
+
+
+SpatialIndex::CellRange
+  SpatialIndex::cellRangeFor(const components::BoundingBox& bbox) const
+{
+  const auto toCell = [this](const int coordinate, const int origin,
+                             const int numCells) {
+    // Coordinates outside of the indexed area are clamped to the border
+    // cells. That's fine since candidates are checked for intersection
+    // anyway.
+    const auto offset = std::max(coordinate - origin, 0);
+    return std::min(offset / mCellSize, numCells - 1);
+  };
+
+  return CellRange{
+    toCell(bbox.left(), mOrigin.x, mColumns),
+    toCell(std::max(bbox.left(), bbox.right()), mOrigin.x, mColumns),
+    toCell(bbox.top(), mOrigin.y, mRows),
+    toCell(std::max(bbox.top(), bbox.bottom()), mOrigin.y, mRows)};
+}
+
+} // namespace rigel::engine
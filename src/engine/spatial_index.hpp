@@ -0,0 +1,96 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+/** Broad-phase index for finding entities with overlapping bounding boxes
+ *
+ * Entities are sorted into a uniform grid covering the area spanned by all
+ * inserted bounding boxes. Queries then only need to look at the entities
+ * in the grid cells touched by the query area, instead of all of them.
+ *
+ * The index doesn't track entity movement. It's meant to be rebuilt from
+ * scratch whenever the indexed entities might have moved: Call clear(), then
+ * insert() all entities, then build(). After that, queries can be made until
+ * the next call to clear().
+ *
+ * Query results are returned in insertion order, so that code iterating over
+ * them behaves exactly the same as code iterating over all inserted entities
+ * and checking each one for intersection.
+ */
+class SpatialIndex
+{
+public:
+  void clear();
+  void insert(entityx::Entity entity, const components::BoundingBox& bbox);
+  void build();
+
+  /** Returns all inserted entities whose bounding box intersects the area
+   *
+   * The returned list stays valid until the next call to any member
+   * function. Entities might have been destroyed since inserting them, so
+   * callers need to check for validity.
+   */
+  const std::vector<entityx::Entity>&
+    entitiesIntersecting(const components::BoundingBox& area) const;
+
+  bool empty() const { return mEntries.empty(); }
+
+private:
+  struct Entry
+  {
+    entityx::Entity mEntity;
+    components::BoundingBox mBbox;
+  };
+
+  struct CellRange
+  {
+    int mFirstCol;
+    int mLastCol;
+    int mFirstRow;
+    int mLastRow;
+  };
+
+  CellRange cellRangeFor(const components::BoundingBox& bbox) const;
+
+  std::vector<Entry> mEntries;
+  std::vector<std::size_t> mCellStarts;
+  std::vector<std::size_t> mCellContents;
+  std::vector<std::size_t> mWriteCursors;
+  base::Vec2 mOrigin;
+  int mCellSize = 1;
+  int mColumns = 0;
+  int mRows = 0;
+
+  mutable std::vector<std::size_t> mCandidates;
+  mutable std::vector<entityx::Entity> mQueryResult;
+};
+
+} // namespace rigel::engine
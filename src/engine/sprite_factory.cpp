@@ -943,7 +943,9 @@ auto SpriteFactory::construct(
 
   return {
     std::move(spriteDataMap),
-    renderer::TextureAtlas{pRenderer, spriteImages},
+    pRenderer ? std::make_optional<renderer::TextureAtlas>(
+                  pRenderer, spriteImages)
+              : std::nullopt,
     highResReplacementsFound};
 }
 
@@ -20,6 +20,7 @@
 #include "engine/isprite_factory.hpp"
 #include "renderer/texture_atlas.hpp"
 
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -50,6 +51,12 @@ constexpr auto EFFECT_DRAW_ORDER = MUZZLE_FLASH_DRAW_ORDER + 1;
 bool hasAssociatedSprite(data::ActorID actorID);
 std::vector<int> buildImageIdTable(const assets::ResourceLoader& resources);
 
+/** Creates sprites for in-game actors
+ *
+ * The renderer may be null, in which case only the logical sprite data
+ * (frame dimensions, draw order etc.) is made available, but no texture
+ * atlas is created. This is used for running the game logic headless.
+ */
 class SpriteFactory : public ISpriteFactory
 {
 public:
@@ -63,9 +70,10 @@ public:
 
   bool hasHighResReplacements() const { return mHasHighResReplacements; }
 
+  /** Must only be called if a renderer was given on construction */
   const renderer::TextureAtlas& textureAtlas() const
   {
-    return mSpritesTextureAtlas;
+    return *mSpritesTextureAtlas;
   }
 
 private:
@@ -77,7 +85,7 @@ private:
 
   using CtorArgs = std::tuple<
     std::unordered_map<data::ActorID, SpriteData>,
-    renderer::TextureAtlas,
+    std::optional<renderer::TextureAtlas>,
     bool>;
 
   SpriteFactory(CtorArgs args);
@@ -86,7 +94,7 @@ private:
     const assets::ResourceLoader* pResourceLoader);
 
   std::unordered_map<data::ActorID, SpriteData> mSpriteDataMap;
-  renderer::TextureAtlas mSpritesTextureAtlas;
+  std::optional<renderer::TextureAtlas> mSpritesTextureAtlas;
   bool mHasHighResReplacements;
 };
 
@@ -16,6 +16,7 @@
 
 #include "sprite_rendering_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/unit_conversions.hpp"
 #include "engine/graphical_effects.hpp"
 #include "engine/motion_smoothing.hpp"
@@ -257,6 +258,8 @@ int virtualToRealFrame(
 
 void updateAnimatedSprites(ex::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("engine::updateAnimatedSprites");
+
   es.each<Sprite, AnimationLoop>(
     [](ex::Entity entity, Sprite& sprite, AnimationLoop& animated) {
       ++animated.mFramesElapsed;
@@ -322,6 +325,8 @@ void SpriteRenderingSystem::update(
   const base::Vec2& cameraPosition,
   const float interpolationFactor)
 {
+  RIGEL_PROFILE_SCOPE("SpriteRenderingSystem::update");
+
   using std::back_inserter;
   using std::begin;
   using std::end;
@@ -357,6 +362,8 @@ void SpriteRenderingSystem::update(
 void SpriteRenderingSystem::renderRegularSprites(
   const SpecialEffectsRenderer& fx) const
 {
+  RIGEL_PROFILE_SCOPE("SpriteRenderingSystem::renderRegularSprites");
+
   for (auto it = mSprites.begin(); it != miForegroundSprites; ++it)
   {
     renderSprite(*it, fx);
@@ -367,6 +374,8 @@ void SpriteRenderingSystem::renderRegularSprites(
 void SpriteRenderingSystem::renderForegroundSprites(
   const SpecialEffectsRenderer& fx) const
 {
+  RIGEL_PROFILE_SCOPE("SpriteRenderingSystem::renderForegroundSprites");
+
   for (auto it = miForegroundSprites; it != mSprites.end(); ++it)
   {
     renderSprite(*it, fx);
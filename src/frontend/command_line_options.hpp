@@ -46,6 +46,11 @@ struct CommandLineOptions
   bool mDisableAudio = false;
   bool mPlayDemo = false;
   std::optional<base::Vec2> mPlayerPosition;
+  bool mHeadless = false;
+  int mHeadlessFrameCount = 1000;
+  std::string mRecordingPath;
+  std::string mReplayPath;
+  std::string mFrameCapturePath;
 };
 
 } // namespace rigel
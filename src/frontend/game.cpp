@@ -20,6 +20,7 @@
 #include "assets/png_image.hpp"
 #include "base/defer.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "data/duke_script.hpp"
 #include "data/game_traits.hpp"
 #include "engine/timing.hpp"
@@ -200,6 +201,46 @@ std::filesystem::path effectiveGamePath(
 }
 
 
+std::filesystem::path traceExportPath()
+{
+  constexpr auto TRACE_FILENAME = "rigel_trace.json";
+
+  if (const auto maybePrefsDir = createOrGetPreferencesPath(); maybePrefsDir)
+  {
+    return *maybePrefsDir / TRACE_FILENAME;
+  }
+
+  return TRACE_FILENAME;
+}
+
+
+std::filesystem::path frameCaptureExportPath()
+{
+  constexpr auto CAPTURE_FILENAME = "rigel_frame_capture.rfc";
+
+  if (const auto maybePrefsDir = createOrGetPreferencesPath(); maybePrefsDir)
+  {
+    return *maybePrefsDir / CAPTURE_FILENAME;
+  }
+
+  return CAPTURE_FILENAME;
+}
+
+
+bool isSharewareVersionData(const assets::ResourceLoader& resources)
+{
+  // The registered version has 24 additional level files, and a
+  // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
+  // all of these files, as that would be fairly tedious. Instead, we just
+  // check for the presence of one of the registered version's levels, and
+  // the anti-piracy screen, and assume that we're dealing with a
+  // registered version data set if these two are present.
+  const auto hasRegisteredVersionFiles =
+    resources.hasFile("LCR.MNI") && resources.hasFile("O1.MNI");
+  return !hasRegisteredVersionFiles;
+}
+
+
 Game::Game(
   const CommandLineOptions& commandLineOptions,
   UserProfile* pUserProfile,
@@ -232,17 +273,7 @@ Game::Game(
 
     return pResult;
   }())
-  , mIsShareWareVersion([this]() {
-    // The registered version has 24 additional level files, and a
-    // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
-    // all of these files, as that would be fairly tedious. Instead, we just
-    // check for the presence of one of the registered version's levels, and
-    // the anti-piracy screen, and assume that we're dealing with a
-    // registered version data set if these two are present.
-    const auto hasRegisteredVersionFiles =
-      mResources.hasFile("LCR.MNI") && mResources.hasFile("O1.MNI");
-    return !hasRegisteredVersionFiles;
-  }())
+  , mIsShareWareVersion(isSharewareVersionData(mResources))
   , mFpsLimiter(createLimiter(pUserProfile->mOptions))
   , mUpscalingBuffer(&mRenderer, pUserProfile->mOptions)
   , mIsRunning(true)
@@ -264,6 +295,7 @@ Game::Game(
       &mRenderer)
   , mSpriteFactory(&mRenderer, &mResources)
   , mTextRenderer(&mUiSpriteSheet, &mRenderer, mResources)
+  , mProfilerDisplay(traceExportPath())
 {
   LOG_F(INFO, "Successfully loaded all resources");
   LOG_F(
@@ -293,6 +325,8 @@ auto Game::runOneFrame() -> std::optional<StopReason>
   using namespace std::chrono;
   using base::defer;
 
+  base::profiler::beginFrame();
+
   const auto startOfFrame = base::Clock::now();
   const auto elapsed =
     duration<entityx::TimeDelta>(startOfFrame - mLastTime).count();
@@ -310,7 +344,12 @@ auto Game::runOneFrame() -> std::optional<StopReason>
     auto imGuiFrameGuard = defer([]() { ui::imgui_integration::endFrame(); });
     ImGui::SetMouseCursor(ImGuiMouseCursor_None);
 
-    updateAndRender(elapsed);
+    {
+      RIGEL_PROFILE_SCOPE("Game::updateAndRender");
+      updateAndRender(elapsed);
+    }
+
+    mProfilerDisplay.updateAndRender();
     mEventQueue.clear();
   }
 
@@ -320,7 +359,15 @@ auto Game::runOneFrame() -> std::optional<StopReason>
     mScreenshotRequested = false;
   }
 
-  swapBuffers();
+  {
+    RIGEL_PROFILE_SCOPE("Game::swapBuffers");
+    swapBuffers();
+  }
+
+  if (const auto maybeCapture = mRenderer.takeFrameCapture())
+  {
+    saveFrameCapture(*maybeCapture);
+  }
 
   const auto changedOptionsRequireRestart = applyChangedOptions();
 
@@ -430,6 +477,14 @@ bool Game::handleEvent(const SDL_Event& event)
       {
         options.mShowFpsCounter = !options.mShowFpsCounter;
       }
+      else if (event.key.keysym.sym == SDLK_F8)
+      {
+        mProfilerDisplay.toggleVisibility();
+      }
+      else if (event.key.keysym.sym == SDLK_F9)
+      {
+        mRenderer.requestFrameCapture();
+      }
       else if (event.key.keysym.sym == SDLK_F12)
       {
         mScreenshotRequested = true;
@@ -599,6 +654,21 @@ bool Game::applyChangedOptions()
     SDL_GL_SetSwapInterval(mpUserProfile->mOptions.mEnableVsync ? 1 : 0);
   }
 
+  if (
+    currentOptions.mDeferredDrawBatching !=
+    mPreviousOptions.mDeferredDrawBatching)
+  {
+    mRenderer.setDeferredBatchingEnabled(currentOptions.mDeferredDrawBatching);
+  }
+
+  if (
+    currentOptions.mMultiTextureBatching !=
+    mPreviousOptions.mMultiTextureBatching)
+  {
+    mRenderer.setMultiTextureBatchingEnabled(
+      currentOptions.mMultiTextureBatching);
+  }
+
   if (
     currentOptions.mEnableVsync != mPreviousOptions.mEnableVsync ||
     currentOptions.mEnableFpsLimit != mPreviousOptions.mEnableFpsLimit ||
@@ -749,6 +819,22 @@ void Game::takeScreenshot()
 }
 
 
+void Game::saveFrameCapture(const renderer::FrameCapture& capture)
+{
+  const auto path = frameCaptureExportPath();
+
+  try
+  {
+    renderer::writeFrameCapture(path, capture);
+    LOG_F(INFO, "Frame capture saved to %s", path.u8string().c_str());
+  }
+  catch (const std::exception& ex)
+  {
+    LOG_F(ERROR, "Failed to save frame capture: %s", ex.what());
+  }
+}
+
+
 void Game::setPerElementUpscalingEnabled(bool enabled)
 {
   if (enabled != mpUserProfile->mOptions.mPerElementUpscalingEnabled)
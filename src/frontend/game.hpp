@@ -35,6 +35,7 @@
 #include "ui/duke_script_runner.hpp"
 #include "ui/fps_display.hpp"
 #include "ui/menu_element_renderer.hpp"
+#include "ui/profiler_display.hpp"
 
 #include <SDL_gamecontroller.h>
 
@@ -58,6 +59,10 @@ std::filesystem::path effectiveGamePath(
   const UserProfile& profile);
 
 
+/** Returns true if the given resources are from the shareware version */
+bool isSharewareVersionData(const assets::ResourceLoader& resources);
+
+
 class Game : public IGameServiceProvider
 {
 public:
@@ -109,6 +114,7 @@ private:
   bool applyChangedOptions();
   void enumerateGameControllers();
   void takeScreenshot();
+  void saveFrameCapture(const renderer::FrameCapture& capture);
   void setPerElementUpscalingEnabled(bool enabled);
 
   // IGameServiceProvider implementation
@@ -172,6 +178,7 @@ private:
   engine::SpriteFactory mSpriteFactory;
   ui::MenuElementRenderer mTextRenderer;
   ui::FpsDisplay mFpsDisplay;
+  ui::ProfilerDisplay mProfilerDisplay;
   std::vector<SDL_Event> mEventQueue;
 
   GameControllerInfo mGameControllerInfo;
@@ -18,11 +18,13 @@
 
 #include "base/math_utils.hpp"
 #include "frontend/game_service_provider.hpp"
+#include "frontend/replay.hpp"
 #include "frontend/user_profile.hpp"
 #include "game_logic/game_world.hpp"
 #include "game_logic_classic/game_world_classic.hpp"
 #include "ui/utils.hpp"
 
+#include <filesystem>
 #include <sstream>
 
 
@@ -32,23 +34,52 @@ namespace rigel
 namespace
 {
 
-template <typename... Args>
-std::unique_ptr<game_logic::IGameWorld>
-  createGameWorld(const data::GameplayStyle gameplayStyle, Args&&... args)
+std::filesystem::path recordingFilePath(
+  const std::string& basePath,
+  const data::GameSessionId& sessionId)
+{
+  const auto path = std::filesystem::u8path(basePath);
+
+  auto fileName = path.stem().u8string();
+  fileName += '_';
+  fileName += static_cast<char>('L' + sessionId.mEpisode);
+  fileName += std::to_string(sessionId.mLevel + 1);
+  fileName += path.extension().u8string();
+
+  return path.parent_path() / std::filesystem::u8path(fileName);
+}
+
+} // namespace
+
+
+std::unique_ptr<game_logic::IGameWorld> createGameWorld(
+  const data::GameplayStyle gameplayStyle,
+  data::PersistentPlayerState* pPersistentPlayerState,
+  const data::GameSessionId& sessionId,
+  GameMode::Context context,
+  const std::optional<base::Vec2> playerPositionOverride,
+  const bool showWelcomeMessage)
 {
   if (gameplayStyle == data::GameplayStyle::Classic)
   {
     return std::make_unique<game_logic::GameWorld_Classic>(
-      std::forward<Args>(args)...);
+      pPersistentPlayerState,
+      sessionId,
+      context,
+      playerPositionOverride,
+      showWelcomeMessage);
   }
   else
   {
-    return std::make_unique<game_logic::GameWorld>(std::forward<Args>(args)...);
+    return std::make_unique<game_logic::GameWorld>(
+      pPersistentPlayerState,
+      sessionId,
+      context,
+      playerPositionOverride,
+      showWelcomeMessage);
   }
 }
 
-} // namespace
-
 
 GameRunner::GameRunner(
   data::PersistentPlayerState* pPersistentPlayerState,
@@ -57,13 +88,34 @@ GameRunner::GameRunner(
   const std::optional<base::Vec2> playerPositionOverride,
   const bool showWelcomeMessage)
   : mContext(context)
-  , mpWorld(createGameWorld(
-      context.mpUserProfile->mOptions.mGameplayStyle,
+  , mpWorld([&]() -> std::unique_ptr<game_logic::IGameWorld> {
+    const auto& options = context.mpUserProfile->mOptions;
+    const auto& recordingPath =
+      context.mpServiceProvider->commandLineOptions().mRecordingPath;
+
+    // The header needs to capture the player's state before the world
+    // gets a chance to modify it.
+    auto replayHeader = makeReplayHeader(
+      sessionId, options, *pPersistentPlayerState, playerPositionOverride);
+
+    auto pWorld = createGameWorld(
+      options.mGameplayStyle,
       pPersistentPlayerState,
       sessionId,
       context,
       playerPositionOverride,
-      showWelcomeMessage))
+      showWelcomeMessage);
+
+    if (recordingPath.empty())
+    {
+      return pWorld;
+    }
+
+    return std::make_unique<RecordingGameWorld>(
+      std::move(pWorld),
+      recordingFilePath(recordingPath, sessionId),
+      replayHeader);
+  }())
   , mInputHandler(&context.mpUserProfile->mOptions)
   , mMenu(context, pPersistentPlayerState, mpWorld.get(), sessionId)
 {
@@ -151,7 +203,22 @@ float GameRunner::interpolationFactor(const engine::TimeDelta dt) const
 void GameRunner::updateWorld(const engine::TimeDelta dt)
 {
   auto update = [this]() {
-    mpWorld->updateGameLogic(mInputHandler.fetchInput());
+    // Input is consumed while rewinding as well, so that key presses don't
+    // take effect late once rewinding stops
+    const auto input = mInputHandler.fetchInput();
+
+    if (mRewinding)
+    {
+      mpWorld->rewind();
+      return;
+    }
+
+    if (mContext.mpServiceProvider->commandLineOptions().mDebugModeEnabled)
+    {
+      mpWorld->recordRewindState();
+    }
+
+    mpWorld->updateGameLogic(input);
   };
 
 
@@ -191,6 +258,7 @@ bool GameRunner::updateMenu(const engine::TimeDelta dt)
   if (mMenu.isActive())
   {
     mInputHandler.reset();
+    mRewinding = false;
 
     if (mMenu.isTransparent())
     {
@@ -215,6 +283,15 @@ bool GameRunner::updateMenu(const engine::TimeDelta dt)
 
 void GameRunner::handleDebugKeys(const SDL_Event& event)
 {
+  // Rewinding goes on for as long as the key is held down
+  if (
+    (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) &&
+    event.key.keysym.sym == SDLK_r)
+  {
+    mRewinding = event.type == SDL_KEYDOWN;
+    return;
+  }
+
   if (event.type != SDL_KEYDOWN || event.key.repeat != 0)
   {
     return;
@@ -269,6 +346,11 @@ void GameRunner::renderDebugText()
     debugText << "GOD MODE on\n";
   }
 
+  if (mRewinding)
+  {
+    debugText << "REWINDING\n";
+  }
+
   if (mShowDebugText)
   {
     mpWorld->printDebugText(debugText);
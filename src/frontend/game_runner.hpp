@@ -36,6 +36,16 @@ RIGEL_RESTORE_WARNINGS
 namespace rigel
 {
 
+/** Create a game world implementing the given gameplay style */
+std::unique_ptr<game_logic::IGameWorld> createGameWorld(
+  data::GameplayStyle gameplayStyle,
+  data::PersistentPlayerState* pPersistentPlayerState,
+  const data::GameSessionId& sessionId,
+  GameMode::Context context,
+  std::optional<base::Vec2> playerPositionOverride = std::nullopt,
+  bool showWelcomeMessage = false);
+
+
 class GameRunner
 {
 public:
@@ -72,6 +82,7 @@ private:
   bool mShowDebugText = false;
   bool mSingleStepping = false;
   bool mDoNextSingleStep = false;
+  bool mRewinding = false;
   bool mLevelFinishedByDebugKey = false;
 };
 
@@ -0,0 +1,251 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headless_simulation.hpp"
+
+#include "assets/resource_loader.hpp"
+#include "base/clock.hpp"
+#include "base/warnings.hpp"
+#include "data/player_model.hpp"
+#include "engine/sprite_factory.hpp"
+#include "frontend/game.hpp"
+#include "frontend/game_mode.hpp"
+#include "frontend/game_runner.hpp"
+#include "frontend/game_service_provider.hpp"
+#include "frontend/replay.hpp"
+#include "frontend/user_profile.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <loguru.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+
+namespace rigel
+{
+
+namespace
+{
+
+class HeadlessServiceProvider : public IGameServiceProvider
+{
+public:
+  HeadlessServiceProvider(
+    const CommandLineOptions& commandLineOptions,
+    const bool isSharewareVersion)
+    : mCommandLineOptions(commandLineOptions)
+    , mIsSharewareVersion(isSharewareVersion)
+  {
+  }
+
+  void fadeOutScreen() override { }
+  void fadeInScreen() override { }
+
+  void playSound(data::SoundId) override { }
+  void stopSound(data::SoundId) override { }
+  void stopAllSounds() override { }
+  void playMusic(const std::string&) override { }
+  void stopMusic() override { }
+  void scheduleGameQuit() override { }
+  void switchGamePath(const std::filesystem::path&) override { }
+  void markCurrentFrameAsWidescreen() override { }
+
+  bool isSharewareVersion() const override { return mIsSharewareVersion; }
+
+  const CommandLineOptions& commandLineOptions() const override
+  {
+    return mCommandLineOptions;
+  }
+
+  const GameControllerInfo& gameControllerInfo() const override
+  {
+    return mGameControllerInfo;
+  }
+
+private:
+  const CommandLineOptions& mCommandLineOptions;
+  GameControllerInfo mGameControllerInfo;
+  bool mIsSharewareVersion;
+};
+
+
+
+void reportTicksPerSecond(
+  const int tickCount,
+  const base::Clock::time_point startTime)
+{
+  using namespace std::chrono;
+
+  const auto elapsedSeconds =
+    duration<double>(base::Clock::now() - startTime).count();
+  const auto ticksPerSecond =
+    elapsedSeconds > 0.0 ? tickCount / elapsedSeconds : 0.0;
+
+  std::cout << "Simulated " << tickCount << " frames in " << elapsedSeconds
+            << " s (" << ticksPerSecond << " ticks per second)\n";
+}
+
+
+int runSimulation(
+  const CommandLineOptions& options,
+  const GameMode::Context& context)
+{
+  const auto sessionId =
+    options.mLevelToJumpTo.value_or(data::GameSessionId{0, 0});
+  auto playerState = data::PersistentPlayerState{};
+  auto pWorld = createGameWorld(
+    context.mpUserProfile->mOptions.mGameplayStyle,
+    &playerState,
+    sessionId,
+    context,
+    options.mPlayerPosition);
+
+  LOG_F(
+    INFO,
+    "Running headless simulation for %d frames",
+    options.mHeadlessFrameCount);
+
+  const auto startTime = base::Clock::now();
+
+  for (auto i = 0; i < options.mHeadlessFrameCount; ++i)
+  {
+    pWorld->updateGameLogic({});
+    pWorld->processEndOfFrameActions();
+  }
+
+  reportTicksPerSecond(options.mHeadlessFrameCount, startTime);
+  return 0;
+}
+
+
+int runReplay(const CommandLineOptions& options, GameMode::Context context)
+{
+  const auto replay = loadReplay(std::filesystem::u8path(options.mReplayPath));
+  const auto& header = replay.mHeader;
+
+  // Make sure we use the same options as during recording, without
+  // touching the user profile passed in by the caller.
+  auto userProfile = *context.mpUserProfile;
+  applyReplayOptions(header, userProfile.mOptions);
+  context.mpUserProfile = &userProfile;
+
+  if (header.mWidescreenModeOn)
+  {
+    LOG_F(
+      WARNING,
+      "Replay was recorded in widescreen mode, which is not available when "
+      "running headless. Playback might diverge from the recording.");
+  }
+
+  auto playerState = initialPlayerState(header);
+  auto pWorld = createGameWorld(
+    header.mGameplayStyle,
+    &playerState,
+    header.mSessionId,
+    context,
+    header.mPlayerPositionOverride);
+  pWorld->setRandomNumberGeneratorState(header.mRandomNumberGeneratorState);
+
+  const auto expectedHashes =
+    loadStateHashes(std::filesystem::u8path(options.mReplayPath));
+
+  LOG_F(
+    INFO,
+    "Playing back replay with %d events, verifying %d state hashes",
+    static_cast<int>(replay.mEvents.size()),
+    static_cast<int>(expectedHashes.size()));
+
+  const auto startTime = base::Clock::now();
+
+  auto tickCount = 0;
+  for (const auto& event : replay.mEvents)
+  {
+    applyReplayEvent(event, *pWorld);
+
+    if (event.mType != ReplayEventType::Update)
+    {
+      continue;
+    }
+
+    if (
+      tickCount < static_cast<int>(expectedHashes.size()) &&
+      pWorld->stateHash() != expectedHashes[tickCount])
+    {
+      std::cout << "Replay diverged from recording at update " << tickCount
+                << '\n';
+      return 1;
+    }
+
+    ++tickCount;
+  }
+
+  reportTicksPerSecond(tickCount, startTime);
+
+  if (pWorld->levelFinished())
+  {
+    std::cout << "Level was finished\n";
+  }
+
+  return 0;
+}
+
+} // namespace
+
+
+int runHeadlessSimulation(const CommandLineOptions& options)
+{
+  // We don't want to create a new profile on disk when running headless, so
+  // we only make use of an existing one (for game path and options).
+  auto userProfile = loadUserProfile().value_or(UserProfile{});
+
+  const auto gamePath = effectiveGamePath(options, userProfile);
+  if (gamePath.empty())
+  {
+    std::cerr << "ERROR: No game path given\n";
+    return -1;
+  }
+
+  const auto resources = assets::ResourceLoader{
+    gamePath,
+    userProfile.mOptions.mEnableTopLevelMods,
+    userProfile.mModLibrary.enabledModPaths()};
+  auto serviceProvider =
+    HeadlessServiceProvider{options, isSharewareVersionData(resources)};
+  auto spriteFactory = engine::SpriteFactory{nullptr, &resources};
+
+  const auto context = GameMode::Context{
+    &resources,
+    nullptr,
+    &serviceProvider,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    &spriteFactory,
+    &userProfile};
+
+  if (!options.mReplayPath.empty())
+  {
+    return runReplay(options, context);
+  }
+
+  return runSimulation(options, context);
+}
+
+} // namespace rigel
@@ -0,0 +1,46 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "frontend/command_line_options.hpp"
+
+
+namespace rigel
+{
+
+/** Run game logic without a window, renderer or audio
+ *
+ * Loads the level specified in the given options (or the first level of the
+ * first episode if none is given), and then runs the game logic as fast as
+ * possible for the number of frames given in the options, without any
+ * rendering. Player input is kept neutral throughout.
+ *
+ * If a replay file is given in the options (--replay), the recorded level,
+ * options and input are used instead, and the whole replay is played back.
+ * If the replay comes with state hashes, these are checked after each update,
+ * and playback stops with a non-zero return value at the first mismatch.
+ * See replay.hpp.
+ *
+ * Once done, prints the number of simulated frames and the achieved rate of
+ * game logic updates (ticks) per second to stdout.
+ *
+ * Meant for profiling and automated testing of the game logic. The
+ * return value is suitable to be used as the process' exit code.
+ */
+int runHeadlessSimulation(const CommandLineOptions& options);
+
+} // namespace rigel
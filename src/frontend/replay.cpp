@@ -0,0 +1,616 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay.hpp"
+
+#include "assets/file_utils.hpp"
+#include "data/saved_game.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+
+namespace rigel
+{
+
+namespace
+{
+
+constexpr char REPLAY_MAGIC[] = {'R', 'G', 'L', 'R'};
+constexpr std::uint8_t REPLAY_FORMAT_VERSION = 1;
+
+constexpr std::uint8_t OPTION_WIDESCREEN = 0b1;
+constexpr std::uint8_t OPTION_MOTION_SMOOTHING = 0b10;
+constexpr std::uint8_t OPTION_SCREEN_FLASHES = 0b100;
+constexpr std::uint8_t OPTION_QUICK_SAVING = 0b1000;
+
+constexpr std::uint16_t END_OF_FRAME_BIT = 1 << 15;
+
+static_assert(
+  data::NUM_TUTORIAL_MESSAGES <= 32,
+  "Tutorial message mask doesn't fit into 32 bits anymore");
+
+
+void writeU8(std::ostream& stream, const std::uint8_t value)
+{
+  stream.put(static_cast<char>(value));
+}
+
+
+void writeU16(std::ostream& stream, const std::uint16_t value)
+{
+  writeU8(stream, static_cast<std::uint8_t>(value & 0xFF));
+  writeU8(stream, static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void writeU32(std::ostream& stream, const std::uint32_t value)
+{
+  writeU16(stream, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU16(stream, static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void writeU64(std::ostream& stream, const std::uint64_t value)
+{
+  writeU32(stream, static_cast<std::uint32_t>(value & 0xFFFFFFFF));
+  writeU32(stream, static_cast<std::uint32_t>(value >> 32));
+}
+
+
+std::uint16_t encodeInput(const game_logic::PlayerInput& input)
+{
+  auto bit = [](const bool value, const int index) {
+    return static_cast<std::uint16_t>(value ? 1 << index : 0);
+  };
+
+  return bit(input.mLeft, 0) | bit(input.mRight, 1) | bit(input.mUp, 2) |
+    bit(input.mDown, 3) | bit(input.mInteract.mIsPressed, 4) |
+    bit(input.mInteract.mWasTriggered, 5) | bit(input.mJump.mIsPressed, 6) |
+    bit(input.mJump.mWasTriggered, 7) | bit(input.mFire.mIsPressed, 8) |
+    bit(input.mFire.mWasTriggered, 9);
+}
+
+
+game_logic::PlayerInput decodeInput(const std::uint16_t bits)
+{
+  auto bit = [bits](const int index) { return (bits & (1 << index)) != 0; };
+
+  game_logic::PlayerInput input;
+  input.mLeft = bit(0);
+  input.mRight = bit(1);
+  input.mUp = bit(2);
+  input.mDown = bit(3);
+  input.mInteract = {bit(4), bit(5)};
+  input.mJump = {bit(6), bit(7)};
+  input.mFire = {bit(8), bit(9)};
+  return input;
+}
+
+
+std::uint32_t encodeTutorialMessages(const data::TutorialMessageState& state)
+{
+  std::uint32_t mask = 0;
+
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i)
+  {
+    if (state.hasBeenShown(static_cast<data::TutorialMessageId>(i)))
+    {
+      mask |= 1u << i;
+    }
+  }
+
+  return mask;
+}
+
+
+data::TutorialMessageState decodeTutorialMessages(const std::uint32_t mask)
+{
+  data::TutorialMessageState state;
+
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i)
+  {
+    if (mask & (1u << i))
+    {
+      state.markAsShown(static_cast<data::TutorialMessageId>(i));
+    }
+  }
+
+  return state;
+}
+
+
+void writeHeader(std::ostream& stream, const ReplayHeader& header)
+{
+  stream.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+  writeU8(stream, REPLAY_FORMAT_VERSION);
+  writeU8(stream, static_cast<std::uint8_t>(header.mGameplayStyle));
+  writeU8(stream, static_cast<std::uint8_t>(header.mSessionId.mEpisode));
+  writeU8(stream, static_cast<std::uint8_t>(header.mSessionId.mLevel));
+  writeU8(stream, static_cast<std::uint8_t>(header.mSessionId.mDifficulty));
+
+  std::uint8_t optionFlags = 0;
+  optionFlags |= header.mWidescreenModeOn ? OPTION_WIDESCREEN : 0;
+  optionFlags |= header.mMotionSmoothing ? OPTION_MOTION_SMOOTHING : 0;
+  optionFlags |= header.mEnableScreenFlashes ? OPTION_SCREEN_FLASHES : 0;
+  optionFlags |= header.mQuickSavingEnabled ? OPTION_QUICK_SAVING : 0;
+  writeU8(stream, optionFlags);
+
+  writeU8(stream, header.mRandomNumberGeneratorState);
+  writeU8(stream, static_cast<std::uint8_t>(header.mWeapon));
+  writeU8(stream, static_cast<std::uint8_t>(header.mAmmo));
+  writeU32(stream, static_cast<std::uint32_t>(header.mScore));
+  writeU32(stream, encodeTutorialMessages(header.mTutorialMessages));
+
+  writeU8(stream, header.mPlayerPositionOverride ? 1 : 0);
+  if (header.mPlayerPositionOverride)
+  {
+    const auto& position = *header.mPlayerPositionOverride;
+    writeU16(stream, static_cast<std::uint16_t>(position.x));
+    writeU16(stream, static_cast<std::uint16_t>(position.y));
+  }
+}
+
+
+ReplayHeader readHeader(assets::LeStreamReader& reader)
+{
+  for (const auto expectedChar : REPLAY_MAGIC)
+  {
+    if (reader.readU8() != static_cast<std::uint8_t>(expectedChar))
+    {
+      throw std::runtime_error("Not a replay file");
+    }
+  }
+
+  if (reader.readU8() != REPLAY_FORMAT_VERSION)
+  {
+    throw std::runtime_error("Unsupported replay file version");
+  }
+
+  ReplayHeader header;
+  header.mGameplayStyle = static_cast<data::GameplayStyle>(reader.readU8());
+  header.mSessionId.mEpisode = reader.readU8();
+  header.mSessionId.mLevel = reader.readU8();
+  header.mSessionId.mDifficulty =
+    static_cast<data::Difficulty>(reader.readU8());
+
+  const auto optionFlags = reader.readU8();
+  header.mWidescreenModeOn = (optionFlags & OPTION_WIDESCREEN) != 0;
+  header.mMotionSmoothing = (optionFlags & OPTION_MOTION_SMOOTHING) != 0;
+  header.mEnableScreenFlashes = (optionFlags & OPTION_SCREEN_FLASHES) != 0;
+  header.mQuickSavingEnabled = (optionFlags & OPTION_QUICK_SAVING) != 0;
+
+  header.mRandomNumberGeneratorState = reader.readU8();
+  header.mWeapon = static_cast<data::WeaponType>(reader.readU8());
+  header.mAmmo = reader.readU8();
+  header.mScore = static_cast<int>(reader.readU32());
+  header.mTutorialMessages = decodeTutorialMessages(reader.readU32());
+
+  if (reader.readU8() != 0)
+  {
+    const auto x = reader.readU16();
+    const auto y = reader.readU16();
+    header.mPlayerPositionOverride = base::Vec2{x, y};
+  }
+
+  if (
+    header.mSessionId.mEpisode >= data::NUM_EPISODES ||
+    header.mSessionId.mLevel >= data::NUM_LEVELS_PER_EPISODE)
+  {
+    throw std::runtime_error("Invalid level in replay file");
+  }
+
+  return header;
+}
+
+} // namespace
+
+
+ReplayHeader makeReplayHeader(
+  const data::GameSessionId& sessionId,
+  const data::GameOptions& options,
+  const data::PersistentPlayerState& persistentPlayerState,
+  const std::optional<base::Vec2>& playerPositionOverride)
+{
+  ReplayHeader header;
+  header.mSessionId = sessionId;
+  header.mGameplayStyle = options.mGameplayStyle;
+  header.mWidescreenModeOn = options.mWidescreenModeOn;
+  header.mMotionSmoothing = options.mMotionSmoothing;
+  header.mEnableScreenFlashes = options.mEnableScreenFlashes;
+  header.mQuickSavingEnabled = options.mQuickSavingEnabled;
+  header.mWeapon = persistentPlayerState.weapon();
+  header.mAmmo = persistentPlayerState.ammo();
+  header.mScore = persistentPlayerState.score();
+  header.mTutorialMessages = persistentPlayerState.tutorialMessages();
+  header.mPlayerPositionOverride = playerPositionOverride;
+  return header;
+}
+
+
+void applyReplayOptions(const ReplayHeader& header, data::GameOptions& options)
+{
+  options.mGameplayStyle = header.mGameplayStyle;
+  options.mWidescreenModeOn = header.mWidescreenModeOn;
+  options.mMotionSmoothing = header.mMotionSmoothing;
+  options.mEnableScreenFlashes = header.mEnableScreenFlashes;
+  options.mQuickSavingEnabled = header.mQuickSavingEnabled;
+}
+
+
+data::PersistentPlayerState initialPlayerState(const ReplayHeader& header)
+{
+  // At the start of a level, the player always has full health and an empty
+  // inventory, so a saved game contains all the information we need.
+  data::SavedGame save;
+  save.mSessionId = header.mSessionId;
+  save.mTutorialMessagesAlreadySeen = header.mTutorialMessages;
+  save.mWeapon = header.mWeapon;
+  save.mAmmo = header.mAmmo;
+  save.mScore = header.mScore;
+  return data::PersistentPlayerState{save};
+}
+
+
+Replay loadReplay(const std::filesystem::path& path)
+{
+  const auto data = assets::loadFile(path);
+  auto reader = assets::LeStreamReader{data};
+
+  Replay replay;
+  replay.mHeader = readHeader(reader);
+
+  while (reader.hasData())
+  {
+    const auto type = static_cast<ReplayEventType>(reader.readU8());
+
+    switch (type)
+    {
+      case ReplayEventType::Update:
+        {
+          const auto bits = reader.readU16();
+          const auto count = reader.readU16();
+          const auto event = ReplayEvent{
+            type, decodeInput(bits), (bits & END_OF_FRAME_BIT) != 0};
+          replay.mEvents.insert(replay.mEvents.end(), count, event);
+        }
+        break;
+
+      case ReplayEventType::QuickSave:
+      case ReplayEventType::QuickLoad:
+      case ReplayEventType::ToggleGodMode:
+      case ReplayEventType::FullHealthCheat:
+      case ReplayEventType::GiveItemsCheat:
+        replay.mEvents.push_back(ReplayEvent{type, {}});
+        break;
+
+      case ReplayEventType::End:
+        return replay;
+
+      default:
+        throw std::runtime_error("Invalid record in replay file");
+    }
+  }
+
+  return replay;
+}
+
+
+std::filesystem::path stateHashFilePath(const std::filesystem::path& path)
+{
+  auto result = path;
+  result += ".hashes";
+  return result;
+}
+
+
+std::vector<std::uint64_t>
+  loadStateHashes(const std::filesystem::path& replayPath)
+{
+  const auto hashFilePath = stateHashFilePath(replayPath);
+  if (!std::filesystem::exists(hashFilePath))
+  {
+    return {};
+  }
+
+  const auto data = assets::loadFile(hashFilePath);
+  auto reader = assets::LeStreamReader{data};
+
+  std::vector<std::uint64_t> hashes;
+  hashes.reserve(data.size() / sizeof(std::uint64_t));
+
+  while (reader.hasData())
+  {
+    const auto lowerHalf = std::uint64_t{reader.readU32()};
+    const auto upperHalf = std::uint64_t{reader.readU32()};
+    hashes.push_back(lowerHalf | (upperHalf << 32));
+  }
+
+  return hashes;
+}
+
+
+void applyReplayEvent(const ReplayEvent& event, game_logic::IGameWorld& world)
+{
+  switch (event.mType)
+  {
+    case ReplayEventType::Update:
+      world.updateGameLogic(event.mInput);
+
+      if (event.mEndOfFrame)
+      {
+        world.processEndOfFrameActions();
+      }
+      break;
+
+    case ReplayEventType::QuickSave:
+      world.quickSave();
+      break;
+
+    case ReplayEventType::QuickLoad:
+      world.quickLoad();
+      break;
+
+    case ReplayEventType::ToggleGodMode:
+      world.toggleGodMode();
+      break;
+
+    case ReplayEventType::FullHealthCheat:
+      world.activateFullHealthCheat();
+      break;
+
+    case ReplayEventType::GiveItemsCheat:
+      world.activateGiveItemsCheat();
+      break;
+
+    case ReplayEventType::End:
+      break;
+  }
+}
+
+
+RecordingGameWorld::RecordingGameWorld(
+  std::unique_ptr<game_logic::IGameWorld> pWorld,
+  const std::filesystem::path& outputFilePath,
+  ReplayHeader header)
+  : mpWorld(std::move(pWorld))
+  , mFile(outputFilePath, std::ios::binary | std::ios::trunc)
+  , mHashFile(
+      stateHashFilePath(outputFilePath), std::ios::binary | std::ios::trunc)
+{
+  if (!mFile || !mHashFile)
+  {
+    throw std::runtime_error(
+      "Cannot open replay file for writing: " + outputFilePath.u8string());
+  }
+
+  header.mRandomNumberGeneratorState = mpWorld->randomNumberGeneratorState();
+  writeHeader(mFile, header);
+}
+
+
+RecordingGameWorld::~RecordingGameWorld()
+{
+  recordEvent(ReplayEventType::End);
+}
+
+
+void RecordingGameWorld::recordEvent(const ReplayEventType type)
+{
+  finishUpdate(false);
+  flushPendingInput();
+  writeU8(mFile, static_cast<std::uint8_t>(type));
+}
+
+
+void RecordingGameWorld::finishUpdate(const bool endOfFrame)
+{
+  if (!mUnfinishedUpdateInput)
+  {
+    return;
+  }
+
+  const auto encodedInput = static_cast<std::uint16_t>(
+    *mUnfinishedUpdateInput | (endOfFrame ? END_OF_FRAME_BIT : 0));
+  mUnfinishedUpdateInput.reset();
+
+  writeU64(mHashFile, mpWorld->stateHash());
+
+  if (
+    mPendingInputCount > 0 &&
+    (encodedInput != mPendingInput ||
+     mPendingInputCount == std::numeric_limits<std::uint16_t>::max()))
+  {
+    flushPendingInput();
+  }
+
+  mPendingInput = encodedInput;
+  ++mPendingInputCount;
+}
+
+
+void RecordingGameWorld::flushPendingInput()
+{
+  if (mPendingInputCount == 0)
+  {
+    return;
+  }
+
+  writeU8(mFile, static_cast<std::uint8_t>(ReplayEventType::Update));
+  writeU16(mFile, mPendingInput);
+  writeU16(mFile, mPendingInputCount);
+  mPendingInputCount = 0;
+}
+
+
+bool RecordingGameWorld::levelFinished() const
+{
+  return mpWorld->levelFinished();
+}
+
+
+std::set<data::Bonus> RecordingGameWorld::achievedBonuses() const
+{
+  return mpWorld->achievedBonuses();
+}
+
+
+bool RecordingGameWorld::needsPerElementUpscaling() const
+{
+  return mpWorld->needsPerElementUpscaling();
+}
+
+
+void RecordingGameWorld::updateGameLogic(const game_logic::PlayerInput& input)
+{
+  // Whether this update is followed by end of frame processing is only known
+  // once we see the next call, so we defer writing it (and the corresponding
+  // state hash) until then.
+  finishUpdate(false);
+  mUnfinishedUpdateInput = encodeInput(input);
+
+  mpWorld->updateGameLogic(input);
+}
+
+
+void RecordingGameWorld::render(const float interpolationFactor)
+{
+  mpWorld->render(interpolationFactor);
+}
+
+
+void RecordingGameWorld::processEndOfFrameActions()
+{
+  mpWorld->processEndOfFrameActions();
+  finishUpdate(true);
+}
+
+
+void RecordingGameWorld::updateBackdropAutoScrolling(
+  const engine::TimeDelta dt)
+{
+  mpWorld->updateBackdropAutoScrolling(dt);
+}
+
+
+bool RecordingGameWorld::isPlayerInShip() const
+{
+  return mpWorld->isPlayerInShip();
+}
+
+
+void RecordingGameWorld::toggleGodMode()
+{
+  recordEvent(ReplayEventType::ToggleGodMode);
+  mpWorld->toggleGodMode();
+}
+
+
+bool RecordingGameWorld::isGodModeOn() const
+{
+  return mpWorld->isGodModeOn();
+}
+
+
+void RecordingGameWorld::activateFullHealthCheat()
+{
+  recordEvent(ReplayEventType::FullHealthCheat);
+  mpWorld->activateFullHealthCheat();
+}
+
+
+void RecordingGameWorld::activateGiveItemsCheat()
+{
+  recordEvent(ReplayEventType::GiveItemsCheat);
+  mpWorld->activateGiveItemsCheat();
+}
+
+
+void RecordingGameWorld::quickSave()
+{
+  recordEvent(ReplayEventType::QuickSave);
+  mpWorld->quickSave();
+}
+
+
+void RecordingGameWorld::quickLoad()
+{
+  recordEvent(ReplayEventType::QuickLoad);
+  mpWorld->quickLoad();
+}
+
+
+bool RecordingGameWorld::canQuickLoad() const
+{
+  return mpWorld->canQuickLoad();
+}
+
+
+void RecordingGameWorld::recordRewindState()
+{
+  // Nothing to do, see rewind()
+}
+
+
+bool RecordingGameWorld::rewind()
+{
+  return false;
+}
+
+
+void RecordingGameWorld::debugToggleBoundingBoxDisplay()
+{
+  mpWorld->debugToggleBoundingBoxDisplay();
+}
+
+
+void RecordingGameWorld::debugToggleWorldCollisionDataDisplay()
+{
+  mpWorld->debugToggleWorldCollisionDataDisplay();
+}
+
+
+void RecordingGameWorld::debugToggleGridDisplay()
+{
+  mpWorld->debugToggleGridDisplay();
+}
+
+
+void RecordingGameWorld::printDebugText(std::ostream& stream) const
+{
+  mpWorld->printDebugText(stream);
+}
+
+
+std::uint8_t RecordingGameWorld::randomNumberGeneratorState() const
+{
+  return mpWorld->randomNumberGeneratorState();
+}
+
+
+void RecordingGameWorld::setRandomNumberGeneratorState(
+  const std::uint8_t state)
+{
+  mpWorld->setRandomNumberGeneratorState(state);
+}
+
+
+std::uint64_t RecordingGameWorld::stateHash() const
+{
+  return mpWorld->stateHash();
+}
+
+} // namespace rigel
@@ -0,0 +1,232 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "data/game_options.hpp"
+#include "data/game_session_data.hpp"
+#include "data/player_model.hpp"
+#include "data/tutorial_messages.hpp"
+#include "game_logic_common/igame_world.hpp"
+#include "game_logic_common/input.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+namespace rigel
+{
+
+/* Recording and replaying of gameplay
+ *
+ * A replay captures everything that's needed to deterministically re-run a
+ * level: The session id, the gameplay style, the options which influence game
+ * logic, the player's state at the start of the level, and the state of the
+ * random number generator. Following that, every PlayerInput given to
+ * IGameWorld::updateGameLogic() is recorded, as well as all other calls which
+ * modify the game state (quick saving/loading, cheats).
+ *
+ * Replay files are written as a stream while playing. All numbers are stored
+ * in little-endian format. The file starts with a header:
+ *
+ *   4 bytes   magic ("RGLR")
+ *   u8        format version
+ *   u8        gameplay style (see data::GameplayStyle)
+ *   u8        episode
+ *   u8        level
+ *   u8        difficulty
+ *   u8        option flags (widescreen, motion smoothing, screen flashes,
+ *             quick saving)
+ *   u8        random number generator state
+ *   u8        weapon
+ *   u8        ammo
+ *   u32       score
+ *   u32       tutorial messages already shown (bit mask)
+ *   u8        1 if a player position override follows, 0 otherwise
+ *   u16, u16  player position override (optional)
+ *
+ * This is followed by a list of records, each starting with a u8 type (see
+ * ReplayEventType). Update records are followed by a u16 containing the
+ * player input as bit mask, and a u16 repeat count. Since input often stays
+ * the same for many frames, this keeps the files small. The topmost bit of
+ * the input mask indicates that IGameWorld::processEndOfFrameActions() was
+ * called after the update, since this influences the outcome of e.g. player
+ * death and teleporting. All other record types have no payload. An End
+ * record terminates the list, but a file ending without one (e.g. due to a
+ * crash) is still valid.
+ *
+ * Next to each replay file, a state hash file is written (same name, with
+ * ".hashes" appended). It contains one u64 per game logic update, holding the
+ * value of IGameWorld::stateHash() after that update (and end of frame
+ * processing, if any). When playing back, these are compared against the
+ * hashes of the replayed world, which pinpoints the exact update where the
+ * simulation diverges - e.g. when comparing an optimized build to a
+ * reference build.
+ *
+ * Note that changing options while recording is not supported, and might
+ * make the replay diverge from the original run. Widescreen mode is not
+ * available when replaying headless, so recordings made in widescreen mode
+ * can't be replayed faithfully.
+ */
+
+
+/** Everything needed to set up a game world for replaying */
+struct ReplayHeader
+{
+  data::GameSessionId mSessionId;
+  data::GameplayStyle mGameplayStyle = data::GameplayStyle::Enhanced;
+  bool mWidescreenModeOn = false;
+  bool mMotionSmoothing = false;
+  bool mEnableScreenFlashes = true;
+  bool mQuickSavingEnabled = false;
+  std::uint8_t mRandomNumberGeneratorState = 0;
+  data::WeaponType mWeapon = data::WeaponType::Normal;
+  int mAmmo = data::MAX_AMMO;
+  int mScore = 0;
+  data::TutorialMessageState mTutorialMessages;
+  std::optional<base::Vec2> mPlayerPositionOverride;
+};
+
+
+enum class ReplayEventType : std::uint8_t
+{
+  Update = 1,
+  QuickSave = 2,
+  QuickLoad = 3,
+  ToggleGodMode = 4,
+  FullHealthCheat = 5,
+  GiveItemsCheat = 6,
+  End = 0xFF
+};
+
+
+struct ReplayEvent
+{
+  ReplayEventType mType;
+
+  /** Only used for ReplayEventType::Update */
+  game_logic::PlayerInput mInput;
+  bool mEndOfFrame = false;
+};
+
+
+struct Replay
+{
+  ReplayHeader mHeader;
+  std::vector<ReplayEvent> mEvents;
+};
+
+
+/** Create header describing the given level start state
+ *
+ * The random number generator state is filled in by RecordingGameWorld.
+ */
+ReplayHeader makeReplayHeader(
+  const data::GameSessionId& sessionId,
+  const data::GameOptions& options,
+  const data::PersistentPlayerState& persistentPlayerState,
+  const std::optional<base::Vec2>& playerPositionOverride);
+
+/** Apply the recorded options to the given set of options */
+void applyReplayOptions(const ReplayHeader& header, data::GameOptions& options);
+
+/** Returns the player's state at the start of the recorded level */
+data::PersistentPlayerState initialPlayerState(const ReplayHeader& header);
+
+/** Load a replay file
+ *
+ * Throws an exception if the file can't be opened or is invalid.
+ */
+Replay loadReplay(const std::filesystem::path& path);
+
+/** Returns path of the state hash file belonging to the given replay file */
+std::filesystem::path stateHashFilePath(const std::filesystem::path& path);
+
+/** Load the state hashes belonging to the given replay file
+ *
+ * Returns an empty list if there is no state hash file.
+ */
+std::vector<std::uint64_t>
+  loadStateHashes(const std::filesystem::path& replayPath);
+
+/** Perform the action described by the given event on the given world */
+void applyReplayEvent(const ReplayEvent& event, game_logic::IGameWorld& world);
+
+
+/** Game world decorator which records all state changes to a replay file
+ *
+ * All calls are forwarded to the given world. Those that influence the game
+ * state are written to the output file. The world's state hash is written to
+ * the corresponding state hash file after each update. The state of the
+ * random number generator is taken from the world on construction, so the
+ * world should be passed in right after creating it.
+ *
+ * Rewinding is not supported while recording, since a replay couldn't
+ * reproduce it.
+ */
+class RecordingGameWorld : public game_logic::IGameWorld
+{
+public:
+  RecordingGameWorld(
+    std::unique_ptr<game_logic::IGameWorld> pWorld,
+    const std::filesystem::path& outputFilePath,
+    ReplayHeader header);
+  ~RecordingGameWorld() override;
+
+  bool levelFinished() const override;
+  std::set<data::Bonus> achievedBonuses() const override;
+  bool needsPerElementUpscaling() const override;
+  void updateGameLogic(const game_logic::PlayerInput& input) override;
+  void render(float interpolationFactor = 0.0f) override;
+  void processEndOfFrameActions() override;
+  void updateBackdropAutoScrolling(engine::TimeDelta dt) override;
+  bool isPlayerInShip() const override;
+  void toggleGodMode() override;
+  bool isGodModeOn() const override;
+  void activateFullHealthCheat() override;
+  void activateGiveItemsCheat() override;
+  void quickSave() override;
+  void quickLoad() override;
+  bool canQuickLoad() const override;
+  void recordRewindState() override;
+  bool rewind() override;
+  void debugToggleBoundingBoxDisplay() override;
+  void debugToggleWorldCollisionDataDisplay() override;
+  void debugToggleGridDisplay() override;
+  void printDebugText(std::ostream& stream) const override;
+  std::uint8_t randomNumberGeneratorState() const override;
+  void setRandomNumberGeneratorState(std::uint8_t state) override;
+  std::uint64_t stateHash() const override;
+
+private:
+  void recordEvent(ReplayEventType type);
+  void finishUpdate(bool endOfFrame);
+  void flushPendingInput();
+
+  std::unique_ptr<game_logic::IGameWorld> mpWorld;
+  std::ofstream mFile;
+  std::ofstream mHashFile;
+  std::optional<std::uint16_t> mUnfinishedUpdateInput;
+  std::uint16_t mPendingInput = 0;
+  std::uint16_t mPendingInputCount = 0;
+};
+
+} // namespace rigel
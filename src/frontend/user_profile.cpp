@@ -418,6 +418,9 @@ nlohmann::ordered_json serialize(const data::GameOptions& options)
   serialized["upscalingFilter"] = options.mUpscalingFilter;
   serialized["aspectRatioCorrectionEnabled"] =
     options.mAspectRatioCorrectionEnabled;
+  serialized["deferredDrawBatching"] = options.mDeferredDrawBatching;
+  serialized["multiTextureBatching"] = options.mMultiTextureBatching;
+  serialized["singlePassMapRendering"] = options.mSinglePassMapRendering;
   serialized["soundStyle"] = options.mSoundStyle;
   serialized["adlibPlaybackType"] = options.mAdlibPlaybackType;
   serialized["musicVolume"] = options.mMusicVolume;
@@ -640,6 +643,12 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json)
   extractValueIfExists("upscalingFilter", result.mUpscalingFilter, json);
   extractValueIfExists(
     "aspectRatioCorrectionEnabled", result.mAspectRatioCorrectionEnabled, json);
+  extractValueIfExists(
+    "deferredDrawBatching", result.mDeferredDrawBatching, json);
+  extractValueIfExists(
+    "multiTextureBatching", result.mMultiTextureBatching, json);
+  extractValueIfExists(
+    "singlePassMapRendering", result.mSinglePassMapRendering, json);
   extractValueIfExists("soundStyle", result.mSoundStyle, json);
   extractValueIfExists("adlibPlaybackType", result.mAdlibPlaybackType, json);
   extractValueIfExists("musicVolume", result.mMusicVolume, json);
@@ -16,6 +16,7 @@
 
 #include "behavior_controller_system.hpp"
 
+#include "base/profiler.hpp"
 #include "engine/base_components.hpp"
 #include "engine/physical_components.hpp"
 #include "game_logic/behavior_controller.hpp"
@@ -43,6 +44,8 @@ void BehaviorControllerSystem::update(
   entityx::EntityManager& es,
   const PerFrameState& s)
 {
+  RIGEL_PROFILE_SCOPE("BehaviorControllerSystem::update");
+
   using engine::components::Active;
   using game_logic::components::BehaviorController;
 
@@ -16,6 +16,7 @@
 
 #include "camera.hpp"
 
+#include "base/profiler.hpp"
 #include "data/game_traits.hpp"
 #include "data/map.hpp"
 #include "engine/physical_components.hpp"
@@ -172,6 +173,8 @@ void Camera::synchronizeTo(const Camera& other)
 
 void Camera::update(const PlayerInput& input, const base::Size& viewportSize)
 {
+  RIGEL_PROFILE_SCOPE("Camera::update");
+
   mViewportSize = viewportSize;
   updateManualScrolling(input);
 
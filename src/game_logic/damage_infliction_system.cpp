@@ -16,6 +16,7 @@
 
 #include "damage_infliction_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/player_model.hpp"
 #include "engine/base_components.hpp"
 #include "engine/physical_components.hpp"
@@ -65,40 +66,68 @@ DamageInflictionSystem::DamageInflictionSystem(
 
 void DamageInflictionSystem::update(ex::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("DamageInflictionSystem::update");
+
+  rebuildInflictorIndex(es);
+  if (mInflictorIndex.empty())
+  {
+    return;
+  }
+
   es.each<Shootable, WorldPosition, BoundingBox>(
     [this, &es](
       ex::Entity shootableEntity,
       Shootable& shootable,
       const WorldPosition& shootablePos,
       const BoundingBox& shootableBboxLocal) {
+      const auto shootableOnScreen =
+        shootableEntity.has_component<Active>() &&
+        shootableEntity.component<Active>()->mIsOnScreen;
+
+      if (shootable.mInvincible || !shootableOnScreen)
+      {
+        return;
+      }
+
       const auto shootableBbox =
         engine::toWorldSpace(shootableBboxLocal, shootablePos);
 
-      ex::ComponentHandle<DamageInflicting> damage;
-      ex::ComponentHandle<WorldPosition> inflictorPosition;
-      ex::ComponentHandle<BoundingBox> inflictorBboxLocal;
-      for (auto inflictorEntity : es.entities_with_components(
-             damage, inflictorPosition, inflictorBboxLocal))
+      if (mInflictorIndexIsOutOfDate)
       {
-        const auto inflictorBbox =
-          engine::toWorldSpace(*inflictorBboxLocal, *inflictorPosition);
-
-        const auto shootableOnScreen =
-          shootableEntity.has_component<Active>() &&
-          shootableEntity.component<Active>()->mIsOnScreen;
-
-        // clang-format off
-        if (
-          shootableBbox.intersects(inflictorBbox) &&
-          !shootable.mInvincible &&
-          shootableOnScreen)
-        // clang-format on
-        {
-          inflictDamage(inflictorEntity, *damage, shootableEntity, shootable);
-          break;
-        }
+        rebuildInflictorIndex(es);
       }
+
+      // Same as checking all inflictors in entity order, and picking the
+      // first one that intersects
+      const auto& inflictors =
+        mInflictorIndex.entitiesIntersecting(shootableBbox);
+      if (!inflictors.empty())
+      {
+        auto inflictorEntity = inflictors.front();
+        auto damage = inflictorEntity.component<DamageInflicting>();
+        inflictDamage(inflictorEntity, *damage, shootableEntity, shootable);
+        mInflictorIndexIsOutOfDate = true;
+      }
+    });
+}
+
+
+void DamageInflictionSystem::rebuildInflictorIndex(ex::EntityManager& es)
+{
+  mInflictorIndex.clear();
+  es.each<DamageInflicting, WorldPosition, BoundingBox>(
+    [this](
+      ex::Entity inflictorEntity,
+      const DamageInflicting&,
+      const WorldPosition& inflictorPos,
+      const BoundingBox& inflictorBboxLocal) {
+      mInflictorIndex.insert(
+        inflictorEntity,
+        engine::toWorldSpace(inflictorBboxLocal, inflictorPos));
     });
+
+  mInflictorIndex.build();
+  mInflictorIndexIsOutOfDate = false;
 }
 
 
@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/spatial_index.hpp"
 #include "game_logic/damage_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -49,6 +50,8 @@ public:
   void update(entityx::EntityManager& es);
 
 private:
+  void rebuildInflictorIndex(entityx::EntityManager& es);
+
   void inflictDamage(
     entityx::Entity inflictorEntity,
     components::DamageInflicting& damage,
@@ -58,6 +61,13 @@ private:
   data::PersistentPlayerState* mpPersistentPlayerState;
   IGameServiceProvider* mpServiceProvider;
   entityx::EventManager* mpEvents;
+
+  // Rebuilt on each update, member to avoid reallocating every frame.
+  // Inflicting damage emits events, and their listeners might create, move
+  // or destroy inflictors. The index is therefore also rebuilt before the
+  // next query whenever damage has been inflicted.
+  engine::SpatialIndex mInflictorIndex;
+  bool mInflictorIndexIsOutOfDate = false;
 };
 
 } // namespace rigel::game_logic
@@ -16,6 +16,7 @@
 
 #include "dynamic_geometry_system.hpp"
 
+#include "base/profiler.hpp"
 #include "base/spatial_types_printing.hpp"
 #include "data/map.hpp"
 #include "data/sound_ids.hpp"
@@ -386,6 +387,8 @@ DynamicGeometrySystem::DynamicGeometrySystem(
 
 void DynamicGeometrySystem::updateShootableWalls()
 {
+  RIGEL_PROFILE_SCOPE("DynamicGeometrySystem::updateShootableWalls");
+
   using engine::components::BoundingBox;
   using engine::components::MovingBody;
   using engine::components::WorldPosition;
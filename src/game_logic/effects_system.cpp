@@ -17,6 +17,7 @@
 #include "effects_system.hpp"
 
 #include "base/match.hpp"
+#include "base/profiler.hpp"
 #include "data/game_traits.hpp"
 #include "engine/base_components.hpp"
 #include "engine/life_time_components.hpp"
@@ -98,6 +99,8 @@ EffectsSystem::EffectsSystem(
 
 void EffectsSystem::update(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("EffectsSystem::update");
+
   using namespace engine::components;
 
   es.each<DestructionEffects, WorldPosition>([this](
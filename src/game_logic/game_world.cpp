@@ -18,7 +18,9 @@
 
 #include "assets/resource_loader.hpp"
 #include "base/match.hpp"
+#include "base/profiler.hpp"
 #include "base/spatial_types_printing.hpp"
+#include "base/state_hasher.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "data/map.hpp"
@@ -28,13 +30,16 @@
 #include "engine/base_components.hpp"
 #include "engine/entity_tools.hpp"
 #include "engine/graphical_effects.hpp"
+#include "engine/life_time_components.hpp"
 #include "engine/motion_smoothing.hpp"
 #include "engine/physical_components.hpp"
+#include "engine/visual_components.hpp"
 #include "frontend/game_service_provider.hpp"
 #include "frontend/user_profile.hpp"
 #include "game_logic/actor_tag.hpp"
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/collectable_components.hpp"
+#include "game_logic/damage_components.hpp"
 #include "game_logic/dynamic_geometry_components.hpp"
 #include "game_logic/enemies/dying_boss.hpp"
 #include "game_logic/world_state.hpp"
@@ -206,6 +211,34 @@ base::Size clampedSectionSize(
 } // namespace
 
 
+GameWorld::RenderResources::RenderResources(
+  renderer::Renderer* pRenderer,
+  const assets::ResourceLoader& resources,
+  const data::GameOptions* pOptions,
+  engine::SpriteFactory* pSpriteFactory,
+  const int levelNumber)
+  : mUiSpriteSheet(
+      renderer::Texture{pRenderer, resources.loadUiSpriteSheet()},
+      data::GameTraits::viewportSize,
+      pRenderer)
+  , mTextRenderer(&mUiSpriteSheet, pRenderer, resources)
+  , mHudRenderer(
+      levelNumber,
+      pOptions,
+      pRenderer,
+      &mUiSpriteSheet,
+      renderer::Texture{pRenderer, resources.loadWideHudFrameImage()},
+      renderer::Texture{pRenderer, resources.loadUltrawideHudFrameImage()},
+      pSpriteFactory)
+  , mSpecialEffects(pRenderer, *pOptions)
+  , mLowResLayer(
+      pRenderer,
+      renderer::determineWidescreenViewport(pRenderer).mWidthPx,
+      data::GameTraits::viewportHeightPx)
+{
+}
+
+
 GameWorld::GameWorld(
   data::PersistentPlayerState* pPersistentPlayerState,
   const data::GameSessionId& sessionId,
@@ -215,40 +248,29 @@ GameWorld::GameWorld(
   const PlayerInput& initialInput)
   : mpRenderer(context.mpRenderer)
   , mpServiceProvider(context.mpServiceProvider)
-  , mUiSpriteSheet(
-      renderer::Texture{mpRenderer, context.mpResources->loadUiSpriteSheet()},
-      data::GameTraits::viewportSize,
-      mpRenderer)
-  , mTextRenderer(&mUiSpriteSheet, mpRenderer, *context.mpResources)
   , mpPersistentPlayerState(pPersistentPlayerState)
   , mpOptions(&context.mpUserProfile->mOptions)
   , mpResources(context.mpResources)
   , mpSpriteFactory(context.mpSpriteFactory)
   , mSessionId(sessionId)
   , mPlayerModelAtLevelStart(*mpPersistentPlayerState)
-  , mHudRenderer(
-      sessionId.mLevel + 1,
-      mpOptions,
-      mpRenderer,
-      &mUiSpriteSheet,
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadWideHudFrameImage()},
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadUltrawideHudFrameImage()},
-      mpSpriteFactory)
-  , mMessageDisplay(mpServiceProvider, &mTextRenderer)
-  , mSpecialEffects(mpRenderer, *mpOptions)
-  , mLowResLayer(
-      mpRenderer,
-      renderer::determineWidescreenViewport(mpRenderer).mWidthPx,
-      data::GameTraits::viewportHeightPx)
-  , mPreviousWindowSize(mpRenderer->windowSize())
+  , mpRenderResources(
+      mpRenderer ? std::make_unique<RenderResources>(
+                     mpRenderer,
+                     *context.mpResources,
+                     mpOptions,
+                     mpSpriteFactory,
+                     sessionId.mLevel + 1)
+                 : nullptr)
+  , mMessageDisplay(
+      mpServiceProvider,
+      mpRenderResources ? &mpRenderResources->mTextRenderer : nullptr)
+  , mPreviousWindowSize(mpRenderer ? mpRenderer->windowSize() : base::Size{})
   , mPreviousHudStyle(mpOptions->mWidescreenHudStyle)
   , mWidescreenModeWasOn(widescreenModeOn())
   , mPerElementUpscalingWasEnabled(mpOptions->mPerElementUpscalingEnabled)
   , mMotionSmoothingWasEnabled(mpOptions->mMotionSmoothing)
+  , mRewindHistory(REWIND_HISTORY_LENGTH)
 {
   LOG_SCOPE_FUNCTION(INFO);
 
@@ -562,14 +584,21 @@ void GameWorld::unsubscribe(entityx::EventManager& eventManager)
 
 bool GameWorld::needsPerElementUpscaling() const
 {
+  if (!mpRenderResources)
+  {
+    return false;
+  }
+
   return mpSpriteFactory->hasHighResReplacements() ||
-    mpState->mMapRenderer.hasHighResReplacements() ||
-    mUiSpriteSheet.isHighRes();
+    mpState->mMapRenderer->hasHighResReplacements() ||
+    mpRenderResources->mUiSpriteSheet.isHighRes();
 }
 
 
 void GameWorld::updateGameLogic(const PlayerInput& input)
 {
+  RIGEL_PROFILE_SCOPE("GameWorld::updateGameLogic");
+
   mpState->mBackdropFlashColor = std::nullopt;
   mpState->mScreenFlashColor = std::nullopt;
 
@@ -583,7 +612,11 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
     mpState->mEarthQuakeEffect->update();
   }
 
-  mHudRenderer.updateAnimation();
+  if (mpRenderResources)
+  {
+    mpRenderResources->mHudRenderer.updateAnimation();
+  }
+
   mMessageDisplay.update();
 
   updateMotionSmoothingStates();
@@ -602,7 +635,11 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
     ? viewportSizeWideScreen(mpRenderer, *mpOptions)
     : data::GameTraits::mapViewportSize;
 
-  mpState->mMapRenderer.updateAnimatedMapTiles();
+  if (mpState->mMapRenderer)
+  {
+    mpState->mMapRenderer->updateAnimatedMapTiles();
+  }
+
   engine::updateAnimatedSprites(mpState->mEntities);
   ++mpState->mWaterAnimStep;
   if (mpState->mWaterAnimStep >= 4)
@@ -618,8 +655,8 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
 
   mpState->mDynamicGeometrySystem.updateShootableWalls();
 
-  engine::markActiveEntities(
-    mpState->mEntities, mpState->mCamera.position(), viewportSize);
+  mpState->mEntityActivationSystem.markActiveEntities(
+    mpState->mCamera.position(), viewportSize);
   mpState->mBehaviorControllerSystem.update(
     mpState->mEntities,
     PerFrameState{
@@ -649,9 +686,9 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
 
   mpState->mParticles.update();
 
-  if (!mpOptions->mMotionSmoothing)
+  if (mpState->mSpriteRenderingSystem && !mpOptions->mMotionSmoothing)
   {
-    mpState->mSpriteRenderingSystem.update(
+    mpState->mSpriteRenderingSystem->update(
       mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
   }
 
@@ -661,12 +698,21 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
 
 void GameWorld::render(const float interpolationFactor)
 {
+  RIGEL_PROFILE_SCOPE("GameWorld::render");
+
+  if (!mpRenderResources)
+  {
+    return;
+  }
+
+  auto& resources = *mpRenderResources;
+
   if (
     widescreenModeOn() != mWidescreenModeWasOn ||
     mpOptions->mPerElementUpscalingEnabled != mPerElementUpscalingWasEnabled ||
     mPreviousWindowSize != mpRenderer->windowSize())
   {
-    mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
+    resources.mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
   }
 
   if (
@@ -701,6 +747,8 @@ void GameWorld::render(const float interpolationFactor)
 
   auto drawParticlesAndDebugOverlay =
     [&](const ViewportParams& viewportParams) {
+      RIGEL_PROFILE_SCOPE("GameWorld::render (particles and debug overlay)");
+
       renderer::setLocalTranslation(mpRenderer, viewportParams.mCameraOffset);
       mpState->mParticles.render(
         viewportParams.mRenderStartPosition, interpolationFactor);
@@ -730,12 +778,12 @@ void GameWorld::render(const float interpolationFactor)
       drawMapAndSprites(viewportParams, interpolationFactor);
 
       {
-        const auto saved = mLowResLayer.bindAndReset();
+        const auto saved = resources.mLowResLayer.bindAndReset();
         mpRenderer->clear({0, 0, 0, 0});
         drawParticlesAndDebugOverlay(viewportParams);
       }
 
-      mLowResLayer.render(0, 0);
+      resources.mLowResLayer.render(0, 0);
     }
     else
     {
@@ -751,8 +799,8 @@ void GameWorld::render(const float interpolationFactor)
         healthOrZero(mpState->mActiveBossEntity),
         mpState->mBossStartingHealth,
         maxWidthPx,
-        mTextRenderer,
-        mUiSpriteSheet);
+        resources.mTextRenderer,
+        resources.mUiSpriteSheet);
     }
     else
     {
@@ -761,15 +809,20 @@ void GameWorld::render(const float interpolationFactor)
   };
 
   auto drawHud = [&, this]() {
+    RIGEL_PROFILE_SCOPE("GameWorld::render (HUD)");
+
     const auto radarDots =
       collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.renderClassicHud(*mpPersistentPlayerState, radarDots);
+    resources.mHudRenderer.renderClassicHud(
+      *mpPersistentPlayerState, radarDots);
   };
 
   auto drawWidescreenHud = [&](const int viewportWidth) {
+    RIGEL_PROFILE_SCOPE("GameWorld::render (HUD)");
+
     const auto radarDots =
       collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.renderWidescreenHud(
+    resources.mHudRenderer.renderWidescreenHud(
       viewportWidth,
       mpOptions->mWidescreenHudStyle,
       *mpPersistentPlayerState,
@@ -786,7 +839,7 @@ void GameWorld::render(const float interpolationFactor)
 
     if (!mWidescreenModeWasOn && !mpOptions->mMotionSmoothing)
     {
-      mpState->mSpriteRenderingSystem.update(
+      mpState->mSpriteRenderingSystem->update(
         mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
     }
 
@@ -924,9 +977,17 @@ void GameWorld::drawMapAndSprites(
   const ViewportParams& params,
   const float interpolationFactor)
 {
+  RIGEL_PROFILE_SCOPE("GameWorld::drawMapAndSprites");
+
   using game_logic::components::TileDebris;
 
   auto& state = *mpState;
+  auto& specialEffects = mpRenderResources->mSpecialEffects;
+
+  // The map renderer only draws the static parts of the map, dynamic
+  // geometry is drawn by the DynamicGeometrySystem.
+  state.mMapRenderer->setSinglePassRenderingEnabled(
+    mpOptions->mSinglePassMapRendering, state.mMapStaticParts);
 
   auto renderBackdrop = [&]() {
     if (state.mBackdropFlashColor)
@@ -937,7 +998,7 @@ void GameWorld::drawMapAndSprites(
     }
     else
     {
-      state.mMapRenderer.renderBackdrop(
+      state.mMapRenderer->renderBackdrop(
         params.mInterpolatedCameraPosition, params.mViewportSize);
     }
   };
@@ -948,26 +1009,26 @@ void GameWorld::drawMapAndSprites(
         entityx::Entity e, const TileDebris& debris, const WorldPosition& pos) {
         const auto pixelPosition =
           engine::interpolatedPixelPosition(e, interpolationFactor);
-        state.mMapRenderer.renderSingleTile(
+        state.mMapRenderer->renderSingleTile(
           debris.mTileIndex,
           pixelPosition - data::tilesToPixels(params.mRenderStartPosition));
       });
   };
 
   auto renderBackgroundLayers = [&]() {
-    state.mMapRenderer.renderBackground(
+    state.mMapRenderer->renderBackground(
       params.mRenderStartPosition, params.mViewportSize);
     state.mDynamicGeometrySystem.renderDynamicBackgroundSections(
       params.mRenderStartPosition, params.mViewportSize, interpolationFactor);
-    state.mSpriteRenderingSystem.renderRegularSprites(mSpecialEffects);
+    state.mSpriteRenderingSystem->renderRegularSprites(specialEffects);
   };
 
   auto renderForegroundLayers = [&]() {
-    state.mMapRenderer.renderForeground(
+    state.mMapRenderer->renderForeground(
       params.mRenderStartPosition, params.mViewportSize);
     state.mDynamicGeometrySystem.renderDynamicForegroundSections(
       params.mRenderStartPosition, params.mViewportSize, interpolationFactor);
-    state.mSpriteRenderingSystem.renderForegroundSprites(mSpecialEffects);
+    state.mSpriteRenderingSystem->renderForegroundSprites(specialEffects);
     renderTileDebris();
   };
 
@@ -976,7 +1037,7 @@ void GameWorld::drawMapAndSprites(
 
   if (mpOptions->mMotionSmoothing)
   {
-    mpState->mSpriteRenderingSystem.update(
+    mpState->mSpriteRenderingSystem->update(
       mpState->mEntities,
       params.mViewportSize,
       params.mRenderStartPosition,
@@ -987,7 +1048,7 @@ void GameWorld::drawMapAndSprites(
     state.mEntities, params.mRenderStartPosition, params.mViewportSize);
   if (
     waterEffectAreas.empty() &&
-    !mpState->mSpriteRenderingSystem.cloakEffectSpritesVisible())
+    !mpState->mSpriteRenderingSystem->cloakEffectSpritesVisible())
   {
     renderBackdrop();
 
@@ -998,18 +1059,18 @@ void GameWorld::drawMapAndSprites(
   else
   {
     {
-      auto saved = mSpecialEffects.bindBackgroundBuffer();
+      auto saved = specialEffects.bindBackgroundBuffer();
       renderBackdrop();
 
       renderer::setLocalTranslation(mpRenderer, params.mCameraOffset);
       renderBackgroundLayers();
     }
 
-    mSpecialEffects.drawBackgroundBuffer();
+    specialEffects.drawBackgroundBuffer();
 
     renderer::setLocalTranslation(mpRenderer, params.mCameraOffset);
 
-    mSpecialEffects.drawWaterEffect(waterEffectAreas, state.mWaterAnimStep);
+    specialEffects.drawWaterEffect(waterEffectAreas, state.mWaterAnimStep);
     renderForegroundLayers();
   }
 }
@@ -1017,7 +1078,7 @@ void GameWorld::drawMapAndSprites(
 
 bool GameWorld::widescreenModeOn() const
 {
-  return mpOptions->mWidescreenModeOn &&
+  return mpRenderer && mpOptions->mWidescreenModeOn &&
     renderer::canUseWidescreenMode(mpRenderer);
 }
 
@@ -1033,7 +1094,10 @@ void GameWorld::processEndOfFrameActions()
 
 void GameWorld::updateBackdropAutoScrolling(const engine::TimeDelta dt)
 {
-  mpState->mMapRenderer.updateBackdropAutoScrolling(dt);
+  if (mpState->mMapRenderer)
+  {
+    mpState->mMapRenderer->updateBackdropAutoScrolling(dt);
+  }
 }
 
 
@@ -1144,19 +1208,9 @@ void GameWorld::quickSave()
 
   LOG_F(INFO, "Creating quick save");
 
-  auto pStateCopy = std::make_unique<WorldState>(
-    mpServiceProvider,
-    mpRenderer,
-    mpResources,
-    mpPersistentPlayerState,
-    mpOptions,
-    mpSpriteFactory,
-    mSessionId);
-  pStateCopy->synchronizeTo(
-    *mpState, mpServiceProvider, mpPersistentPlayerState, mSessionId);
-
-  mpQuickSave = std::make_unique<QuickSaveData>(
-    QuickSaveData{*mpPersistentPlayerState, std::move(pStateCopy)});
+  mpQuickSave = std::make_unique<QuickSaveData>(QuickSaveData{
+    *mpPersistentPlayerState,
+    std::make_unique<WorldStateSnapshot>(*mpState, mSessionId)});
 
   mMessageDisplay.setMessage(
     data::Messages::QuickSaved, ui::MessagePriority::Menu);
@@ -1174,25 +1228,11 @@ void GameWorld::quickLoad()
 
   LOG_F(INFO, "Loading quick save");
 
-  *mpPersistentPlayerState = mpQuickSave->mPersistentPlayerState;
-  mpState->synchronizeTo(
-    *mpQuickSave->mpState,
-    mpServiceProvider,
-    mpPersistentPlayerState,
-    mSessionId);
-  mpState->mPreviousCameraPosition = mpState->mCamera.position();
+  restoreSnapshot(
+    mpQuickSave->mPersistentPlayerState, *mpQuickSave->mpSnapshot);
   mMessageDisplay.setMessage(
     data::Messages::QuickLoaded, ui::MessagePriority::Menu);
 
-  if (!mpOptions->mMotionSmoothing)
-  {
-    const auto& viewportSize = widescreenModeOn()
-      ? viewportSizeWideScreen(mpRenderer, *mpOptions)
-      : data::GameTraits::mapViewportSize;
-    mpState->mSpriteRenderingSystem.update(
-      mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
-  }
-
   LOG_F(INFO, "Quick save loaded");
 }
 
@@ -1203,6 +1243,68 @@ bool GameWorld::canQuickLoad() const
 }
 
 
+void GameWorld::recordRewindState()
+{
+  // Unlike the classic world's state, entities can't be stored as raw
+  // bytes, so we keep a snapshot of them per update. The map's tiles make up
+  // most of a snapshot's size but rarely change, so they are kept out of the
+  // snapshot, and stored delta-encoded along with the player state instead.
+  mRewindStateBuffer.clear();
+  appendMapTiles(mpState->mMap, mRewindStateBuffer);
+  mRewindHistory.push(mRewindStateBuffer, *mpPersistentPlayerState);
+
+  mRewindSnapshots.push_back(std::make_unique<WorldStateSnapshot>(
+    *mpState, mSessionId, SnapshotMapHandling::Exclude));
+
+  if (mRewindSnapshots.size() > mRewindHistory.size())
+  {
+    mRewindSnapshots.pop_front();
+  }
+}
+
+
+bool GameWorld::rewind()
+{
+  if (mRewindHistory.empty())
+  {
+    return false;
+  }
+
+  // Map changes don't require updating the map renderer, since it only draws
+  // the parts of the map which never change.
+  restoreMapTiles(
+    mRewindHistory.newestState().data(),
+    mpState->mMap,
+    [](const base::Vec2&) {});
+  restoreSnapshot(
+    mRewindHistory.newestPlayerState(), *mRewindSnapshots.back());
+
+  mRewindHistory.dropNewest();
+  mRewindSnapshots.pop_back();
+  return true;
+}
+
+
+void GameWorld::restoreSnapshot(
+  const data::PersistentPlayerState& persistentPlayerState,
+  const WorldStateSnapshot& snapshot)
+{
+  *mpPersistentPlayerState = persistentPlayerState;
+  mpState->restoreFromSnapshot(
+    snapshot, mpServiceProvider, mpPersistentPlayerState, mSessionId);
+  mpState->mPreviousCameraPosition = mpState->mCamera.position();
+
+  if (mpState->mSpriteRenderingSystem && !mpOptions->mMotionSmoothing)
+  {
+    const auto& viewportSize = widescreenModeOn()
+      ? viewportSizeWideScreen(mpRenderer, *mpOptions)
+      : data::GameTraits::mapViewportSize;
+    mpState->mSpriteRenderingSystem->update(
+      mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
+  }
+}
+
+
 void GameWorld::onReactorDestroyed(const base::Vec2& position)
 {
   flashScreen(data::GameTraits::INGAME_PALETTE[7]);
@@ -1220,7 +1322,11 @@ void GameWorld::onReactorDestroyed(const base::Vec2& position)
     data::map::BackdropSwitchCondition::OnReactorDestruction;
   if (!mpState->mReactorDestructionFramesElapsed && shouldDoSpecialEvent)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = true;
     mpState->mReactorDestructionFramesElapsed = 0;
   }
@@ -1298,7 +1404,11 @@ void GameWorld::restartFromCheckpoint()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (mpState->mBackdropSwitched && shouldSwitchBackAfterRespawn)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = false;
   }
 
@@ -1331,7 +1441,11 @@ void GameWorld::handleTeleporter()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (switchBackdrop)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = !mpState->mBackdropSwitched;
   }
 
@@ -1378,4 +1492,133 @@ void GameWorld::printDebugText(std::ostream& stream) const
   }
 }
 
+
+std::uint8_t GameWorld::randomNumberGeneratorState() const
+{
+  return mpState->mRandomGenerator.state();
+}
+
+
+void GameWorld::setRandomNumberGeneratorState(const std::uint8_t state)
+{
+  mpState->mRandomGenerator.setState(state);
+}
+
+
+std::uint64_t GameWorld::stateHash() const
+{
+  using engine::components::ActivationSettings;
+  using engine::components::Active;
+  using engine::components::AnimationLoop;
+  using engine::components::AutoDestroy;
+  using engine::components::BoundingBox;
+  using engine::components::MovingBody;
+  using engine::components::Orientation;
+  using engine::components::Sprite;
+  using game_logic::components::DamageInflicting;
+  using game_logic::components::PlayerDamaging;
+  using game_logic::components::Shootable;
+
+  auto& state = *mpState;
+  base::StateHasher hasher;
+
+  hasher.add(state.mRandomGenerator.state());
+  state.mMap.addToHash(hasher);
+
+  hasher.add(mpPersistentPlayerState->health());
+  hasher.add(mpPersistentPlayerState->score());
+  hasher.add(mpPersistentPlayerState->ammo());
+  hasher.add(mpPersistentPlayerState->weapon());
+  hasher.add(state.mPlayer.animationFrame());
+  hasher.add(state.mPlayer.orientation());
+  hasher.add(state.mPlayer.isInMercyFrames());
+  hasher.add(state.mPlayer.isDead());
+
+  // Entities are visited in order of their index, which only depends on the
+  // order of creation/destruction. This makes the iteration deterministic.
+  hasher.add(state.mEntities.size());
+  state.mEntities.each<WorldPosition>(
+    [&](entityx::Entity entity, const WorldPosition& position) {
+      hasher.add(entity.id().id());
+      hasher.add(position.x);
+      hasher.add(position.y);
+
+      if (entity.has_component<BoundingBox>())
+      {
+        const auto& bbox = *entity.component<BoundingBox>();
+        hasher.add(bbox.topLeft.x);
+        hasher.add(bbox.topLeft.y);
+        hasher.add(bbox.size.width);
+        hasher.add(bbox.size.height);
+      }
+
+      if (entity.has_component<MovingBody>())
+      {
+        const auto& body = *entity.component<MovingBody>();
+        hasher.add(body.mVelocity.x);
+        hasher.add(body.mVelocity.y);
+        hasher.add(body.mIsActive);
+      }
+
+      if (entity.has_component<Shootable>())
+      {
+        const auto& shootable = *entity.component<Shootable>();
+        hasher.add(shootable.mHealth);
+        hasher.add(shootable.mInvincible);
+      }
+
+      if (entity.has_component<DamageInflicting>())
+      {
+        const auto& damage = *entity.component<DamageInflicting>();
+        hasher.add(damage.mAmount);
+        hasher.add(damage.mHasCausedDamage);
+      }
+
+      if (entity.has_component<PlayerDamaging>())
+      {
+        hasher.add(entity.component<PlayerDamaging>()->mAmount);
+      }
+
+      if (entity.has_component<ActivationSettings>())
+      {
+        hasher.add(entity.component<ActivationSettings>()->mHasBeenActivated);
+      }
+
+      if (entity.has_component<Orientation>())
+      {
+        hasher.add(*entity.component<Orientation>());
+      }
+
+      if (entity.has_component<Sprite>())
+      {
+        const auto& sprite = *entity.component<Sprite>();
+        for (const auto& slot : sprite.mFramesToRender)
+        {
+          hasher.add(slot.mFrame);
+        }
+        hasher.add(sprite.mShow);
+      }
+
+      if (entity.has_component<AnimationLoop>())
+      {
+        hasher.add(entity.component<AnimationLoop>()->mFramesElapsed);
+      }
+
+      if (entity.has_component<AutoDestroy>())
+      {
+        const auto& autoDestroy = *entity.component<AutoDestroy>();
+        hasher.add(autoDestroy.mConditionFlags);
+        hasher.add(autoDestroy.mFramesToLive);
+      }
+
+      hasher.add(entity.has_component<Active>());
+    });
+
+  hasher.add(state.mLevelFinished);
+  hasher.add(state.mPlayerDied);
+  hasher.add(state.mIsOddFrame);
+
+  return hasher.value();
+}
+
 } // namespace rigel::game_logic
@@ -30,6 +30,7 @@
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic_common/igame_world.hpp"
 #include "game_logic_common/input.hpp"
+#include "game_logic_common/rewind_history.hpp"
 #include "ui/hud_renderer.hpp"
 #include "ui/ingame_message_display.hpp"
 #include "ui/menu_element_renderer.hpp"
@@ -38,7 +39,10 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
+#include <deque>
 #include <iosfwd>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -61,6 +65,7 @@ namespace rigel::game_logic
 {
 
 struct WorldState;
+struct WorldStateSnapshot;
 
 class GameWorld : public IGameWorld, public entityx::Receiver<GameWorld>
 {
@@ -111,11 +116,28 @@ public:
   void quickLoad() override;
   bool canQuickLoad() const override;
 
+  void recordRewindState() override;
+  bool rewind() override;
+
   void debugToggleBoundingBoxDisplay() override;
   void debugToggleWorldCollisionDataDisplay() override;
   void debugToggleGridDisplay() override;
   void printDebugText(std::ostream& stream) const override;
 
+  std::uint8_t randomNumberGeneratorState() const override;
+  void setRandomNumberGeneratorState(std::uint8_t state) override;
+
+  /** Hash of the simulation state
+   *
+   * Covers the random number generator, map, player and persistent player
+   * state, and for each entity its position, bounding box, physics,
+   * activation state, orientation, sprite frames, animation loop and
+   * auto-destroy timers, and damage-related components. The internal state
+   * of behavior controllers is not hashed, since it's type-erased. A
+   * divergence there is only detected once it affects one of the above.
+   */
+  std::uint64_t stateHash() const override;
+
 private:
   struct ViewportParams
   {
@@ -155,13 +177,35 @@ private:
   struct QuickSaveData
   {
     data::PersistentPlayerState mPersistentPlayerState;
-    std::unique_ptr<WorldState> mpState;
+    std::unique_ptr<WorldStateSnapshot> mpSnapshot;
+  };
+
+  void restoreSnapshot(
+    const data::PersistentPlayerState& persistentPlayerState,
+    const WorldStateSnapshot& snapshot);
+
+  /** Resources which are only needed for rendering
+   *
+   * These are not created when running without a renderer (headless mode).
+   */
+  struct RenderResources
+  {
+    RenderResources(
+      renderer::Renderer* pRenderer,
+      const assets::ResourceLoader& resources,
+      const data::GameOptions* pOptions,
+      engine::SpriteFactory* pSpriteFactory,
+      int levelNumber);
+
+    engine::TiledTexture mUiSpriteSheet;
+    ui::MenuElementRenderer mTextRenderer;
+    ui::HudRenderer mHudRenderer;
+    engine::SpecialEffectsRenderer mSpecialEffects;
+    renderer::RenderTargetTexture mLowResLayer;
   };
 
   renderer::Renderer* mpRenderer;
   IGameServiceProvider* mpServiceProvider;
-  engine::TiledTexture mUiSpriteSheet;
-  ui::MenuElementRenderer mTextRenderer;
   data::PersistentPlayerState* mpPersistentPlayerState;
   const data::GameOptions* mpOptions;
   const assets::ResourceLoader* mpResources;
@@ -169,10 +213,8 @@ private:
   data::GameSessionId mSessionId;
 
   data::PersistentPlayerState mPlayerModelAtLevelStart;
-  ui::HudRenderer mHudRenderer;
+  std::unique_ptr<RenderResources> mpRenderResources;
   ui::IngameMessageDisplay mMessageDisplay;
-  engine::SpecialEffectsRenderer mSpecialEffects;
-  renderer::RenderTargetTexture mLowResLayer;
   base::Size mPreviousWindowSize;
   data::WidescreenHudStyle mPreviousHudStyle;
   bool mWidescreenModeWasOn;
@@ -181,6 +223,9 @@ private:
 
   std::unique_ptr<WorldState> mpState;
   std::unique_ptr<QuickSaveData> mpQuickSave;
+  RewindHistory mRewindHistory;
+  std::deque<std::unique_ptr<WorldStateSnapshot>> mRewindSnapshots;
+  std::vector<std::uint8_t> mRewindStateBuffer;
 };
 
 } // namespace rigel::game_logic
@@ -16,6 +16,7 @@
 
 #include "item_container.hpp"
 
+#include "base/profiler.hpp"
 #include "data/sound_ids.hpp"
 #include "engine/base_components.hpp"
 #include "engine/collision_checker.hpp"
@@ -63,6 +64,8 @@ ItemContainerSystem::ItemContainerSystem(
 
 void ItemContainerSystem::update(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("ItemContainerSystem::update");
+
   using RS = ItemContainer::ReleaseStyle;
 
   auto releaseItem =
@@ -148,6 +151,8 @@ void ItemContainerSystem::update(entityx::EntityManager& es)
 
 void ItemContainerSystem::updateItemBounce(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("ItemContainerSystem::updateItemBounce");
+
   es.each<WorldPosition, BoundingBox, MovingBody, ItemBounceEffect>(
     [this](
       entityx::Entity entity,
@@ -18,6 +18,7 @@
 
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
+#include "engine/collision_checker.hpp"
 #include "engine/entity_tools.hpp"
 #include "engine/physical_components.hpp"
 #include "engine/visual_components.hpp"
@@ -123,6 +124,8 @@ void HorizontalSlidingDoor::update(
     boundingBox.size.width = 1;
   }
 
+  d.mpCollisionChecker->updateSolidBody(entity);
+
   const auto missingLeftEdgeCollision =
     previousState == State::Closed && mState == State::HalfOpen;
   engine::setTag<SolidBody>(mCollisionHelper, !missingLeftEdgeCollision);
@@ -248,6 +251,8 @@ void VerticalSlidingDoor::update(
     boundingBox.size.height = 1;
   }
 
+  d.mpCollisionChecker->updateSolidBody(entity);
+
   if (inRange != mPlayerWasInRange)
   {
     d.mpServiceProvider->playSound(data::SoundId::SlidingDoor);
@@ -18,6 +18,7 @@
 
 #include "base/match.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "data/map.hpp"
@@ -583,6 +584,8 @@ void Player::endBeingPushedByFan()
 
 void Player::update(const PlayerInput& unfilteredInput)
 {
+  RIGEL_PROFILE_SCOPE("Player::update");
+
   using namespace engine;
 
   updateTemporaryItemExpiration();
@@ -16,6 +16,7 @@
 
 #include "damage_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/player_model.hpp"
 #include "engine/base_components.hpp"
 #include "engine/physical_components.hpp"
@@ -42,6 +43,8 @@ DamageSystem::DamageSystem(Player* pPlayer)
 
 void DamageSystem::update(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("player::DamageSystem::update");
+
   if (mpPlayer->isDead())
   {
     return;
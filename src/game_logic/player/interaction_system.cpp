@@ -17,6 +17,7 @@
 #include "interaction_system.hpp"
 
 #include "assets/resource_loader.hpp"
+#include "base/profiler.hpp"
 #include "data/strings.hpp"
 #include "engine/physics_system.hpp"
 #include "engine/visual_components.hpp"
@@ -230,6 +231,8 @@ void PlayerInteractionSystem::updatePlayerInteraction(
   const PlayerInput& input,
   entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("PlayerInteractionSystem::updatePlayerInteraction");
+
   if (mpPlayer->isDead())
   {
     return;
@@ -254,6 +257,8 @@ void PlayerInteractionSystem::updatePlayerInteraction(
 
 void PlayerInteractionSystem::updateItemCollection(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("PlayerInteractionSystem::updateItemCollection");
+
   if (mpPlayer->isDead())
   {
     return;
@@ -16,6 +16,7 @@
 
 #include "projectile_system.hpp"
 
+#include "base/profiler.hpp"
 #include "data/map.hpp"
 #include "engine/collision_checker.hpp"
 #include "engine/entity_tools.hpp"
@@ -150,6 +151,8 @@ ProjectileSystem::ProjectileSystem(
 
 void ProjectileSystem::update(entityx::EntityManager& es)
 {
+  RIGEL_PROFILE_SCOPE("ProjectileSystem::update");
+
   using namespace engine::components;
   using namespace game_logic::components;
 
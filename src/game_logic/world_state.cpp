@@ -32,6 +32,8 @@
 #include "game_logic/interactive/item_container.hpp"
 #include "renderer/renderer.hpp"
 
+#include <utility>
+
 
 namespace rigel::game_logic
 {
@@ -95,6 +97,72 @@ void copyAllComponents(entityx::Entity from, entityx::Entity to)
   assert(from.component_mask() == to.component_mask());
 }
 
+
+/** Clone all entities into another, empty, entity manager
+ *
+ * Returns the clones of the given player and boss entities.
+ */
+std::pair<entityx::Entity, entityx::Entity> cloneEntities(
+  const entityx::EntityManager& source,
+  entityx::EntityManager& target,
+  const entityx::Entity& playerEntity,
+  const entityx::Entity& bossEntity)
+{
+  auto playerClone = entityx::Entity{};
+  auto bossClone = entityx::Entity{};
+
+  // clang-format off
+  for (
+    const auto entity :
+      const_cast<entityx::EntityManager&>(source).entities_for_debugging())
+  // clang-format on
+  {
+    auto clone = target.create();
+
+    copyAllComponents(entity, clone);
+
+    if (entity == playerEntity)
+    {
+      playerClone = clone;
+    }
+
+    if (entity == bossEntity)
+    {
+      bossClone = clone;
+    }
+  }
+
+  return {playerClone, bossClone};
+}
+
+
+/** Copy members which WorldState and WorldStateSnapshot have in common
+ *
+ * Only covers plain values, everything referring to other parts of the state
+ * (like entities) needs to be handled separately.
+ */
+template <typename Source, typename Target>
+void copyPlainState(const Source& source, Target& target)
+{
+  target.mBonusInfo = source.mBonusInfo;
+  target.mLevelMusicFile = source.mLevelMusicFile;
+  target.mActivatedCheckpoint = source.mActivatedCheckpoint;
+  target.mScreenFlashColor = source.mScreenFlashColor;
+  target.mBackdropFlashColor = source.mBackdropFlashColor;
+  target.mTeleportTargetPosition = source.mTeleportTargetPosition;
+  target.mCloakPickupPosition = source.mCloakPickupPosition;
+  target.mBossStartingHealth = source.mBossStartingHealth;
+  target.mReactorDestructionFramesElapsed =
+    source.mReactorDestructionFramesElapsed;
+  target.mScreenShakeOffsetX = source.mScreenShakeOffsetX;
+  target.mBossDeathAnimationStartPending =
+    source.mBossDeathAnimationStartPending;
+  target.mBackdropSwitched = source.mBackdropSwitched;
+  target.mLevelFinished = source.mLevelFinished;
+  target.mPlayerDied = source.mPlayerDied;
+  target.mIsOddFrame = source.mIsOddFrame;
+}
+
 } // namespace
 
 
@@ -141,9 +209,8 @@ WorldState::WorldState(
       pOptions,
       pSpriteFactory,
       sessionId,
-      assets::loadLevel(
+      pResources->loadLevel(
         assets::levelFileName(sessionId.mEpisode, sessionId.mLevel),
-        *pResources,
         sessionId.mDifficulty))
 {
 }
@@ -193,6 +260,7 @@ WorldState::WorldState(
       sessionId.mDifficulty)
   , mRadarDishCounter(mEntities, mEventManager)
   , mCollisionChecker(&mMap, mEntities, mEventManager)
+  , mEntityActivationSystem(&mMap, mEntities, mEventManager)
   , mpOptions(pOptions)
   , mPlayer(
       [&]() {
@@ -218,16 +286,36 @@ WorldState::WorldState(
       &mRandomGenerator)
   , mCamera(&mPlayer, mMap, mEventManager)
   , mParticles(&mRandomGenerator, pRenderer)
-  , mSpriteRenderingSystem(pRenderer, &pSpriteFactory->textureAtlas())
-  , mMapRenderer(
+  , mSpriteRenderingSystem(
+      [&]() -> std::optional<engine::SpriteRenderingSystem> {
+        if (!pRenderer)
+        {
+          return std::nullopt;
+        }
+
+        return std::optional<engine::SpriteRenderingSystem>{
+          std::in_place, pRenderer, &pSpriteFactory->textureAtlas()};
+      }())
+  , mMapStaticParts(
+      pRenderer ? std::move(dynamicMapSections.mMapStaticParts)
+                : data::map::Map{})
+  , mMapRenderer([&]() -> std::optional<engine::MapRenderer> {
+    if (!pRenderer)
+    {
+      return std::nullopt;
+    }
+
+    return std::optional<engine::MapRenderer>{
+      std::in_place,
       pRenderer,
-      std::move(dynamicMapSections.mMapStaticParts),
+      mMapStaticParts,
       &mMap.attributeDict(),
       engine::MapRenderer::MapRenderData{
         std::move(loadedLevel.mTileSetImage),
         std::move(loadedLevel.mBackdropImage),
         std::move(loadedLevel.mSecondaryBackdropImage),
-        loadedLevel.mBackdropScrollMode})
+        loadedLevel.mBackdropScrollMode}};
+  }())
   , mPhysicsSystem(&mCollisionChecker, &mMap, &mEventManager)
   , mDebuggingSystem(pRenderer, &mMap)
   , mPlayerInteractionSystem(
@@ -255,7 +343,7 @@ WorldState::WorldState(
       &mMap,
       &mRandomGenerator,
       &mEventManager,
-      &mMapRenderer,
+      mMapRenderer ? &*mMapRenderer : nullptr,
       std::move(dynamicMapSections.mSimpleSections))
   , mEffectsSystem(
       pServiceProvider,
@@ -299,44 +387,37 @@ WorldState::WorldState(
 }
 
 
-void WorldState::synchronizeTo(
-  const WorldState& other,
+void WorldState::restoreFromSnapshot(
+  const WorldStateSnapshot& snapshot,
   IGameServiceProvider* pServiceProvider,
   data::PersistentPlayerState* pPersistentPlayerState,
   const data::GameSessionId sessionId)
 {
-  if (mBackdropSwitched != other.mBackdropSwitched)
+  if (mMapRenderer && mBackdropSwitched != snapshot.mBackdropSwitched)
+  {
+    mMapRenderer->switchBackdrops();
+  }
+
+  copyPlainState(snapshot, *this);
+
+  if (snapshot.mIncludesMap)
   {
-    mMapRenderer.switchBackdrops();
+    mMap = snapshot.mMap;
   }
 
-  mBonusInfo = other.mBonusInfo;
-  mLevelMusicFile = other.mLevelMusicFile;
-  mActivatedCheckpoint = other.mActivatedCheckpoint;
-  mScreenFlashColor = other.mScreenFlashColor;
-  mBackdropFlashColor = other.mBackdropFlashColor;
-  mTeleportTargetPosition = other.mTeleportTargetPosition;
-  mCloakPickupPosition = other.mCloakPickupPosition;
-  mBossStartingHealth = other.mBossStartingHealth;
-  mReactorDestructionFramesElapsed = other.mReactorDestructionFramesElapsed;
-  mScreenShakeOffsetX = other.mScreenShakeOffsetX;
-  mBossDeathAnimationStartPending = other.mBossDeathAnimationStartPending;
-  mBackdropSwitched = other.mBackdropSwitched;
-  mLevelFinished = other.mLevelFinished;
-  mPlayerDied = other.mPlayerDied;
-  mIsOddFrame = other.mIsOddFrame;
-
-  mMap = other.mMap;
-  mRandomGenerator = other.mRandomGenerator;
-  mCamera.synchronizeTo(other.mCamera);
-  mParticles.synchronizeTo(other.mParticles);
-  mMapRenderer.synchronizeTo(other.mMapRenderer);
-
-  if (other.mEarthQuakeEffect)
+  mRandomGenerator = snapshot.mRandomGenerator;
+  mCamera.synchronizeTo(snapshot.mCamera);
+  mParticles.synchronizeTo(snapshot.mParticles);
+  if (mMapRenderer && snapshot.mMapAnimationState)
+  {
+    mMapRenderer->setAnimationState(*snapshot.mMapAnimationState);
+  }
+
+  if (snapshot.mEarthQuakeEffect)
   {
     mEarthQuakeEffect =
       EarthQuakeEffect{pServiceProvider, &mRandomGenerator, &mEventManager};
-    mEarthQuakeEffect->synchronizeTo(*other.mEarthQuakeEffect);
+    mEarthQuakeEffect->synchronizeTo(*snapshot.mEarthQuakeEffect);
   }
   else
   {
@@ -345,43 +426,76 @@ void WorldState::synchronizeTo(
 
   mEntities.reset();
 
-  entityx::Entity playerEntity;
+  const auto [playerEntity, bossEntity] = cloneEntities(
+    snapshot.mEntities,
+    mEntities,
+    snapshot.mPlayer.entity(),
+    snapshot.mActiveBossEntity);
+  mActiveBossEntity = bossEntity;
+
+  mPlayer = Player{
+    playerEntity,
+    sessionId.mDifficulty,
+    pPersistentPlayerState,
+    pServiceProvider,
+    mpOptions,
+    &mCollisionChecker,
+    &mMap,
+    &mEntityFactory,
+    &mEventManager,
+    &mRandomGenerator};
+  mPlayer.synchronizeTo(snapshot.mPlayer, mEntities);
+}
 
-  // clang-format off
-  for (
-    const auto entity :
-      const_cast<entityx::EntityManager&>(other.mEntities)
-        .entities_for_debugging())
-  // clang-format on
-  {
-    auto clone = mEntities.create();
 
-    copyAllComponents(entity, clone);
+WorldStateSnapshot::WorldStateSnapshot(
+  const WorldState& state,
+  const data::GameSessionId sessionId,
+  const SnapshotMapHandling mapHandling)
+  : mMap(
+      mapHandling == SnapshotMapHandling::Include ? state.mMap
+                                                  : data::map::Map{})
+  , mIncludesMap(mapHandling == SnapshotMapHandling::Include)
+  , mEntities(mEventManager)
+  , mRandomGenerator(state.mRandomGenerator)
+  , mPlayer(
+      [&]() {
+        const auto [playerEntity, bossEntity] = cloneEntities(
+          state.mEntities,
+          mEntities,
+          state.mPlayer.entity(),
+          state.mActiveBossEntity);
+        mActiveBossEntity = bossEntity;
+        return playerEntity;
+      }(),
+      sessionId.mDifficulty,
+      nullptr,
+      nullptr,
+      state.mpOptions,
+      nullptr,
+      &mMap,
+      nullptr,
+      &mEventManager,
+      &mRandomGenerator)
+  , mCamera(&mPlayer, mMap, mEventManager)
+  , mParticles(&mRandomGenerator, nullptr)
+{
+  copyPlainState(state, *this);
 
-    if (entity == other.mPlayer.entity())
-    {
-      playerEntity = clone;
-    }
+  mPlayer.synchronizeTo(state.mPlayer, mEntities);
+  mCamera.synchronizeTo(state.mCamera);
+  mParticles.synchronizeTo(state.mParticles);
 
-    if (entity == other.mActiveBossEntity)
-    {
-      mActiveBossEntity = clone;
-    }
+  if (state.mMapRenderer)
+  {
+    mMapAnimationState = state.mMapRenderer->animationState();
   }
 
+  if (state.mEarthQuakeEffect)
   {
-    mPlayer = Player{
-      playerEntity,
-      sessionId.mDifficulty,
-      pPersistentPlayerState,
-      pServiceProvider,
-      mpOptions,
-      &mCollisionChecker,
-      &mMap,
-      &mEntityFactory,
-      &mEventManager,
-      &mRandomGenerator};
-    mPlayer.synchronizeTo(other.mPlayer, mEntities);
+    mEarthQuakeEffect =
+      EarthQuakeEffect{nullptr, &mRandomGenerator, &mEventManager};
+    mEarthQuakeEffect->synchronizeTo(*state.mEarthQuakeEffect);
   }
 }
 
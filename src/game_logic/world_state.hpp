@@ -49,6 +49,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <optional>
 #include <string>
 
 
@@ -109,6 +110,15 @@ struct CheckpointData
 };
 
 
+struct WorldStateSnapshot;
+
+
+/** Complete state of a running level
+ *
+ * The renderer may be null, which gives a headless world state that can only
+ * be used for updating game logic. In that case, the sprite rendering system
+ * and map renderer are not created.
+ */
 struct WorldState
 {
   WorldState(
@@ -139,8 +149,13 @@ struct WorldState
     DynamicMapSectionData&& dynamicMapSections,
     data::map::LevelData&& loadedLevel);
 
-  void synchronizeTo(
-    const WorldState& other,
+  /** Replace simulation state with the one stored in the given snapshot
+   *
+   * The snapshot must have been taken from a state for the same level.
+   * If it doesn't include the map, the current map is left as is.
+   */
+  void restoreFromSnapshot(
+    const WorldStateSnapshot& snapshot,
     IGameServiceProvider* pServiceProvider,
     data::PersistentPlayerState* pPersistentPlayerState,
     data::GameSessionId sessionId);
@@ -153,14 +168,19 @@ struct WorldState
   EntityFactory mEntityFactory;
   RadarDishCounter mRadarDishCounter;
   engine::CollisionChecker mCollisionChecker;
+  engine::EntityActivationSystem mEntityActivationSystem;
   const data::GameOptions* mpOptions;
 
   Player mPlayer;
   Camera mCamera;
   base::Vec2 mPreviousCameraPosition;
   engine::ParticleSystem mParticles;
-  engine::SpriteRenderingSystem mSpriteRenderingSystem;
-  engine::MapRenderer mMapRenderer;
+  std::optional<engine::SpriteRenderingSystem> mSpriteRenderingSystem;
+
+  // The parts of the map that the map renderer draws, i.e. without dynamic
+  // geometry. Empty in headless mode.
+  data::map::Map mMapStaticParts;
+  std::optional<engine::MapRenderer> mMapRenderer;
   engine::PhysicsSystem mPhysicsSystem;
   engine::LifeTimeSystem mLifeTimeSystem;
   game_logic::DebuggingSystem mDebuggingSystem;
@@ -194,4 +214,67 @@ struct WorldState
   bool mIsOddFrame = true;
 };
 
+
+/** Determines whether a WorldStateSnapshot contains the map
+ *
+ * Rewinding stores the map's tiles separately, in delta-encoded form, and
+ * thus doesn't need a copy of the map in each snapshot.
+ */
+enum class SnapshotMapHandling
+{
+  Include,
+  Exclude
+};
+
+
+/** Copy of a WorldState's simulation state, used for quick saving
+ *
+ * In contrast to a full WorldState, creating a snapshot doesn't load the level
+ * from disk, and doesn't create any rendering resources or game logic systems.
+ * Entities are cloned into the snapshot's own entity manager. The player,
+ * camera, particles and earth quake effect only serve as storage here, they
+ * are never updated.
+ */
+struct WorldStateSnapshot
+{
+  WorldStateSnapshot(
+    const WorldState& state,
+    data::GameSessionId sessionId,
+    SnapshotMapHandling mapHandling = SnapshotMapHandling::Include);
+
+  WorldStateSnapshot(const WorldStateSnapshot&) = delete;
+  WorldStateSnapshot& operator=(const WorldStateSnapshot&) = delete;
+
+  /** Empty if the snapshot was created with SnapshotMapHandling::Exclude */
+  data::map::Map mMap;
+  bool mIncludesMap;
+
+  entityx::EventManager mEventManager;
+  entityx::EntityManager mEntities;
+  engine::RandomNumberGenerator mRandomGenerator;
+  entityx::Entity mActiveBossEntity;
+
+  Player mPlayer;
+  Camera mCamera;
+  engine::ParticleSystem mParticles;
+  std::optional<EarthQuakeEffect> mEarthQuakeEffect;
+  std::optional<engine::MapRenderer::AnimationState> mMapAnimationState;
+
+  LevelBonusInfo mBonusInfo;
+  std::string mLevelMusicFile;
+  std::optional<CheckpointData> mActivatedCheckpoint;
+  std::optional<base::Color> mScreenFlashColor;
+  std::optional<base::Color> mBackdropFlashColor;
+  std::optional<base::Vec2> mTeleportTargetPosition;
+  std::optional<base::Vec2> mCloakPickupPosition;
+  int mBossStartingHealth = 0;
+  std::optional<int> mReactorDestructionFramesElapsed;
+  int mScreenShakeOffsetX = 0;
+  bool mBossDeathAnimationStartPending = false;
+  bool mBackdropSwitched = false;
+  bool mLevelFinished = false;
+  bool mPlayerDied = false;
+  bool mIsOddFrame = true;
+};
+
 } // namespace rigel::game_logic
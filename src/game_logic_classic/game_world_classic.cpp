@@ -18,7 +18,9 @@
 
 #include "assets/file_utils.hpp"
 #include "assets/resource_loader.hpp"
+#include "base/profiler.hpp"
 #include "base/spatial_types_printing.hpp"
+#include "base/state_hasher.hpp"
 #include "base/string_utils.hpp"
 #include "base/warnings.hpp"
 #include "data/strings.hpp"
@@ -35,6 +37,10 @@
 
 #include <loguru.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
 
 using namespace rigel;
 using rigel::game_logic::detail::Bridge;
@@ -196,7 +202,10 @@ void Map_SetTile(Context* ctx, word tileIndex, word x, word y)
       getBridge(ctx).mpMap->setTileAt(1, x, y, 0);
     }
 
-    getBridge(ctx).mpMapRenderer->markAsChanged({x, y});
+    if (getBridge(ctx).mpMapRenderer)
+    {
+      getBridge(ctx).mpMapRenderer->markAsChanged({x, y});
+    }
   }
 }
 
@@ -377,6 +386,163 @@ std::unique_ptr<State> createState(
   return pState;
 }
 
+
+template <typename T, std::size_t N>
+void addArrayToHash(base::StateHasher& hasher, const T (&array)[N])
+{
+  hasher.addBytes(array, sizeof(array));
+}
+
+
+void addToHash(base::StateHasher& hasher, const ActorState& actor)
+{
+  hasher.add(actor.id);
+  hasher.add(actor.frame);
+  hasher.add(actor.x);
+  hasher.add(actor.y);
+  hasher.add(bool(actor.alwaysUpdate));
+  hasher.add(bool(actor.remainActive));
+  hasher.add(bool(actor.allowStairStepping));
+  hasher.add(bool(actor.gravityAffected));
+  hasher.add(bool(actor.deleted));
+  hasher.add(actor.gravityState);
+  hasher.add(actor.drawStyle);
+  hasher.add(actor.health);
+  hasher.add(actor.var1);
+  hasher.add(actor.var2);
+  hasher.add(actor.var3);
+  hasher.add(actor.var4);
+  hasher.add(actor.var5);
+  hasher.add(actor.tileBuffer != nullptr);
+  hasher.add(actor.scoreGiven);
+}
+
+
+/** Hash all game state in the given context
+ *
+ * Pointers are left out, since their values differ between runs. Buffers
+ * allocated by the memory manager are covered by hashing the used part of
+ * mmRawMem. We go member by member instead of hashing the whole struct, so
+ * that padding bytes don't influence the result.
+ */
+void addToHash(base::StateHasher& hasher, const State& s)
+{
+  hasher.add(s.sysTecMode);
+  hasher.add(s.retConveyorBeltCheckResult);
+  hasher.add(s.mapViewportHeight);
+  hasher.add(s.gfxFlashScreen);
+  hasher.add(s.gfxScreenFlashColor);
+  hasher.add(s.gmIsTeleporting);
+  hasher.add(s.plCollectedLetters);
+  hasher.add(s.gmTeleportTargetPosX);
+  hasher.add(s.gmTeleportTargetPosY);
+  hasher.add(s.retPlayerShotDirection);
+  hasher.add(s.gmPlayerTookDamage);
+  hasher.add(s.mapBottom);
+  hasher.add(s.mapWidthShift);
+  hasher.add(s.mapWidth);
+  hasher.add(s.gmCameraPosX);
+  hasher.add(s.gmCameraPosY);
+  addArrayToHash(hasher, s.gmTileDebrisStates);
+  hasher.add(s.gmNumActors);
+  hasher.add(s.gmBossActivated);
+  hasher.add(s.plRapidFireIsActiveFrame);
+  hasher.add(s.gmRequestUnlockNextDoor);
+  hasher.add(s.gmCurrentEpisode);
+  hasher.add(s.gmCurrentLevel);
+
+  for (auto i = 0; i < s.gmNumActors; ++i)
+  {
+    addToHash(hasher, s.gmActorStates[i]);
+  }
+
+  hasher.add(s.levelActorListSize);
+  hasher.add(s.gfxCurrentDisplayPage);
+  hasher.add(s.gmGameState);
+  addArrayToHash(hasher, s.gmEffectStates);
+  addArrayToHash(hasher, s.gmPlayerShotStates);
+  hasher.add(s.inputMoveUp);
+  hasher.add(s.inputMoveDown);
+  hasher.add(s.inputMoveLeft);
+  hasher.add(s.inputMoveRight);
+  hasher.add(s.inputJump);
+  hasher.add(s.inputFire);
+  hasher.add(s.plRapidFireTimeLeft);
+  hasher.add(s.plScore);
+  hasher.add(s.mapParallaxHorizontal);
+  hasher.add(s.mapHasReactorDestructionEvent);
+  hasher.add(s.mapSwitchBackdropOnTeleport);
+  hasher.add(s.gmRngIndex);
+  hasher.add(s.plOnElevator);
+  hasher.add(s.plAirlockDeathStep);
+  hasher.add(s.plBodyExplosionStep);
+  hasher.add(s.plFallingSpeed);
+  hasher.add(s.plDeathAnimationStep);
+  hasher.add(s.plState);
+  hasher.add(s.plJumpStep);
+  hasher.add(s.plMercyFramesLeft);
+  hasher.add(s.plPosX);
+  hasher.add(s.plPosY);
+  hasher.add(s.gmBeaconPosX);
+  hasher.add(s.gmBeaconPosY);
+  hasher.add(s.plActorId);
+  hasher.add(s.plAnimationFrame);
+  hasher.add(s.plKilledInShip);
+  hasher.add(s.gmPlayerEatingActor);
+  hasher.add(s.gmRequestUnlockNextForceField);
+  hasher.add(s.plInteractAnimTicks);
+  hasher.add(s.plBlockLookingUp);
+  hasher.add(s.mapHasEarthquake);
+  hasher.add(s.gmEarthquakeCountdown);
+  hasher.add(s.gmEarthquakeThreshold);
+  hasher.add(s.gmReactorDestructionStep);
+  hasher.add(s.gmNumMovingMapParts);
+  hasher.add(s.plCloakTimeLeft);
+  addArrayToHash(hasher, s.gmMovingMapParts);
+  hasher.add(s.gmCamerasDestroyed);
+  hasher.add(s.gmCamerasInLevel);
+  hasher.add(s.gmWeaponsCollected);
+  hasher.add(s.gmWeaponsInLevel);
+  hasher.add(s.gmMerchCollected);
+  hasher.add(s.gmMerchInLevel);
+  hasher.add(s.gmTurretsDestroyed);
+  hasher.add(s.gmTurretsInLevel);
+  hasher.add(s.gmOrbsLeft);
+  hasher.add(s.gmBombBoxesLeft);
+  hasher.add(s.plAttachedSpider1);
+  hasher.add(s.plAttachedSpider2);
+  hasher.add(s.plAttachedSpider3);
+  hasher.add(s.gmBossHealth);
+  hasher.add(s.gmBossStartingHealth);
+  hasher.add(s.gmRadarDishesLeft);
+  hasher.add(s.gmCloakPickupPosX);
+  hasher.add(s.gmCloakPickupPosY);
+  hasher.add(s.gmExplodingSectionLeft);
+  hasher.add(s.gmExplodingSectionTop);
+  hasher.add(s.gmExplodingSectionRight);
+  hasher.add(s.gmExplodingSectionBottom);
+  hasher.add(s.gmExplodingSectionTicksElapsed);
+  hasher.add(s.gmActiveFanIndex);
+  hasher.add(s.plBlockJumping);
+  hasher.add(s.plWalkAnimTicksDue);
+  hasher.add(s.plBlockShooting);
+  addArrayToHash(hasher, s.levelHeaderData);
+  addArrayToHash(hasher, s.mmChunkSizes);
+  addArrayToHash(hasher, s.mmChunkTypes);
+  hasher.add(s.mmMemTotal);
+  hasher.add(s.mmMemUsed);
+  hasher.add(s.mmChunksUsed);
+  addArrayToHash(hasher, s.psParticleGroups);
+  hasher.add(s.bdUseSecondary);
+  hasher.add(s.gmDifficulty);
+  hasher.add(s.plWeapon);
+  hasher.add(s.plAmmo);
+  hasher.add(s.plHealth);
+  hasher.add(s.gmBeaconActivated);
+  hasher.addBytes(
+    s.mmRawMem, std::min<std::size_t>(s.mmMemUsed, sizeof(s.mmRawMem)));
+}
+
 } // namespace
 
 
@@ -423,6 +589,34 @@ struct GameWorld_Classic::QuickSaveData
 };
 
 
+GameWorld_Classic::RenderResources::RenderResources(
+  renderer::Renderer* pRenderer,
+  const assets::ResourceLoader& resources,
+  const data::GameOptions* pOptions,
+  engine::SpriteFactory* pSpriteFactory,
+  const std::optional<int> levelNumber)
+  : mUiSpriteSheet(
+      renderer::Texture{pRenderer, resources.loadUiSpriteSheet()},
+      data::GameTraits::viewportSize,
+      pRenderer)
+  , mTextRenderer(&mUiSpriteSheet, pRenderer, resources)
+  , mHudRenderer(
+      levelNumber,
+      pOptions,
+      pRenderer,
+      &mUiSpriteSheet,
+      renderer::Texture{pRenderer, resources.loadWideHudFrameImage()},
+      renderer::Texture{pRenderer, resources.loadUltrawideHudFrameImage()},
+      pSpriteFactory)
+  , mSpecialEffects(pRenderer, *pOptions)
+  , mLowResLayer(
+      pRenderer,
+      data::GameTraits::viewportWidthPx,
+      data::GameTraits::viewportHeightPx)
+{
+}
+
+
 GameWorld_Classic::GameWorld_Classic(
   data::PersistentPlayerState* pPersistentPlayerState,
   const data::GameSessionId& sessionId,
@@ -432,11 +626,6 @@ GameWorld_Classic::GameWorld_Classic(
   const PlayerInput& initialInput)
   : mpRenderer(context.mpRenderer)
   , mpServiceProvider(context.mpServiceProvider)
-  , mUiSpriteSheet(
-      renderer::Texture{mpRenderer, context.mpResources->loadUiSpriteSheet()},
-      data::GameTraits::viewportSize,
-      mpRenderer)
-  , mTextRenderer(&mUiSpriteSheet, mpRenderer, *context.mpResources)
   , mpPersistentPlayerState(pPersistentPlayerState)
   , mpOptions(&context.mpUserProfile->mOptions)
   , mpResources(context.mpResources)
@@ -444,26 +633,20 @@ GameWorld_Classic::GameWorld_Classic(
   , mImageIdTable(engine::buildImageIdTable(*context.mpResources))
   , mSessionId(sessionId)
   , mPlayerModelAtLevelStart(*mpPersistentPlayerState)
-  , mHudRenderer(
-      sessionId.mIsDemo ? std::nullopt
-                        : std::make_optional(sessionId.mLevel + 1),
-      mpOptions,
-      mpRenderer,
-      &mUiSpriteSheet,
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadWideHudFrameImage()},
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadUltrawideHudFrameImage()},
-      mpSpriteFactory)
-  , mMessageDisplay(mpServiceProvider, &mTextRenderer)
-  , mSpecialEffects(mpRenderer, *mpOptions)
-  , mLowResLayer(
-      mpRenderer,
-      data::GameTraits::viewportWidthPx,
-      data::GameTraits::viewportHeightPx)
-  , mPreviousWindowSize(mpRenderer->windowSize())
+  , mpRenderResources(
+      mpRenderer ? std::make_unique<RenderResources>(
+                     mpRenderer,
+                     *context.mpResources,
+                     mpOptions,
+                     mpSpriteFactory,
+                     sessionId.mIsDemo
+                       ? std::nullopt
+                       : std::make_optional(sessionId.mLevel + 1))
+                 : nullptr)
+  , mMessageDisplay(
+      mpServiceProvider,
+      mpRenderResources ? &mpRenderResources->mTextRenderer : nullptr)
+  , mPreviousWindowSize(mpRenderer ? mpRenderer->windowSize() : base::Size{})
   , mPerElementUpscalingWasEnabled(mpOptions->mPerElementUpscalingEnabled)
   , mBridge(
       *context.mpResources,
@@ -476,6 +659,7 @@ GameWorld_Classic::GameWorld_Classic(
       *context.mpResources,
       *mpPersistentPlayerState,
       &mBridge))
+  , mRewindHistory(REWIND_HISTORY_LENGTH)
 {
   LOG_SCOPE_FUNCTION(INFO);
 
@@ -577,14 +761,25 @@ std::set<data::Bonus> GameWorld_Classic::achievedBonuses() const
 
 bool GameWorld_Classic::needsPerElementUpscaling() const
 {
+  if (!mpRenderResources)
+  {
+    return false;
+  }
+
   return mpSpriteFactory->hasHighResReplacements() ||
-    mMapRenderer->hasHighResReplacements() || mUiSpriteSheet.isHighRes();
+    mMapRenderer->hasHighResReplacements() ||
+    mpRenderResources->mUiSpriteSheet.isHighRes();
 }
 
 
 void GameWorld_Classic::updateGameLogic(const PlayerInput& input)
 {
-  mMapRenderer->updateAnimatedMapTiles();
+  RIGEL_PROFILE_SCOPE("GameWorld_Classic::updateGameLogic");
+
+  if (mMapRenderer)
+  {
+    mMapRenderer->updateAnimatedMapTiles();
+  }
 
   mBridge.resetForNewFrame();
 
@@ -601,7 +796,11 @@ void GameWorld_Classic::updateGameLogic(const PlayerInput& input)
     throw std::runtime_error(mBridge.mpErrorMessage);
   }
 
-  mHudRenderer.updateAnimation();
+  if (mpRenderResources)
+  {
+    mpRenderResources->mHudRenderer.updateAnimation();
+  }
+
   mMessageDisplay.update();
 
   // When teleporting, we don't want to sync the backdrop here, since that would
@@ -625,12 +824,27 @@ void GameWorld_Classic::updateGameLogic(const PlayerInput& input)
     mpServiceProvider->playMusic(mMusicFile);
   }
 
-  mMapRenderer->rebuildChangedBlocks(mMap);
+  if (mMapRenderer)
+  {
+    mMapRenderer->rebuildChangedBlocks(
+      mMap,
+      {{mpState->gmCameraPosX, mpState->gmCameraPosY},
+       data::GameTraits::mapViewportSize});
+  }
 }
 
 
 void GameWorld_Classic::render(float)
 {
+  RIGEL_PROFILE_SCOPE("GameWorld_Classic::render");
+
+  if (!mpRenderResources)
+  {
+    return;
+  }
+
+  auto& resources = *mpRenderResources;
+
   auto drawTopRow = [&]() {
     if (mpState->gmBossActivated)
     {
@@ -638,8 +852,8 @@ void GameWorld_Classic::render(float)
         mpState->gmBossHealth,
         mpState->gmBossStartingHealth,
         data::GameTraits::inGameViewportSize.width,
-        mTextRenderer,
-        mUiSpriteSheet);
+        resources.mTextRenderer,
+        resources.mUiSpriteSheet);
     }
     else
     {
@@ -652,14 +866,15 @@ void GameWorld_Classic::render(float)
     mpOptions->mPerElementUpscalingEnabled != mPerElementUpscalingWasEnabled ||
     mPreviousWindowSize != mpRenderer->windowSize())
   {
-    mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
+    resources.mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
   }
 
   {
     auto saved = setupIngameViewport(mpRenderer, mBridge.mScreenShift);
 
     drawWorld();
-    mHudRenderer.renderClassicHud(*mpPersistentPlayerState, mBridge.mRadarDots);
+    resources.mHudRenderer.renderClassicHud(
+      *mpPersistentPlayerState, mBridge.mRadarDots);
   }
 
   auto saved = renderer::saveState(mpRenderer);
@@ -701,12 +916,12 @@ void GameWorld_Classic::drawWorld()
     drawMapAndSprites(region);
 
     {
-      const auto saved = mLowResLayer.bindAndReset();
+      const auto saved = mpRenderResources->mLowResLayer.bindAndReset();
       mpRenderer->clear({0, 0, 0, 0});
       drawParticles();
     }
 
-    mLowResLayer.render(0, 0);
+    mpRenderResources->mLowResLayer.render(0, 0);
   }
   else
   {
@@ -720,6 +935,11 @@ void GameWorld_Classic::drawMapAndSprites(const base::Rect<int>& region)
 {
   using namespace detail;
 
+  auto& specialEffects = mpRenderResources->mSpecialEffects;
+
+  mMapRenderer->setSinglePassRenderingEnabled(
+    mpOptions->mSinglePassMapRendering, mMap);
+
   auto destRect = [&](const SpriteDrawCmd& request) {
     RIGEL_DISABLE_WARNINGS
 
@@ -754,7 +974,7 @@ void GameWorld_Classic::drawMapAndSprites(const base::Rect<int>& region)
     {
       const auto [textureId, texCoords] =
         mpSpriteFactory->textureAtlas().drawData(imageId);
-      mSpecialEffects.drawCloakEffect(textureId, texCoords, destRect(request));
+      specialEffects.drawCloakEffect(textureId, texCoords, destRect(request));
     }
     else
     {
@@ -831,12 +1051,12 @@ void GameWorld_Classic::drawMapAndSprites(const base::Rect<int>& region)
   else
   {
     {
-      auto saved = mSpecialEffects.bindBackgroundBuffer();
+      auto saved = specialEffects.bindBackgroundBuffer();
       drawBackdrop();
       drawBackgroundLayers();
     }
 
-    mSpecialEffects.drawBackgroundBuffer();
+    specialEffects.drawBackgroundBuffer();
 
     if (!mVisibleWaterAreas.empty())
     {
@@ -855,7 +1075,7 @@ void GameWorld_Classic::drawMapAndSprites(const base::Rect<int>& region)
         iFirstAnimatedArea != mBridge.mWaterAreasToDraw.end()
         ? iFirstAnimatedArea->animStep - 1
         : 0;
-      mSpecialEffects.drawWaterEffect(mVisibleWaterAreas, waterAnimStep);
+      specialEffects.drawWaterEffect(mVisibleWaterAreas, waterAnimStep);
     }
 
     drawForegroundLayers();
@@ -962,7 +1182,10 @@ void GameWorld_Classic::processEndOfFrameActions()
 
 void GameWorld_Classic::updateBackdropAutoScrolling(const engine::TimeDelta dt)
 {
-  mMapRenderer->updateBackdropAutoScrolling(dt);
+  if (mMapRenderer)
+  {
+    mMapRenderer->updateBackdropAutoScrolling(dt);
+  }
 }
 
 
@@ -1104,7 +1327,10 @@ void GameWorld_Classic::quickLoad()
   mMap = mpQuickSave->mMap;
   *mpState = mpQuickSave->mState;
 
-  mMapRenderer->rebuildAllBlocks(mMap);
+  if (mMapRenderer)
+  {
+    mMapRenderer->rebuildAllBlocks(mMap);
+  }
 
   syncBackdrop();
 
@@ -1121,6 +1347,55 @@ bool GameWorld_Classic::canQuickLoad() const
 }
 
 
+void GameWorld_Classic::recordRewindState()
+{
+  static_assert(std::is_trivially_copyable_v<State>);
+
+  // The state is a flat struct, and the map's tiles are plain arrays,
+  // so both can be stored as raw bytes. Pointers inside the state refer to
+  // its own memory (or to mBridge), and thus remain valid when restoring
+  // into the same object.
+  const auto pStateBytes = reinterpret_cast<const std::uint8_t*>(mpState.get());
+
+  mRewindStateBuffer.assign(pStateBytes, pStateBytes + sizeof(State));
+  appendMapTiles(mMap, mRewindStateBuffer);
+
+  // The inventory and tutorial messages are only tracked in the persistent
+  // player state, so that needs to be stored as well.
+  mRewindHistory.push(mRewindStateBuffer, *mpPersistentPlayerState);
+}
+
+
+bool GameWorld_Classic::rewind()
+{
+  if (mRewindHistory.empty())
+  {
+    return false;
+  }
+
+  const auto& bytes = mRewindHistory.newestState();
+  std::memcpy(mpState.get(), bytes.data(), sizeof(State));
+
+  // Only tiles that actually changed are touched, so that the map renderer
+  // just needs to rebuild the affected blocks
+  restoreMapTiles(
+    bytes.data() + sizeof(State), mMap, [this](const base::Vec2& position) {
+      if (mMapRenderer)
+      {
+        mMapRenderer->markAsChanged(position);
+      }
+    });
+
+  *mpPersistentPlayerState = mRewindHistory.newestPlayerState();
+  mRewindHistory.dropNewest();
+
+  syncBackdrop();
+  syncPlayerModel();
+
+  return true;
+}
+
+
 void GameWorld_Classic::printDebugText(std::ostream& stream) const
 {
   const auto cameraPos =
@@ -1182,6 +1457,27 @@ void GameWorld_Classic::printDebugText(std::ostream& stream) const
 }
 
 
+std::uint8_t GameWorld_Classic::randomNumberGeneratorState() const
+{
+  return mpState->gmRngIndex;
+}
+
+
+void GameWorld_Classic::setRandomNumberGeneratorState(const std::uint8_t state)
+{
+  mpState->gmRngIndex = state;
+}
+
+
+std::uint64_t GameWorld_Classic::stateHash() const
+{
+  base::StateHasher hasher;
+  addToHash(hasher, *mpState);
+  mMap.addToHash(hasher);
+  return hasher.value();
+}
+
+
 void GameWorld_Classic::loadLevel(const data::GameSessionId& sessionId)
 {
   {
@@ -1247,9 +1543,8 @@ void GameWorld_Classic::loadLevel(const data::GameSessionId& sessionId)
   // Now load the level file again using Rigel's functions, in order to get the
   // map data in the right format as needed by the MapRenderer. This also makes
   // it easier for us to parse the level flags.
-  const auto levelData = assets::loadLevel(
+  auto levelData = mpResources->loadLevel(
     assets::levelFileName(sessionId.mEpisode, sessionId.mLevel),
-    *mpResources,
     sessionId.mDifficulty);
 
   // SetMapSize() in the original code
@@ -1272,16 +1567,19 @@ void GameWorld_Classic::loadLevel(const data::GameSessionId& sessionId)
 
   mMap = std::move(levelData.mMap);
 
-  mMapRenderer.emplace(
-    mpRenderer,
-    mMap,
-    &mMap.attributeDict(),
-    engine::MapRenderer::MapRenderData{
-      std::move(levelData.mTileSetImage),
-      std::move(levelData.mBackdropImage),
-      std::move(levelData.mSecondaryBackdropImage),
-      levelData.mBackdropScrollMode});
-  mBridge.mpMapRenderer = &(*mMapRenderer);
+  if (mpRenderer)
+  {
+    mMapRenderer.emplace(
+      mpRenderer,
+      mMap,
+      &mMap.attributeDict(),
+      engine::MapRenderer::MapRenderData{
+        std::move(levelData.mTileSetImage),
+        std::move(levelData.mBackdropImage),
+        std::move(levelData.mSecondaryBackdropImage),
+        levelData.mBackdropScrollMode});
+    mBridge.mpMapRenderer = &(*mMapRenderer);
+  }
 
   mMusicFile = levelData.mMusicFile;
 
@@ -1302,7 +1600,11 @@ void GameWorld_Classic::syncBackdrop()
 {
   if (mpState->bdUseSecondary != mIsUsingSecondaryBackdrop)
   {
-    mMapRenderer->switchBackdrops();
+    if (mMapRenderer)
+    {
+      mMapRenderer->switchBackdrops();
+    }
+
     mIsUsingSecondaryBackdrop = mpState->bdUseSecondary;
   }
 }
@@ -30,6 +30,7 @@
 #include "frontend/game_mode.hpp"
 #include "game_logic_common/igame_world.hpp"
 #include "game_logic_common/input.hpp"
+#include "game_logic_common/rewind_history.hpp"
 #include "ui/hud_renderer.hpp"
 #include "ui/ingame_message_display.hpp"
 #include "ui/menu_element_renderer.hpp"
@@ -153,11 +154,18 @@ public:
   void quickLoad() override;
   bool canQuickLoad() const override;
 
+  void recordRewindState() override;
+  bool rewind() override;
+
   void debugToggleBoundingBoxDisplay() override { }
   void debugToggleWorldCollisionDataDisplay() override { }
   void debugToggleGridDisplay() override { }
   void printDebugText(std::ostream& stream) const override;
 
+  std::uint8_t randomNumberGeneratorState() const override;
+  void setRandomNumberGeneratorState(std::uint8_t state) override;
+  std::uint64_t stateHash() const override;
+
 private:
   void drawWorld();
   void drawMapAndSprites(const base::Rect<int>& region);
@@ -168,10 +176,28 @@ private:
 
   struct QuickSaveData;
 
+  /** Resources which are only needed for rendering
+   *
+   * These are not created when running without a renderer (headless mode).
+   */
+  struct RenderResources
+  {
+    RenderResources(
+      renderer::Renderer* pRenderer,
+      const assets::ResourceLoader& resources,
+      const data::GameOptions* pOptions,
+      engine::SpriteFactory* pSpriteFactory,
+      std::optional<int> levelNumber);
+
+    engine::TiledTexture mUiSpriteSheet;
+    ui::MenuElementRenderer mTextRenderer;
+    ui::HudRenderer mHudRenderer;
+    engine::SpecialEffectsRenderer mSpecialEffects;
+    renderer::RenderTargetTexture mLowResLayer;
+  };
+
   renderer::Renderer* mpRenderer;
   IGameServiceProvider* mpServiceProvider;
-  engine::TiledTexture mUiSpriteSheet;
-  ui::MenuElementRenderer mTextRenderer;
   data::PersistentPlayerState* mpPersistentPlayerState;
   const data::GameOptions* mpOptions;
   const assets::ResourceLoader* mpResources;
@@ -185,10 +211,8 @@ private:
   data::map::Map mMap;
   std::optional<engine::MapRenderer> mMapRenderer;
   data::PersistentPlayerState mPlayerModelAtLevelStart;
-  ui::HudRenderer mHudRenderer;
+  std::unique_ptr<RenderResources> mpRenderResources;
   ui::IngameMessageDisplay mMessageDisplay;
-  engine::SpecialEffectsRenderer mSpecialEffects;
-  renderer::RenderTargetTexture mLowResLayer;
   std::vector<engine::WaterEffectArea> mVisibleWaterAreas;
   base::Size mPreviousWindowSize;
   bool mPerElementUpscalingWasEnabled;
@@ -196,6 +220,8 @@ private:
   detail::Bridge mBridge;
   std::unique_ptr<detail::State> mpState;
   std::unique_ptr<QuickSaveData> mpQuickSave;
+  RewindHistory mRewindHistory;
+  std::vector<std::uint8_t> mRewindStateBuffer;
 
   std::optional<data::PersistentPlayerState::CheckpointState> mCheckpointState;
 };
@@ -21,6 +21,8 @@
 #include "engine/timing.hpp"
 #include "game_logic_common/input.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <set>
 
@@ -38,6 +40,10 @@ namespace rigel::game_logic
 // close to playing the game on a 486 at the default game speed setting.
 constexpr auto GAME_LOGIC_UPDATE_DELAY = 1.0 / 15.0;
 
+// Number of game logic updates that can be undone via IGameWorld::rewind(),
+// corresponding to 10 seconds of game time.
+constexpr auto REWIND_HISTORY_LENGTH = std::size_t{150};
+
 constexpr auto BOSS_LEVEL_INTRO_MUSIC = "CALM.IMF";
 
 
@@ -60,10 +66,42 @@ struct IGameWorld
   virtual void quickSave() = 0;
   virtual void quickLoad() = 0;
   virtual bool canQuickLoad() const = 0;
+
+  /** Remember the current state for rewinding
+   *
+   * Meant to be called before each game logic update. The most recent
+   * REWIND_HISTORY_LENGTH recorded states are kept.
+   */
+  virtual void recordRewindState() = 0;
+
+  /** Go back to the most recently recorded state, removing it from history
+   *
+   * Returns false if there is no recorded state left.
+   */
+  virtual bool rewind() = 0;
+
   virtual void debugToggleBoundingBoxDisplay() = 0;
   virtual void debugToggleWorldCollisionDataDisplay() = 0;
   virtual void debugToggleGridDisplay() = 0;
   virtual void printDebugText(std::ostream& stream) const = 0;
+
+  /** Current position in the random number table
+   *
+   * Needed for recording and replaying, see frontend/replay.hpp
+   */
+  virtual std::uint8_t randomNumberGeneratorState() const = 0;
+  virtual void setRandomNumberGeneratorState(std::uint8_t state) = 0;
+
+  /** Hash of the simulation state
+   *
+   * Two worlds which have been given the same sequence of inputs must
+   * produce the same hash after each update. This is used to find the exact
+   * update where a replay diverges from its recording.
+   *
+   * The classic world hashes its complete state. The enhanced world only
+   * hashes the plain data parts of its state, see GameWorld::stateHash().
+   */
+  virtual std::uint64_t stateHash() const = 0;
 };
 
 } // namespace rigel::game_logic
@@ -0,0 +1,86 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "rewind_history.hpp"
+
+#include <cassert>
+
+
+namespace rigel::game_logic
+{
+
+RewindHistory::RewindHistory(const std::size_t capacity)
+  : mStates(capacity)
+{
+}
+
+
+void RewindHistory::push(
+  base::ArrayView<std::uint8_t> state,
+  const data::PersistentPlayerState& playerState)
+{
+  mStates.push(state);
+  mPlayerStates.push_back(playerState);
+
+  // The delta buffer discards its oldest state once it's full, keep the
+  // player states in sync with that
+  if (mPlayerStates.size() > mStates.size())
+  {
+    mPlayerStates.pop_front();
+  }
+}
+
+
+void RewindHistory::dropNewest()
+{
+  assert(!empty());
+
+  mStates.dropNewest();
+  mPlayerStates.pop_back();
+}
+
+
+void RewindHistory::clear()
+{
+  mStates.clear();
+  mPlayerStates.clear();
+}
+
+
+std::size_t RewindHistory::storageSize() const
+{
+  return mStates.storageSize() +
+    mPlayerStates.size() * sizeof(data::PersistentPlayerState);
+}
+
+
+void appendMapTiles(
+  const data::map::Map& map,
+  std::vector<std::uint8_t>& buffer)
+{
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    const auto tiles = map.layerData(layer);
+    const auto pTileBytes = reinterpret_cast<const std::uint8_t*>(tiles.data());
+    buffer.insert(
+      buffer.end(),
+      pTileBytes,
+      pTileBytes + tiles.size() * sizeof(data::map::TileIndex));
+  }
+}
+
+} // namespace rigel::game_logic
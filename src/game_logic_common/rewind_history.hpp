@@ -0,0 +1,126 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/array_view.hpp"
+#include "base/delta_ring_buffer.hpp"
+#include "data/map.hpp"
+#include "data/player_model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Game states recorded for IGameWorld::rewind()
+ *
+ * Each entry consists of a binary blob of world state, which is delta-encoded
+ * via base::DeltaRingBuffer, and the persistent player state at that point.
+ * The latter isn't a flat struct (the inventory is a vector), and is stored
+ * as a regular copy.
+ */
+class RewindHistory
+{
+public:
+  explicit RewindHistory(std::size_t capacity);
+
+  void push(
+    base::ArrayView<std::uint8_t> state,
+    const data::PersistentPlayerState& playerState);
+
+  /** Discard the newest entry, making the one before it the newest
+   *
+   * Must not be called on an empty history.
+   */
+  void dropNewest();
+
+  void clear();
+
+  /** Must not be called on an empty history */
+  const std::vector<std::uint8_t>& newestState() const
+  {
+    return mStates.newest();
+  }
+
+  /** Must not be called on an empty history */
+  const data::PersistentPlayerState& newestPlayerState() const
+  {
+    return mPlayerStates.back();
+  }
+
+  std::size_t size() const { return mStates.size(); }
+  bool empty() const { return mStates.empty(); }
+
+  /** Approximate memory used by all entries, in bytes */
+  std::size_t storageSize() const;
+
+private:
+  base::DeltaRingBuffer mStates;
+  std::deque<data::PersistentPlayerState> mPlayerStates;
+};
+
+
+/** Append the tiles of both of the map's layers to buffer, as raw bytes */
+void appendMapTiles(
+  const data::map::Map& map,
+  std::vector<std::uint8_t>& buffer);
+
+
+/** Restore tiles written by appendMapTiles()
+ *
+ * Only tiles that differ from the current map contents are written, and
+ * onTileChanged is invoked with the position of each of them. This allows
+ * callers to limit any follow-up work (like updating the map renderer) to
+ * the affected parts of the map.
+ *
+ * Returns a pointer to the first byte after the tile data.
+ */
+template <typename Callback>
+const std::uint8_t* restoreMapTiles(
+  const std::uint8_t* pTileBytes,
+  data::map::Map& map,
+  Callback&& onTileChanged)
+{
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    for (auto y = 0; y < map.height(); ++y)
+    {
+      for (auto x = 0; x < map.width(); ++x)
+      {
+        data::map::TileIndex tile;
+        std::memcpy(&tile, pTileBytes, sizeof(tile));
+        pTileBytes += sizeof(tile);
+
+        if (map.tileAt(layer, x, y) != tile)
+        {
+          map.setTileAt(layer, x, y, tile);
+          onTileChanged(base::Vec2{x, y});
+        }
+      }
+    }
+  }
+
+  return pTileBytes;
+}
+
+} // namespace rigel::game_logic
@@ -27,7 +27,9 @@
 #include "base/match.hpp"
 #include "base/string_utils.hpp"
 #include "base/warnings.hpp"
+#include "frontend/headless_simulation.hpp"
 #include "frontend/user_profile.hpp"
+#include "renderer/frame_capture.hpp"
 
 #include "game_main.hpp"
 
@@ -179,6 +181,25 @@ std::variant<CommandLineOptions, int> parseArgs(int argc, char** argv)
       .help("Disable all audio output")
     | lyra::opt(config.mPlayDemo)["--play-demo"]
       .help("Play pre-recorded demo")
+    | lyra::opt(config.mHeadless)["--headless"]
+      .help(
+        "Run game logic without opening a window, as fast as possible, "
+        "and report ticks per second. Uses the level given via --play-level")
+    | lyra::opt(config.mHeadlessFrameCount, "count")["--frames"]
+      .help("Number of frames to simulate in headless mode")
+      .choices([](const int count) { return count > 0; })
+    | lyra::opt(config.mRecordingPath, "file")["--record"]
+      .help(
+        "Record gameplay to replay files, one per level. The level is "
+        "appended to the file name, e.g. run.rgr becomes run_L1.rgr")
+    | lyra::opt(config.mReplayPath, "file")["--replay"]
+      .help(
+        "Play back a replay file recorded via --record. Runs in headless "
+        "mode at maximum speed")
+    | lyra::opt(config.mFrameCapturePath, "file")["--analyze-capture"]
+      .help(
+        "Print a report of draw calls, batch breaks and overdraw for a "
+        "frame capture (taken in-game with F9), then exit")
     | lyra::group([&](const lyra::group&){})
       .add_argument(lyra::opt([&](const std::string& levelSpec){
           config.mLevelToJumpTo = data::GameSessionId{
@@ -292,6 +313,51 @@ int runGame(CommandLineOptions config)
   }
 }
 
+
+int runHeadless(CommandLineOptions config)
+{
+  if (isPortableInstall())
+  {
+    std::error_code errc;
+    config.mGamePath = std::filesystem::current_path(errc).u8string();
+  }
+
+  try
+  {
+    return runHeadlessSimulation(config);
+  }
+  catch (const std::exception& ex)
+  {
+    LOG_F(ERROR, "%s", ex.what());
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return -2;
+  }
+  catch (...)
+  {
+    LOG_F(ERROR, "Unknown error");
+    std::cerr << "ERROR: Unknown error\n";
+    return -3;
+  }
+}
+
+
+int analyzeFrameCapture(const CommandLineOptions& config)
+{
+  try
+  {
+    const auto capture = renderer::loadFrameCapture(
+      std::filesystem::u8path(config.mFrameCapturePath));
+    renderer::printFrameCaptureSummary(
+      std::cout, renderer::summarizeFrameCapture(capture));
+    return 0;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return -2;
+  }
+}
+
 } // namespace
 
 
@@ -319,6 +385,19 @@ int main(int argc, char** argv)
   return base::match(
     configOrExitCode,
     [&](const CommandLineOptions& config) {
+      if (!config.mFrameCapturePath.empty())
+      {
+        return analyzeFrameCapture(config);
+      }
+
+      if (config.mHeadless || !config.mReplayPath.empty())
+      {
+        // Headless mode reports its results on the console, so we stay
+        // attached in that case.
+        initializeLogging(argc, argv);
+        return runHeadless(config);
+      }
+
       // Once we're ready to run, detach from the console. See comment above
       // for why we're doing this.
       win32IoGuard.reset();
@@ -0,0 +1,345 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_capture.hpp"
+
+#include "assets/file_utils.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+
+namespace rigel::renderer
+{
+
+namespace
+{
+
+constexpr char CAPTURE_MAGIC[] = {'R', 'G', 'L', 'C'};
+constexpr std::uint8_t CAPTURE_FORMAT_VERSION = 1;
+
+constexpr auto MAX_CALL_SITE_LENGTH = 255;
+
+constexpr const char* BATCH_BREAK_REASON_NAMES[] = {
+  "none",
+  "state",
+  "texture",
+  "full",
+  "explicit",
+  "frame end"};
+
+static_assert(std::size(BATCH_BREAK_REASON_NAMES) == NUM_BATCH_BREAK_REASONS);
+
+
+void writeU8(std::ostream& stream, const std::uint8_t value)
+{
+  stream.put(static_cast<char>(value));
+}
+
+
+void writeU16(std::ostream& stream, const std::uint16_t value)
+{
+  writeU8(stream, static_cast<std::uint8_t>(value & 0xFF));
+  writeU8(stream, static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void writeU32(std::ostream& stream, const std::uint32_t value)
+{
+  writeU16(stream, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU16(stream, static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void writeSize(std::ostream& stream, const base::Size& size)
+{
+  writeU16(stream, static_cast<std::uint16_t>(size.width));
+  writeU16(stream, static_cast<std::uint16_t>(size.height));
+}
+
+
+base::Size readSize(assets::LeStreamReader& reader)
+{
+  const auto width = reader.readU16();
+  const auto height = reader.readU16();
+  return {width, height};
+}
+
+
+bool isDrawCall(const CaptureEventType type)
+{
+  return type <= CaptureEventType::DrawVertexBuffer;
+}
+
+
+RenderTargetSummary& targetSummary(
+  std::vector<RenderTargetSummary>& targets,
+  const std::uint32_t renderTarget)
+{
+  const auto iTarget = std::find_if(
+    targets.begin(), targets.end(), [&](const RenderTargetSummary& target) {
+      return target.mRenderTarget == renderTarget;
+    });
+
+  if (iTarget != targets.end())
+  {
+    return *iTarget;
+  }
+
+  auto& newTarget = targets.emplace_back();
+  newTarget.mRenderTarget = renderTarget;
+  return newTarget;
+}
+
+
+CallSiteSummary& callSiteSummary(
+  std::vector<CallSiteSummary>& callSites,
+  const std::string& name)
+{
+  const auto iCallSite = std::find_if(
+    callSites.begin(), callSites.end(), [&](const CallSiteSummary& callSite) {
+      return callSite.mCallSite == name;
+    });
+
+  if (iCallSite != callSites.end())
+  {
+    return *iCallSite;
+  }
+
+  auto& newCallSite = callSites.emplace_back();
+  newCallSite.mCallSite = name;
+  return newCallSite;
+}
+
+} // namespace
+
+
+double RenderTargetSummary::overdraw() const
+{
+  const auto area = mSize.width * mSize.height;
+  return area > 0 ? double(mPixelsCovered) / area : 0.0;
+}
+
+
+void writeFrameCapture(
+  const std::filesystem::path& path,
+  const FrameCapture& capture)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    throw std::runtime_error("Cannot open file for writing");
+  }
+
+  file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+  writeU8(file, CAPTURE_FORMAT_VERSION);
+  writeSize(file, capture.mWindowSize);
+  writeU32(file, static_cast<std::uint32_t>(capture.mEvents.size()));
+
+  for (const auto& event : capture.mEvents)
+  {
+    writeU8(file, static_cast<std::uint8_t>(event.mType));
+    writeU8(file, static_cast<std::uint8_t>(event.mBreakReason));
+    writeU32(file, event.mResourceId);
+    writeU32(file, event.mVertexCount);
+    writeU32(file, event.mPixelsCovered);
+    writeSize(file, event.mSize);
+
+    const auto length = std::min(
+      event.mCallSite.size(), std::size_t{MAX_CALL_SITE_LENGTH});
+    writeU8(file, static_cast<std::uint8_t>(length));
+    file.write(event.mCallSite.data(), length);
+  }
+
+  if (!file.good())
+  {
+    throw std::runtime_error("Failed to write frame capture");
+  }
+}
+
+
+FrameCapture loadFrameCapture(const std::filesystem::path& path)
+{
+  const auto data = assets::loadFile(path);
+  auto reader = assets::LeStreamReader{data};
+
+  for (const auto expectedChar : CAPTURE_MAGIC)
+  {
+    if (reader.readU8() != static_cast<std::uint8_t>(expectedChar))
+    {
+      throw std::runtime_error("Not a frame capture file");
+    }
+  }
+
+  if (reader.readU8() != CAPTURE_FORMAT_VERSION)
+  {
+    throw std::runtime_error("Unsupported frame capture file version");
+  }
+
+  FrameCapture capture;
+  capture.mWindowSize = readSize(reader);
+
+  const auto numEvents = reader.readU32();
+  for (auto i = 0u; i < numEvents; ++i)
+  {
+    CaptureEvent event;
+
+    const auto type = reader.readU8();
+    const auto reason = reader.readU8();
+    if (
+      type > std::uint8_t(CaptureEventType::SelectShader) ||
+      reason >= NUM_BATCH_BREAK_REASONS)
+    {
+      throw std::runtime_error("Invalid event in frame capture file");
+    }
+
+    event.mType = static_cast<CaptureEventType>(type);
+    event.mBreakReason = static_cast<BatchBreakReason>(reason);
+    event.mResourceId = reader.readU32();
+    event.mVertexCount = reader.readU32();
+    event.mPixelsCovered = reader.readU32();
+    event.mSize = readSize(reader);
+
+    const auto length = reader.readU8();
+    for (auto j = 0; j < length; ++j)
+    {
+      event.mCallSite.push_back(static_cast<char>(reader.readU8()));
+    }
+
+    capture.mEvents.push_back(std::move(event));
+  }
+
+  return capture;
+}
+
+
+FrameCaptureSummary summarizeFrameCapture(const FrameCapture& capture)
+{
+  FrameCaptureSummary summary;
+
+  auto currentTarget = std::uint32_t{0};
+  auto stateStackDepth = 0;
+
+  targetSummary(summary.mRenderTargets, 0).mSize = capture.mWindowSize;
+
+  for (const auto& event : capture.mEvents)
+  {
+    if (isDrawCall(event.mType))
+    {
+      ++summary.mNumDrawCalls;
+      summary.mNumVertices += event.mVertexCount;
+
+      auto& target = targetSummary(summary.mRenderTargets, currentTarget);
+      ++target.mNumDrawCalls;
+      target.mPixelsCovered += event.mPixelsCovered;
+
+      auto& callSite = callSiteSummary(summary.mCallSites, event.mCallSite);
+      ++callSite.mNumDrawCalls;
+      ++callSite.mBatchBreaks[std::size_t(event.mBreakReason)];
+      continue;
+    }
+
+    switch (event.mType)
+    {
+      case CaptureEventType::Clear:
+        ++summary.mNumClears;
+        break;
+
+      case CaptureEventType::PushState:
+        ++stateStackDepth;
+        summary.mMaxStateStackDepth =
+          std::max(summary.mMaxStateStackDepth, stateStackDepth);
+        break;
+
+      case CaptureEventType::PopState:
+        --stateStackDepth;
+        break;
+
+      case CaptureEventType::SetRenderTarget:
+        ++summary.mNumRenderTargetSwitches;
+        currentTarget = event.mResourceId;
+        targetSummary(summary.mRenderTargets, currentTarget).mSize =
+          event.mSize;
+        break;
+
+      case CaptureEventType::SelectShader:
+        ++summary.mNumShaderSwitches;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  std::stable_sort(
+    summary.mCallSites.begin(),
+    summary.mCallSites.end(),
+    [](const CallSiteSummary& lhs, const CallSiteSummary& rhs) {
+      return lhs.mNumDrawCalls > rhs.mNumDrawCalls;
+    });
+
+  return summary;
+}
+
+
+void printFrameCaptureSummary(
+  std::ostream& stream,
+  const FrameCaptureSummary& summary)
+{
+  stream << "Draw calls: " << summary.mNumDrawCalls << " ("
+         << summary.mNumVertices << " vertices)\n"
+         << "Clears: " << summary.mNumClears << '\n'
+         << "Render target switches: " << summary.mNumRenderTargetSwitches
+         << '\n'
+         << "Shader switches: " << summary.mNumShaderSwitches << '\n'
+         << "Max. state stack depth: " << summary.mMaxStateStackDepth
+         << "\n\n";
+
+  stream << "Render targets:\n";
+  for (const auto& target : summary.mRenderTargets)
+  {
+    stream << "  " << std::setw(6) << target.mRenderTarget << "  "
+           << target.mSize.width << 'x' << target.mSize.height << ", "
+           << target.mNumDrawCalls << " draw calls, overdraw " << std::fixed
+           << std::setprecision(2) << target.overdraw() << "x\n";
+  }
+
+  stream << "\nDraw calls by call site, with reasons for batch breaks:\n";
+  stream << "  " << std::setw(6) << "total";
+  for (const auto pName : BATCH_BREAK_REASON_NAMES)
+  {
+    stream << "  " << std::setw(9) << pName;
+  }
+  stream << "  call site\n";
+
+  for (const auto& callSite : summary.mCallSites)
+  {
+    stream << "  " << std::setw(6) << callSite.mNumDrawCalls;
+    for (const auto count : callSite.mBatchBreaks)
+    {
+      stream << "  " << std::setw(9) << count;
+    }
+
+    stream << "  "
+           << (callSite.mCallSite.empty() ? "(unknown)" : callSite.mCallSite)
+           << '\n';
+  }
+}
+
+} // namespace rigel::renderer
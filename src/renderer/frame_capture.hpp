@@ -0,0 +1,203 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+namespace rigel::renderer
+{
+
+/** Recording of all draw calls and state changes made during one frame
+ *
+ * A capture is made by calling Renderer::requestFrameCapture(). The renderer
+ * then logs every draw call it submits to OpenGL during the next frame,
+ * together with the reason why the preceding batch had to be submitted, and
+ * every state change that reaches OpenGL (render target and shader switches,
+ * clears), as well as calls to pushState()/popState(). Each event is tagged
+ * with the innermost profiler scope that was active when it happened (see
+ * base/profiler.hpp), which is how events are attributed to call sites.
+ *
+ * Captures can be saved to a file, and analyzed later via
+ * summarizeFrameCapture(). All numbers are stored in little-endian format.
+ * The file starts with a header:
+ *
+ *   4 bytes   magic ("RGLC")
+ *   u8        format version
+ *   u16, u16  window size (width, height)
+ *   u32       number of events
+ *
+ * This is followed by the events, each consisting of:
+ *
+ *   u8        type (see CaptureEventType)
+ *   u8        batch break reason (see BatchBreakReason)
+ *   u32       resource id
+ *   u32       vertex count
+ *   u32       pixels covered
+ *   u16, u16  size (width, height)
+ *   u8        length of call site name, followed by that many characters
+ *
+ * See CaptureEvent for the meaning of each field.
+ */
+
+
+enum class CaptureEventType : std::uint8_t
+{
+  DrawSprites = 0,
+  DrawMultiTexturedSprites = 1,
+  DrawTriangles = 2,
+  DrawLines = 3,
+  DrawPoints = 4,
+  DrawCustomQuads = 5,
+  DrawVertexBuffer = 6,
+  Clear = 7,
+  PushState = 8,
+  PopState = 9,
+  SetRenderTarget = 10,
+  SelectShader = 11
+};
+
+
+/** Why the renderer had to submit a batch */
+enum class BatchBreakReason : std::uint8_t
+{
+  /** Not a batched draw call */
+  None = 0,
+
+  /** Part of the renderer state changed */
+  StateChange = 1,
+
+  /** A different texture was needed */
+  TextureChange = 2,
+
+  /** The batch reached its maximum size */
+  BatchFull = 3,
+
+  /** Requested by the client, e.g. via submitBatch() or custom drawing */
+  Explicit = 4,
+
+  /** Submitted by swapBuffers() */
+  EndOfFrame = 5
+};
+
+constexpr auto NUM_BATCH_BREAK_REASONS = 6;
+
+
+struct CaptureEvent
+{
+  CaptureEventType mType;
+  BatchBreakReason mBreakReason = BatchBreakReason::None;
+
+  /** Texture for draw calls, render target for SetRenderTarget, shader
+   * program for SelectShader. 0 if not applicable.
+   */
+  std::uint32_t mResourceId = 0;
+
+  /** Number of vertices (indices for indexed draws) given to OpenGL */
+  std::uint32_t mVertexCount = 0;
+
+  /** Number of pixels covered by the draw call's primitives
+   *
+   * Scaled by the global scale, but not clipped. Only known for sprites and
+   * filled rectangles, 0 for all other primitives.
+   */
+  std::uint32_t mPixelsCovered = 0;
+
+  /** Size of the render target, for SetRenderTarget */
+  base::Size mSize;
+
+  /** Innermost profiler scope active when the event was recorded */
+  std::string mCallSite;
+};
+
+
+struct FrameCapture
+{
+  base::Size mWindowSize;
+  std::vector<CaptureEvent> mEvents;
+};
+
+
+struct CallSiteSummary
+{
+  std::string mCallSite;
+  int mNumDrawCalls = 0;
+
+  /** Number of draw calls per BatchBreakReason */
+  std::array<int, NUM_BATCH_BREAK_REASONS> mBatchBreaks{};
+};
+
+
+struct RenderTargetSummary
+{
+  /** 0 is the window's default framebuffer */
+  std::uint32_t mRenderTarget = 0;
+  base::Size mSize;
+  int mNumDrawCalls = 0;
+  std::uint64_t mPixelsCovered = 0;
+
+  /** How often each pixel of the target was drawn on average */
+  double overdraw() const;
+};
+
+
+struct FrameCaptureSummary
+{
+  int mNumDrawCalls = 0;
+  int mNumClears = 0;
+  int mNumRenderTargetSwitches = 0;
+  int mNumShaderSwitches = 0;
+  int mMaxStateStackDepth = 0;
+  std::uint64_t mNumVertices = 0;
+
+  /** Sorted by number of draw calls, descending */
+  std::vector<CallSiteSummary> mCallSites;
+
+  /** In order of first use */
+  std::vector<RenderTargetSummary> mRenderTargets;
+};
+
+
+/** Write capture to a file, in the format described above
+ *
+ * Throws an exception if the file can't be written.
+ */
+void writeFrameCapture(
+  const std::filesystem::path& path,
+  const FrameCapture& capture);
+
+/** Load a capture written by writeFrameCapture()
+ *
+ * Throws an exception if the file can't be read, or is not a valid capture.
+ */
+FrameCapture loadFrameCapture(const std::filesystem::path& path);
+
+FrameCaptureSummary summarizeFrameCapture(const FrameCapture& capture);
+
+/** Print a human-readable report of the given summary */
+void printFrameCaptureSummary(
+  std::ostream& stream,
+  const FrameCaptureSummary& summary);
+
+} // namespace rigel::renderer
@@ -17,11 +17,13 @@
 #include "renderer.hpp"
 
 #include "assets/palette.hpp"
+#include "base/profiler.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "renderer/opengl.hpp"
 #include "renderer/shader.hpp"
 #include "renderer/shader_code.hpp"
+#include "renderer/stream_buffer.hpp"
 #include "renderer/vertex_buffer_utils.hpp"
 #include "sdl_utils/error.hpp"
 
@@ -32,7 +34,10 @@ RIGEL_RESTORE_WARNINGS
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cmath>
 #include <iterator>
+#include <utility>
 
 
 namespace rigel::renderer
@@ -55,6 +60,12 @@ constexpr std::array<GLenum, MAX_MULTI_TEXTURES> TEXTURE_UNIT_IDS{
 
 constexpr auto MAX_QUADS_PER_BATCH = 1280u;
 constexpr auto MAX_BATCH_SIZE = MAX_QUADS_PER_BATCH * std::size(QUAD_INDICES);
+constexpr auto MAX_SOLID_COLOR_VERTICES_PER_BATCH = 8192u;
+constexpr auto SOLID_COLOR_VERTEX_SIZE = 6u;
+
+// When merging deferred draws, how many batches to look back for one that
+// the draw can be added to
+constexpr auto MAX_DEFERRED_BATCH_LOOKBACK = 64u;
 
 
 #ifdef RIGEL_USE_GL_ES
@@ -108,15 +119,67 @@ struct RenderTarget
 };
 
 
+/** Area covered by a draw call, in render target coordinates */
+struct ScreenBounds
+{
+  float mLeft;
+  float mTop;
+  float mRight;
+  float mBottom;
+
+  bool overlaps(const ScreenBounds& other) const
+  {
+    // clang-format off
+    return
+      mLeft < other.mRight && other.mLeft < mRight &&
+      mTop < other.mBottom && other.mTop < mBottom;
+    // clang-format on
+  }
+
+  ScreenBounds united(const ScreenBounds& other) const
+  {
+    return {
+      std::min(mLeft, other.mLeft),
+      std::min(mTop, other.mTop),
+      std::max(mRight, other.mRight),
+      std::max(mBottom, other.mBottom)};
+  }
+};
+
+
 enum class RenderMode : std::uint8_t
 {
   SpriteBatch,
+  MultiTextureSpriteBatch,
   NonTexturedRender,
+  Lines,
   Points,
   CustomDrawing
 };
 
 
+CaptureEventType captureEventType(const RenderMode mode)
+{
+  switch (mode)
+  {
+    case RenderMode::MultiTextureSpriteBatch:
+      return CaptureEventType::DrawMultiTexturedSprites;
+
+    case RenderMode::NonTexturedRender:
+      return CaptureEventType::DrawTriangles;
+
+    case RenderMode::Lines:
+      return CaptureEventType::DrawLines;
+
+    case RenderMode::Points:
+      return CaptureEventType::DrawPoints;
+
+    default:
+      return CaptureEventType::DrawSprites;
+  }
+}
+
+
 glm::vec4 toGlColor(const base::Color& color)
 {
   return glm::vec4{color.r, color.g, color.b, color.a} / 255.0f;
@@ -142,32 +205,97 @@ void setScissorBox(
 }
 
 
-void setVertexLayout(const VertexLayout layout)
+int floatsPerVertex(const VertexLayout layout)
+{
+  switch (layout)
+  {
+    case VertexLayout::PositionAndTexCoords:
+      return 4;
+
+    case VertexLayout::PositionAndColor:
+      return 6;
+
+    case VertexLayout::PositionTexCoordsAndTextureIndex:
+    case VertexLayout::PositionTexCoordsAndAnimationType:
+      return 5;
+  }
+
+  assert(false);
+  return 4;
+}
+
+
+bool hasExtraVertexAttribute(const VertexLayout layout)
+{
+  return layout == VertexLayout::PositionTexCoordsAndTextureIndex ||
+    layout == VertexLayout::PositionTexCoordsAndAnimationType;
+}
+
+
+void setVertexLayout(
+  const VertexLayout layout,
+  const std::uintptr_t baseOffset = 0)
 {
   switch (layout)
   {
     case VertexLayout::PositionAndTexCoords:
       glVertexAttribPointer(
-        0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 4, toAttribOffset(0));
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 4,
+        toAttribOffset(baseOffset));
       glVertexAttribPointer(
         1,
         2,
         GL_FLOAT,
         GL_FALSE,
         sizeof(float) * 4,
-        toAttribOffset(sizeof(float) * 2));
+        toAttribOffset(baseOffset + sizeof(float) * 2));
       break;
 
     case VertexLayout::PositionAndColor:
       glVertexAttribPointer(
-        0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, toAttribOffset(0));
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 6,
+        toAttribOffset(baseOffset));
       glVertexAttribPointer(
         1,
         4,
         GL_FLOAT,
         GL_FALSE,
         sizeof(float) * 6,
-        toAttribOffset(sizeof(float) * 2));
+        toAttribOffset(baseOffset + sizeof(float) * 2));
+      break;
+
+    case VertexLayout::PositionTexCoordsAndTextureIndex:
+    case VertexLayout::PositionTexCoordsAndAnimationType:
+      glVertexAttribPointer(
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset));
+      glVertexAttribPointer(
+        1,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset + sizeof(float) * 2));
+      glVertexAttribPointer(
+        2,
+        1,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset + sizeof(float) * 4));
+      break;
   }
 }
 
@@ -264,6 +392,25 @@ struct Renderer::Impl
     }
   };
 
+  /** Draw recorded while deferred batching is enabled */
+  struct DeferredDraw
+  {
+    QuadVertices mVertices;
+    ScreenBounds mBounds;
+    GLuint mTexture;
+    std::uint32_t mStateIndex;
+  };
+
+  /** Group of deferred draws which can be rendered with a single draw call */
+  struct DeferredBatch
+  {
+    ScreenBounds mBounds;
+    GLuint mTexture;
+    std::uint32_t mStateIndex;
+    std::uint32_t mNumDraws;
+    std::uint32_t mFirstDraw;
+  };
+
   // hot - meant to fit into a single cache line.
   // needed for batching/rendering
   std::vector<GLfloat> mBatchData;
@@ -285,11 +432,42 @@ struct Renderer::Impl
   SDL_Window* mpWindow;
   RenderMode mLastKnownRenderMode = RenderMode::SpriteBatch;
 
+  // deferred batching
+  std::vector<DeferredDraw> mDeferredDraws;
+  std::vector<State> mDeferredStates;
+  std::vector<DeferredBatch> mDeferredBatches;
+  std::vector<std::uint32_t> mDeferredBatchOfDraw;
+  std::vector<std::uint32_t> mDeferredDrawOrder;
+  bool mDeferredBatchingEnabled = false;
+
+  // multi-texture batching
+  Shader mMultiTexturedQuadShader;
+  std::array<GLuint, MAX_MULTI_TEXTURES> mBatchTextures{};
+  std::array<GLuint, MAX_MULTI_TEXTURES> mBoundTextures{};
+  std::size_t mNumBatchTextures = 0;
+  bool mMultiTextureBatchingEnabled = false;
+  bool mExtraVertexAttributeEnabled = false;
+
+  // per-frame statistics
+  int mNumDrawCalls = 0;
+  int mNumStateCommits = 0;
+  int mNumTextureSwitches = 0;
+
+  // frame capture
+  std::optional<FrameCapture> mCapture;
+  std::optional<FrameCapture> mFinishedCapture;
+  std::uint32_t mPixelsInBatch = 0;
+  bool mCaptureRequested = false;
+  bool mProfilerWasEnabled = false;
+
   // cold
   int mNumTextures = 0;
   int mNumVbos = 0;
   DummyVao mDummyVao;
-  GLuint mStreamVbo = 0;
+
+  // Used for all vertex data that's not in a static vertex buffer. Stays
+  // bound all the time.
+  StreamBuffer mStreamBuffer;
 
 
   explicit Impl(SDL_Window* pWindow)
@@ -298,6 +476,7 @@ struct Renderer::Impl
     , mSolidColorShader(SOLID_COLOR_SHADER)
     , mWindowSize(getSize(pWindow))
     , mpWindow(pWindow)
+    , mMultiTexturedQuadShader(MULTI_TEXTURED_QUAD_SHADER)
   {
     // General configuration
     glDisable(GL_DEPTH_TEST);
@@ -305,10 +484,6 @@ struct Renderer::Impl
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Set up a VBO for streaming data to the GPU, stays bound all the time
-    glGenBuffers(1, &mStreamVbo);
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
-
     // Set up an index buffer with enough indices to handle the largest
     // possible batch size. This is only sent to the GPU once, reducing the
     // amount of data we need to send for each batch.
@@ -335,7 +510,8 @@ struct Renderer::Impl
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
-    // All shaders have exactly two vertex attributes
+    // All shaders have at least two vertex attributes. The 3rd one is only
+    // used by some vertex layouts, and enabled on demand.
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
 
@@ -353,7 +529,6 @@ struct Renderer::Impl
     assert(mNumTextures == 0);
     assert(mNumVbos == 0);
 
-    glDeleteBuffers(1, &mStreamVbo);
     glDeleteBuffers(1, &mQuadIndicesEbo);
   }
 
@@ -363,29 +538,359 @@ struct Renderer::Impl
     const TexCoords& sourceRect,
     const base::Rect<int>& destRect)
   {
-    updateState(mRenderMode, RenderMode::SpriteBatch);
+    updateState(mRenderMode, spriteBatchRenderMode());
 
-    if (texture != mLastUsedTexture)
+    if (mDeferredBatchingEnabled)
     {
-      submitBatch();
+      deferDrawTexture(texture, sourceRect, destRect);
+      return;
+    }
+
+    addQuadToBatch(texture, createTexturedQuadVertices(sourceRect, destRect));
+  }
+
+
+  RenderMode spriteBatchRenderMode() const
+  {
+    // The multi-texture shader doesn't support any of the extended
+    // features, like color modulation.
+    const auto canUseMultiTextureBatch = mMultiTextureBatchingEnabled &&
+      !mStateStack.back().needsExtendedShader();
+    return canUseMultiTextureBatch ? RenderMode::MultiTextureSpriteBatch
+                                   : RenderMode::SpriteBatch;
+  }
 
-      glBindTexture(GL_TEXTURE_2D, texture);
-      mLastUsedTexture = texture;
+
+  void addQuadToBatch(const TextureId texture, const QuadVertices& vertices)
+  {
+    if (mRenderMode == RenderMode::MultiTextureSpriteBatch)
+    {
+      addMultiTexturedQuadToBatch(texture, vertices);
+      return;
+    }
+
+    if (texture != mLastUsedTexture)
+    {
+      submitPendingBatch(BatchBreakReason::TextureChange);
+      bindTexture(texture);
     }
 
     if (mBatchSize >= MAX_BATCH_SIZE)
     {
-      submitBatch();
+      submitPendingBatch(BatchBreakReason::BatchFull);
+    }
+
+    if (mCapture)
+    {
+      addQuadToCapturedPixels(vertices);
     }
 
-    const auto vertices = createTexturedQuadVertices(sourceRect, destRect);
     mBatchData.insert(
       mBatchData.end(), std::begin(vertices), std::end(vertices));
     mBatchSize += std::uint16_t(std::size(QUAD_INDICES));
   }
 
 
-  void submitBatch()
+  void addMultiTexturedQuadToBatch(
+    const TextureId texture,
+    const QuadVertices& vertices)
+  {
+    auto textureIndex = batchTextureIndex(texture);
+    if (textureIndex == MAX_MULTI_TEXTURES || mBatchSize >= MAX_BATCH_SIZE)
+    {
+      submitPendingBatch(
+        textureIndex == MAX_MULTI_TEXTURES ? BatchBreakReason::TextureChange
+                                           : BatchBreakReason::BatchFull);
+      textureIndex = batchTextureIndex(texture);
+    }
+
+    if (mCapture)
+    {
+      addQuadToCapturedPixels(vertices);
+    }
+
+    // Same as the vertices given, but with the texture index added to each
+    // vertex: 4 * (x, y, u, v, index)
+    for (auto i = 0u; i < vertices.size(); i += 4)
+    {
+      mBatchData.insert(
+        mBatchData.end(), vertices.begin() + i, vertices.begin() + i + 4);
+      mBatchData.push_back(float(textureIndex));
+    }
+
+    mBatchSize += std::uint16_t(std::size(QUAD_INDICES));
+  }
+
+
+  /** Returns texture unit index to use for the given texture
+   *
+   * Adds the texture to the current batch if it's not part of it yet.
+   * Returns MAX_MULTI_TEXTURES if the batch is already using the maximum
+   * number of textures.
+   */
+  std::size_t batchTextureIndex(const TextureId texture)
+  {
+    const auto iBegin = mBatchTextures.begin();
+    const auto iEnd = iBegin + mNumBatchTextures;
+
+    const auto iTexture = std::find(iBegin, iEnd, texture);
+    if (iTexture != iEnd)
+    {
+      return std::size_t(std::distance(iBegin, iTexture));
+    }
+
+    if (mNumBatchTextures == MAX_MULTI_TEXTURES)
+    {
+      return MAX_MULTI_TEXTURES;
+    }
+
+    mBatchTextures[mNumBatchTextures] = texture;
+    return mNumBatchTextures++;
+  }
+
+
+  void bindBatchTextures()
+  {
+    // Unit 0 is handled last, so that it ends up being the active texture
+    // unit again. Most code in the renderer assumes that to be the case.
+    auto activeUnitChanged = false;
+    for (auto i = mNumBatchTextures; i > 1; --i)
+    {
+      const auto unit = i - 1;
+      if (mBoundTextures[unit] != mBatchTextures[unit])
+      {
+        glActiveTexture(TEXTURE_UNIT_IDS[unit]);
+        glBindTexture(GL_TEXTURE_2D, mBatchTextures[unit]);
+        mBoundTextures[unit] = mBatchTextures[unit];
+        activeUnitChanged = true;
+        ++mNumTextureSwitches;
+      }
+    }
+
+    if (activeUnitChanged)
+    {
+      glActiveTexture(GL_TEXTURE0);
+    }
+
+    if (mBatchTextures[0] != mLastUsedTexture)
+    {
+      bindTexture(mBatchTextures[0]);
+    }
+  }
+
+
+  void deferDrawTexture(
+    const TextureId texture,
+    const TexCoords& sourceRect,
+    const base::Rect<int>& destRect)
+  {
+    const auto& state = mStateStack.back();
+
+    const auto left =
+      state.mGlobalTranslation.x + destRect.left() * state.mGlobalScale.x;
+    const auto top =
+      state.mGlobalTranslation.y + destRect.top() * state.mGlobalScale.y;
+    const auto right = left + destRect.size.width * state.mGlobalScale.x;
+    const auto bottom = top + destRect.size.height * state.mGlobalScale.y;
+
+    mDeferredDraws.push_back(DeferredDraw{
+      createTexturedQuadVertices(sourceRect, destRect),
+      ScreenBounds{
+        std::min(left, right),
+        std::min(top, bottom),
+        std::max(left, right),
+        std::max(top, bottom)},
+      texture,
+      deferredStateIndex(state)});
+  }
+
+
+  std::uint32_t deferredStateIndex(const State& state)
+  {
+    // The number of distinct states per frame is small, so a linear search
+    // is fine. Searching from the back finds the most likely match quickly.
+    for (auto i = mDeferredStates.size(); i > 0; --i)
+    {
+      if (mDeferredStates[i - 1] == state)
+      {
+        return std::uint32_t(i - 1);
+      }
+    }
+
+    mDeferredStates.push_back(state);
+    return std::uint32_t(mDeferredStates.size() - 1);
+  }
+
+
+  /** Assign each deferred draw to a batch
+   *
+   * A draw is added to the most recent batch with the same state and
+   * texture, unless there's a batch in between which overlaps the draw.
+   * Moving the draw in front of an overlapping batch would change the
+   * result due to blending, but non-overlapping draws can be reordered
+   * freely. If there's no suitable batch, a new one is started.
+   */
+  void assignDeferredBatches()
+  {
+    mDeferredBatches.clear();
+    mDeferredBatchOfDraw.resize(mDeferredDraws.size());
+
+    for (auto i = 0u; i < mDeferredDraws.size(); ++i)
+    {
+      const auto& draw = mDeferredDraws[i];
+
+      const auto numBatches = std::uint32_t(mDeferredBatches.size());
+      const auto searchEnd = numBatches > MAX_DEFERRED_BATCH_LOOKBACK
+        ? numBatches - MAX_DEFERRED_BATCH_LOOKBACK
+        : 0u;
+
+      auto targetBatch = numBatches;
+      for (auto b = numBatches; b > searchEnd; --b)
+      {
+        const auto& batch = mDeferredBatches[b - 1];
+        if (
+          batch.mTexture == draw.mTexture &&
+          batch.mStateIndex == draw.mStateIndex)
+        {
+          targetBatch = b - 1;
+          break;
+        }
+
+        if (batch.mBounds.overlaps(draw.mBounds))
+        {
+          break;
+        }
+      }
+
+      if (targetBatch == numBatches)
+      {
+        mDeferredBatches.push_back(
+          DeferredBatch{draw.mBounds, draw.mTexture, draw.mStateIndex, 0, 0});
+      }
+      else
+      {
+        auto& batch = mDeferredBatches[targetBatch];
+        batch.mBounds = batch.mBounds.united(draw.mBounds);
+      }
+
+      ++mDeferredBatches[targetBatch].mNumDraws;
+      mDeferredBatchOfDraw[i] = targetBatch;
+    }
+
+    // Group draws by batch, keeping their relative order within each batch
+    auto firstDraw = 0u;
+    for (auto& batch : mDeferredBatches)
+    {
+      batch.mFirstDraw = firstDraw;
+      firstDraw += batch.mNumDraws;
+    }
+
+    mDeferredDrawOrder.resize(mDeferredDraws.size());
+    for (auto i = 0u; i < mDeferredDraws.size(); ++i)
+    {
+      auto& batch = mDeferredBatches[mDeferredBatchOfDraw[i]];
+      mDeferredDrawOrder[batch.mFirstDraw++] = i;
+    }
+
+    for (auto& batch : mDeferredBatches)
+    {
+      batch.mFirstDraw -= batch.mNumDraws;
+    }
+  }
+
+
+  void flushDeferredDraws(
+    const BatchBreakReason reason = BatchBreakReason::Explicit)
+  {
+    if (mDeferredDraws.empty())
+    {
+      return;
+    }
+
+    RIGEL_PROFILE_SCOPE("Renderer::flushDeferredDraws");
+
+    assert(
+      mRenderMode == RenderMode::SpriteBatch ||
+      mRenderMode == RenderMode::MultiTextureSpriteBatch);
+    assert(mBatchData.empty());
+
+    assignDeferredBatches();
+
+    // Draws are submitted through the regular batching code, by temporarily
+    // switching to the state each batch was recorded with.
+    const auto currentState = mStateStack.back();
+
+    for (const auto& batch : mDeferredBatches)
+    {
+      const auto& batchState = mDeferredStates[batch.mStateIndex];
+      if (mStateStack.back() != batchState)
+      {
+        submitPendingBatch(BatchBreakReason::StateChange);
+        mStateStack.back() = batchState;
+        mStateChanged = true;
+      }
+
+      updateState(mRenderMode, spriteBatchRenderMode());
+
+      // With multi-texture batching, consecutive batches using different
+      // textures can still end up in the same draw call.
+      const auto endOfBatch = batch.mFirstDraw + batch.mNumDraws;
+      for (auto i = batch.mFirstDraw; i < endOfBatch; ++i)
+      {
+        addQuadToBatch(
+          batch.mTexture, mDeferredDraws[mDeferredDrawOrder[i]].mVertices);
+      }
+    }
+
+    submitPendingBatch(reason);
+
+    if (mStateStack.back() != currentState)
+    {
+      mStateStack.back() = currentState;
+      mStateChanged = true;
+    }
+
+    mDeferredDraws.clear();
+    mDeferredStates.clear();
+  }
+
+
+  void setDeferredBatchingEnabled(const bool enabled)
+  {
+    submitBatch();
+    mDeferredBatchingEnabled = enabled;
+  }
+
+
+  void setMultiTextureBatchingEnabled(const bool enabled)
+  {
+    submitBatch();
+    mMultiTextureBatchingEnabled = enabled;
+  }
+
+
+  void bindTexture(const TextureId texture)
+  {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    mLastUsedTexture = texture;
+    ++mNumTextureSwitches;
+  }
+
+
+  void submitBatch(const BatchBreakReason reason = BatchBreakReason::Explicit)
+  {
+    flushDeferredDraws(reason);
+    submitPendingBatch(reason);
+  }
+
+
+  /** Submit the current batch, without flushing deferred draws
+   *
+   * Used when state changes. Deferred draws record the state they were
+   * made with, so they don't need to be submitted on state changes.
+   */
+  void submitPendingBatch(
+    const BatchBreakReason reason = BatchBreakReason::Explicit)
   {
     commitChangedState();
 
@@ -394,89 +899,124 @@ struct Renderer::Impl
       return;
     }
 
+    if (mCapture)
+    {
+      recordBatchSubmission(reason);
+    }
+
+    RIGEL_PROFILE_SCOPE("Renderer::submitBatch");
+    ++mNumDrawCalls;
+
     switch (mRenderMode)
     {
       case RenderMode::SpriteBatch:
-        glBufferData(
-          GL_ARRAY_BUFFER,
-          sizeof(float) * mBatchData.size(),
-          mBatchData.data(),
-          GL_STREAM_DRAW);
+        uploadVertices(mBatchData.data(), sizeof(float) * mBatchData.size());
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
+        glDrawElements(GL_TRIANGLES, mBatchSize, GL_UNSIGNED_SHORT, nullptr);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        break;
+
+      case RenderMode::MultiTextureSpriteBatch:
+        bindBatchTextures();
+        uploadVertices(mBatchData.data(), sizeof(float) * mBatchData.size());
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
         glDrawElements(GL_TRIANGLES, mBatchSize, GL_UNSIGNED_SHORT, nullptr);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         break;
 
+      case RenderMode::NonTexturedRender:
+        uploadVertices(mBatchData.data(), sizeof(float) * mBatchData.size());
+        glDrawArrays(
+          GL_TRIANGLES,
+          0,
+          GLsizei(mBatchData.size() / SOLID_COLOR_VERTEX_SIZE));
+        break;
+
+      case RenderMode::Lines:
+        uploadVertices(mBatchData.data(), sizeof(float) * mBatchData.size());
+        glDrawArrays(
+          GL_LINES, 0, GLsizei(mBatchData.size() / SOLID_COLOR_VERTEX_SIZE));
+        break;
+
       case RenderMode::Points:
-        glBufferData(
-          GL_ARRAY_BUFFER,
-          sizeof(float) * mBatchData.size(),
-          mBatchData.data(),
-          GL_STREAM_DRAW);
-        glDrawArrays(GL_POINTS, 0, GLsizei(mBatchData.size() / 6));
+        uploadVertices(mBatchData.data(), sizeof(float) * mBatchData.size());
+        glDrawArrays(
+          GL_POINTS, 0, GLsizei(mBatchData.size() / SOLID_COLOR_VERTEX_SIZE));
         break;
 
       case RenderMode::CustomDrawing:
-      case RenderMode::NonTexturedRender:
-        // No batching yet for NonTexturedRender, and we aren't meant to ever
-        // see mRenderMode set to CustomDrawing.
+        // We aren't meant to ever see mRenderMode set to CustomDrawing.
         assert(false);
         break;
     }
 
     mBatchData.clear();
     mBatchSize = 0;
+    mNumBatchTextures = 0;
+  }
+
+
+  /** Copy vertices into the stream buffer, and point vertex attributes at them
+   *
+   * Uses the vertex layout of the currently active shader.
+   */
+  void uploadVertices(const void* pVertices, const std::size_t size)
+  {
+    const auto offset = mStreamBuffer.upload(pVertices, size);
+    setVertexLayout(shaderToUse(mStateStack.back()).vertexLayout(), offset);
   }
 
 
   void
     drawFilledRectangle(const base::Rect<int>& rect, const base::Color& color)
   {
-    // Note: No batching for now
-    updateState(mRenderMode, RenderMode::NonTexturedRender);
-    commitChangedState();
-
     const auto left = float(rect.left());
     const auto right = float(rect.right()) + 1.0f;
     const auto top = float(rect.top());
     const auto bottom = float(rect.bottom()) + 1.0f;
 
     const auto colorVec = toGlColor(color);
+    // clang-format off
     float vertices[] = {
       left,  bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       right, bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       left,  top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
+      right, bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       right, top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
+      left,  top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
     };
+    // clang-format on
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    addSolidColorVertices(RenderMode::NonTexturedRender, vertices);
   }
 
 
   void drawRectangle(const base::Rect<int>& rect, const base::Color& color)
   {
-    // Note: No batching for now, drawRectangle is only used for debugging at
-    // the moment
-    updateState(mRenderMode, RenderMode::NonTexturedRender);
-    commitChangedState();
-
     const auto left = float(rect.left());
     const auto right = float(rect.right());
     const auto top = float(rect.top());
     const auto bottom = float(rect.bottom());
 
+    // Each line segment leaves out its last pixel, which is then covered by
+    // the start of the next segment. This gives the same result as drawing
+    // a closed line strip, without any pixel being drawn twice.
     const auto colorVec = toGlColor(color);
+    // clang-format off
     float vertices[] = {
       left,  top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       left,  bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
+      left,  bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
+      right, bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       right, bottom, colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       right, top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
+      right, top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       left,  top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a};
+    // clang-format on
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
-    glDrawArrays(GL_LINE_STRIP, 0, 5);
+    addSolidColorVertices(RenderMode::Lines, vertices);
   }
 
 
@@ -487,11 +1027,6 @@ struct Renderer::Impl
     const int y2,
     const base::Color& color)
   {
-    // Note: No batching for now, drawLine is only used for debugging at the
-    // moment
-    updateState(mRenderMode, RenderMode::NonTexturedRender);
-    commitChangedState();
-
     const auto colorVec = toGlColor(color);
 
     // clang-format off
@@ -501,15 +1036,12 @@ struct Renderer::Impl
     };
     // clang-format on
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
-    glDrawArrays(GL_LINE_STRIP, 0, 2);
+    addSolidColorVertices(RenderMode::Lines, vertices);
   }
 
 
   void drawPoint(const base::Vec2& position, const base::Color& color)
   {
-    updateState(mRenderMode, RenderMode::Points);
-
     float vertices[] = {
       float(position.x),
       float(position.y),
@@ -517,6 +1049,37 @@ struct Renderer::Impl
       color.g / 255.0f,
       color.b / 255.0f,
       color.a / 255.0f};
+
+    addSolidColorVertices(RenderMode::Points, vertices);
+  }
+
+
+  /** Append vertices to the current solid color batch
+   *
+   * Starts a new batch if the current one uses a different primitive type,
+   * or is full. All solid color primitives share the same vertex format,
+   * position (x, y) followed by color (r, g, b, a).
+   */
+  template <std::size_t N>
+  void addSolidColorVertices(const RenderMode mode, const float (&vertices)[N])
+  {
+    static_assert(N % SOLID_COLOR_VERTEX_SIZE == 0);
+
+    flushDeferredDraws(BatchBreakReason::StateChange);
+    updateState(mRenderMode, mode);
+
+    if (
+      mBatchData.size() + N >
+      MAX_SOLID_COLOR_VERTICES_PER_BATCH * SOLID_COLOR_VERTEX_SIZE)
+    {
+      submitPendingBatch(BatchBreakReason::BatchFull);
+    }
+
+    if (mCapture && mode == RenderMode::NonTexturedRender)
+    {
+      addTrianglesToCapturedPixels(vertices, N);
+    }
+
     mBatchData.insert(
       std::end(mBatchData), std::begin(vertices), std::end(vertices));
   }
@@ -530,7 +1093,9 @@ struct Renderer::Impl
     // drawing command
     mLastKnownRenderMode = RenderMode::CustomDrawing;
     mLastUsedTexture = 0;
+    mBoundTextures.fill(0);
     mStateChanged = true;
+    setExtraVertexAttributeEnabled(false);
 
     // Bind textures
 
@@ -547,22 +1112,26 @@ struct Renderer::Impl
 
 
     // Submit vertex buffer
-    setVertexLayout(batch.mpShader->vertexLayout());
-
     const auto numQuads =
       batch.mVertexBuffer.size() / std::tuple_size<QuadVertices>::value;
     const auto numIndices = GLsizei(numQuads * std::size(QUAD_INDICES));
     assert(numIndices < GLsizei(MAX_BATCH_SIZE));
 
-    glBufferData(
-      GL_ARRAY_BUFFER,
-      sizeof(float) * batch.mVertexBuffer.size(),
-      batch.mVertexBuffer.data(),
-      GL_STREAM_DRAW);
+    const auto offset = mStreamBuffer.upload(
+      batch.mVertexBuffer.data(), sizeof(float) * batch.mVertexBuffer.size());
+    setVertexLayout(batch.mpShader->vertexLayout(), offset);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
     glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, nullptr);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    ++mNumDrawCalls;
+
+    if (mCapture)
+    {
+      auto& event = recordCaptureEvent(CaptureEventType::DrawCustomQuads);
+      event.mResourceId = batch.mTextures.empty() ? 0 : batch.mTextures[0];
+      event.mVertexCount = std::uint32_t(numIndices);
+    }
   }
 
 
@@ -572,19 +1141,57 @@ struct Renderer::Impl
   {
     updateState(mRenderMode, RenderMode::SpriteBatch);
 
+    flushDeferredDraws();
+
     if (texture != mLastUsedTexture)
     {
-      submitBatch();
-
-      glBindTexture(GL_TEXTURE_2D, texture);
-      mLastUsedTexture = texture;
+      submitPendingBatch(BatchBreakReason::TextureChange);
+      bindTexture(texture);
     }
 
     commitChangedState();
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
+    drawVertexBuffers(
+      buffers, shaderToUse(mStateStack.back()).vertexLayout());
+  }
 
-    const auto layout = shaderToUse(mStateStack.back()).vertexLayout();
+
+  void submitVertexBuffers(
+    const base::ArrayView<VertexBufferId> buffers,
+    const TextureId texture,
+    const Shader& shader)
+  {
+    submitBatch();
+
+    // Trigger committing render state again with the next regular
+    // drawing command
+    mLastKnownRenderMode = RenderMode::CustomDrawing;
+    mStateChanged = true;
+
+    if (texture != mLastUsedTexture)
+    {
+      bindTexture(texture);
+    }
+
+    // Submitting the batch might have activated one of the built-in shaders
+    shader.use();
+    if (mCapture)
+    {
+      recordShaderSelection(shader);
+    }
+
+    setExtraVertexAttributeEnabled(
+      hasExtraVertexAttribute(shader.vertexLayout()));
+
+    drawVertexBuffers(buffers, shader.vertexLayout());
+  }
+
+
+  void drawVertexBuffers(
+    const base::ArrayView<VertexBufferId> buffers,
+    const VertexLayout layout)
+  {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
 
     for (const auto buffer : buffers)
     {
@@ -593,23 +1200,44 @@ struct Renderer::Impl
       glBindBuffer(GL_ARRAY_BUFFER, vbo);
       setVertexLayout(layout);
       glDrawElements(GL_TRIANGLES, size, GL_UNSIGNED_SHORT, nullptr);
+      ++mNumDrawCalls;
+
+      if (mCapture)
+      {
+        auto& event = recordCaptureEvent(CaptureEventType::DrawVertexBuffer);
+        event.mResourceId = mLastUsedTexture;
+        event.mVertexCount = size;
+      }
     }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer.handle());
     setVertexLayout(layout);
   }
 
 
-  void pushState() { mStateStack.push_back(mStateStack.back()); }
+  void pushState()
+  {
+    mStateStack.push_back(mStateStack.back());
+
+    if (mCapture)
+    {
+      recordCaptureEvent(CaptureEventType::PushState);
+    }
+  }
 
 
   void popState()
   {
     assert(mStateStack.size() > 1);
 
-    submitBatch();
+    submitPendingBatch(BatchBreakReason::StateChange);
+
+    if (mCapture)
+    {
+      recordCaptureEvent(CaptureEventType::PopState);
+    }
 
     mStateChanged = mStateStack.back() != *std::prev(mStateStack.end(), 2);
     mStateStack.pop_back();
@@ -618,7 +1246,7 @@ struct Renderer::Impl
 
   void resetState()
   {
-    submitBatch();
+    submitPendingBatch(BatchBreakReason::StateChange);
 
     const auto defaultState = State{};
 
@@ -670,6 +1298,13 @@ struct Renderer::Impl
 
   void setRenderTarget(const TextureId target)
   {
+    // The target might be used as a texture by deferred draws, or vice versa,
+    // so these can't be reordered across render target changes
+    if (target != mStateStack.back().mRenderTargetTexture)
+    {
+      flushDeferredDraws(BatchBreakReason::StateChange);
+    }
+
     updateState(mStateStack.back().mRenderTargetTexture, target);
   }
 
@@ -693,7 +1328,7 @@ struct Renderer::Impl
   {
     if (state != newValue)
     {
-      submitBatch();
+      submitPendingBatch(BatchBreakReason::StateChange);
 
       state = newValue;
       mStateChanged = true;
@@ -705,7 +1340,24 @@ struct Renderer::Impl
   {
     assert(mStateStack.back().mRenderTargetTexture == 0);
 
-    submitBatch();
+    submitBatch(BatchBreakReason::EndOfFrame);
+
+    base::profiler::recordCounter("Renderer draw calls", mNumDrawCalls);
+    base::profiler::recordCounter("Renderer state commits", mNumStateCommits);
+    base::profiler::recordCounter(
+      "Renderer texture switches", mNumTextureSwitches);
+    mNumDrawCalls = 0;
+    mNumStateCommits = 0;
+    mNumTextureSwitches = 0;
+
+    const auto streamStats = mStreamBuffer.finishFrame();
+    base::profiler::recordCounter(
+      "Stream buffer bytes uploaded",
+      std::int64_t(streamStats.mBytesUploaded));
+    base::profiler::recordCounter(
+      "Stream buffer stalls", streamStats.mNumStalls);
+    base::profiler::recordCounter("Stream buffer wraps", streamStats.mNumWraps);
+
     SDL_GL_SwapWindow(mpWindow);
 
     const auto actualWindowSize = getSize(mpWindow);
@@ -714,13 +1366,135 @@ struct Renderer::Impl
       mWindowSize = actualWindowSize;
       mStateChanged = true;
     }
+
+    updateFrameCapture();
+  }
+
+
+  void updateFrameCapture()
+  {
+    if (mCapture)
+    {
+      mFinishedCapture = std::move(mCapture);
+      mCapture.reset();
+
+      if (!mProfilerWasEnabled)
+      {
+        base::profiler::setEnabled(false);
+      }
+    }
+
+    if (mCaptureRequested)
+    {
+      mCaptureRequested = false;
+      mProfilerWasEnabled = base::profiler::isEnabled();
+      base::profiler::setEnabled(true);
+
+      mCapture = FrameCapture{mWindowSize, {}};
+      mPixelsInBatch = 0;
+    }
+  }
+
+
+  CaptureEvent& recordCaptureEvent(
+    const CaptureEventType type,
+    const BatchBreakReason reason = BatchBreakReason::None)
+  {
+    auto& event = mCapture->mEvents.emplace_back();
+    event.mType = type;
+    event.mBreakReason = reason;
+
+    if (const auto pCallSite = base::profiler::currentScope())
+    {
+      event.mCallSite = pCallSite;
+    }
+
+    return event;
+  }
+
+
+  void recordBatchSubmission(const BatchBreakReason reason)
+  {
+    auto& event = recordCaptureEvent(captureEventType(mRenderMode), reason);
+    event.mPixelsCovered = mPixelsInBatch;
+
+    switch (mRenderMode)
+    {
+      case RenderMode::SpriteBatch:
+        event.mResourceId = mLastUsedTexture;
+        event.mVertexCount = mBatchSize;
+        break;
+
+      case RenderMode::MultiTextureSpriteBatch:
+        event.mVertexCount = mBatchSize;
+        break;
+
+      default:
+        event.mVertexCount =
+          std::uint32_t(mBatchData.size() / SOLID_COLOR_VERTEX_SIZE);
+        break;
+    }
+
+    mPixelsInBatch = 0;
+  }
+
+
+  void recordShaderSelection(const Shader& shader)
+  {
+    auto& event = recordCaptureEvent(CaptureEventType::SelectShader);
+    event.mResourceId = shader.handle();
+  }
+
+
+  void addQuadToCapturedPixels(const QuadVertices& vertices)
+  {
+    // See createTexturedQuadVertices() for the vertex order
+    const auto width = std::abs(vertices[8] - vertices[0]);
+    const auto height = std::abs(vertices[1] - vertices[5]);
+    addAreaToCapturedPixels(width * height);
+  }
+
+
+  void addTrianglesToCapturedPixels(const float* pVertices, std::size_t size)
+  {
+    constexpr auto TRIANGLE_SIZE = 3 * SOLID_COLOR_VERTEX_SIZE;
+
+    auto area = 0.0f;
+    for (auto i = std::size_t{0}; i + TRIANGLE_SIZE <= size;
+         i += TRIANGLE_SIZE)
+    {
+      const auto pA = pVertices + i;
+      const auto pB = pA + SOLID_COLOR_VERTEX_SIZE;
+      const auto pC = pB + SOLID_COLOR_VERTEX_SIZE;
+      area += std::abs(
+                (pB[0] - pA[0]) * (pC[1] - pA[1]) -
+                (pC[0] - pA[0]) * (pB[1] - pA[1])) /
+        2.0f;
+    }
+
+    addAreaToCapturedPixels(area);
+  }
+
+
+  void addAreaToCapturedPixels(const float area)
+  {
+    const auto& scale = mStateStack.back().mGlobalScale;
+    mPixelsInBatch += std::uint32_t(area * std::abs(scale.x * scale.y));
   }
 
 
   void clear(const base::Color& clearColor)
   {
+    flushDeferredDraws();
     commitChangedState();
 
+    if (mCapture)
+    {
+      auto& event = recordCaptureEvent(CaptureEventType::Clear);
+      event.mResourceId = mStateStack.back().mRenderTargetTexture;
+      event.mSize = currentRenderTargetSize();
+    }
+
     const auto glColor = toGlColor(clearColor);
     glClearColor(glColor.r, glColor.g, glColor.b, glColor.a);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -734,6 +1508,8 @@ struct Renderer::Impl
       return;
     }
 
+    ++mNumStateCommits;
+
     const auto& state = mStateStack.back();
 
     auto transformNeedsUpdate =
@@ -754,6 +1530,14 @@ struct Renderer::Impl
 
       commitRenderTarget(state);
       glViewport(0, 0, framebufferSize.width, framebufferSize.height);
+
+      if (mCapture)
+      {
+        auto& event = recordCaptureEvent(CaptureEventType::SetRenderTarget);
+        event.mResourceId = state.mRenderTargetTexture;
+        event.mSize = framebufferSize;
+      }
+
       commitClipRect(state, framebufferSize);
       commitVertexAttributeFormat(state);
 
@@ -850,8 +1634,12 @@ struct Renderer::Impl
 
         return mSimpleTexturedQuadShader;
 
-      case RenderMode::Points:
+      case RenderMode::MultiTextureSpriteBatch:
+        return mMultiTexturedQuadShader;
+
       case RenderMode::NonTexturedRender:
+      case RenderMode::Lines:
+      case RenderMode::Points:
         return mSolidColorShader;
 
       default:
@@ -869,11 +1657,39 @@ struct Renderer::Impl
   }
 
 
+  void setExtraVertexAttributeEnabled(const bool enabled)
+  {
+    if (enabled == mExtraVertexAttributeEnabled)
+    {
+      return;
+    }
+
+    if (enabled)
+    {
+      glEnableVertexAttribArray(2);
+    }
+    else
+    {
+      glDisableVertexAttribArray(2);
+    }
+
+    mExtraVertexAttributeEnabled = enabled;
+  }
+
+
   void commitShaderSelection(const State& state)
   {
     auto& shader = shaderToUse(state);
     shader.use();
+
+    if (mCapture)
+    {
+      recordShaderSelection(shader);
+    }
+
     setVertexLayout(shader.vertexLayout());
+    setExtraVertexAttributeEnabled(
+      hasExtraVertexAttribute(shader.vertexLayout()));
 
     if (shader.handle() == mTexturedQuadShader.handle())
     {
@@ -897,7 +1713,9 @@ struct Renderer::Impl
   }
 
 
-  VertexBufferId createVertexBuffer(const base::ArrayView<float> vertices)
+  VertexBufferId createVertexBuffer(
+    const base::ArrayView<float> vertices,
+    const VertexLayout layout)
   {
     GLuint vbo = 0;
     glGenBuffers(1, &vbo);
@@ -908,11 +1726,11 @@ struct Renderer::Impl
       sizeof(float) * vertices.size(),
       vertices.data(),
       GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamBuffer.handle());
 
-    const auto size = uint16_t(
-      vertices.size() / std::tuple_size<renderer::QuadVertices>::value *
-      std::size(QUAD_INDICES));
+    const auto floatsPerQuad = std::size_t(4 * floatsPerVertex(layout));
+    const auto size =
+      uint16_t(vertices.size() / floatsPerQuad * std::size(QUAD_INDICES));
 
     ++mNumVbos;
 
@@ -990,6 +1808,48 @@ struct Renderer::Impl
   }
 
 
+  TextureId createDataTexture(
+    const int width,
+    const int height,
+    base::ArrayView<std::uint8_t> rgbaData)
+  {
+    submitBatch();
+
+    // Unlike image textures, data textures are not flipped. Shaders look up
+    // texels using the same layout as the data passed in here.
+    const auto handle =
+      createGlTexture(GLsizei(width), GLsizei(height), rgbaData.data());
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+
+    ++mNumTextures;
+    return handle;
+  }
+
+
+  void updateDataTexture(
+    const TextureId texture,
+    const base::Rect<int>& area,
+    base::ArrayView<std::uint8_t> rgbaData)
+  {
+    assert(rgbaData.size() == size_t(area.size.width * area.size.height * 4));
+
+    submitBatch();
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(
+      GL_TEXTURE_2D,
+      0,
+      area.topLeft.x,
+      area.topLeft.y,
+      area.size.width,
+      area.size.height,
+      GL_RGBA,
+      GL_UNSIGNED_BYTE,
+      rgbaData.data());
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+  }
+
+
   void destroyTexture(TextureId texture)
   {
     submitBatch();
@@ -1005,6 +1865,8 @@ struct Renderer::Impl
       --mNumTextures;
     }
 
+    // Deleting a texture unbinds it from all texture units
+    std::replace(mBoundTextures.begin(), mBoundTextures.end(), texture, 0u);
     glDeleteTextures(1, &texture);
   }
 
@@ -1106,6 +1968,18 @@ void Renderer::submitBatch()
 }
 
 
+void Renderer::setDeferredBatchingEnabled(const bool enabled)
+{
+  mpImpl->setDeferredBatchingEnabled(enabled);
+}
+
+
+void Renderer::setMultiTextureBatchingEnabled(const bool enabled)
+{
+  mpImpl->setMultiTextureBatchingEnabled(enabled);
+}
+
+
 void Renderer::drawFilledRectangle(
   const base::Rect<int>& rect,
   const base::Color& color)
@@ -1153,6 +2027,15 @@ void Renderer::submitVertexBuffers(
 }
 
 
+void Renderer::submitVertexBuffers(
+  const base::ArrayView<VertexBufferId> buffers,
+  const TextureId texture,
+  const Shader& shader)
+{
+  mpImpl->submitVertexBuffers(buffers, texture, shader);
+}
+
+
 void Renderer::pushState()
 {
   mpImpl->pushState();
@@ -1247,10 +2130,24 @@ void Renderer::clear(const base::Color& clearColor)
 }
 
 
+void Renderer::requestFrameCapture()
+{
+  mpImpl->mCaptureRequested = true;
+}
+
+
+std::optional<FrameCapture> Renderer::takeFrameCapture()
+{
+  return std::exchange(mpImpl->mFinishedCapture, std::nullopt);
+}
+
+
 VertexBufferId
-  Renderer::createVertexBuffer(const base::ArrayView<float> vertices)
+  Renderer::createVertexBuffer(
+    const base::ArrayView<float> vertices,
+    const VertexLayout layout)
 {
-  return mpImpl->createVertexBuffer(vertices);
+  return mpImpl->createVertexBuffer(vertices, layout);
 }
 
 
@@ -1281,6 +2178,24 @@ TextureId Renderer::createMonoTexture(
 }
 
 
+TextureId Renderer::createDataTexture(
+  const int width,
+  const int height,
+  base::ArrayView<std::uint8_t> rgbaData)
+{
+  return mpImpl->createDataTexture(width, height, rgbaData);
+}
+
+
+void Renderer::updateDataTexture(
+  const TextureId texture,
+  const base::Rect<int>& area,
+  base::ArrayView<std::uint8_t> rgbaData)
+{
+  mpImpl->updateDataTexture(texture, area, rgbaData);
+}
+
+
 void Renderer::destroyTexture(TextureId texture)
 {
   mpImpl->destroyTexture(texture);
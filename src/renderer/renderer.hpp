@@ -21,6 +21,7 @@
 #include "base/defer.hpp"
 #include "base/image.hpp"
 #include "base/warnings.hpp"
+#include "renderer/frame_capture.hpp"
 #include "renderer/renderer_support.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -106,10 +107,26 @@ public:
     base::ArrayView<VertexBufferId> buffers,
     TextureId texture);
 
+  /** Draw vertex buffers using a custom shader
+   *
+   * The shader needs to be active, with all of its uniforms (including the
+   * transformation matrix) already set. The given texture is bound to
+   * texture unit 0. The buffers must have been created with the shader's
+   * vertex layout.
+   *
+   * Renderer state other than the clip rect and render target is not
+   * taken into account.
+   */
+  void submitVertexBuffers(
+    base::ArrayView<VertexBufferId> buffers,
+    TextureId texture,
+    const Shader& shader);
+
   /** Draw rectangle outline, 1 pixel wide
    *
-   * _Warning_: Does not support batching, use sparingly or only for
-   * debugging.
+   * Supports batching: Consecutive calls to drawRectangle() and drawLine()
+   * will be combined into a single OpenGL draw call.
+   * Changing any state will interrupt the current batch.
    *
    * Rectangle coordinates are modified by the current global scale
    * and translation.
@@ -119,8 +136,9 @@ public:
 
   /** Draw filled rectangle
    *
-   * _Warning_: Does not support batching, use sparingly or only for
-   * debugging.
+   * Supports batching: Multiple calls to this function will be combined
+   * into a single vertex buffer and OpenGL draw call.
+   * Changing any state will interrupt the current batch.
    *
    * Rectangle coordinates are modified by the current global scale
    * and translation.
@@ -131,8 +149,9 @@ public:
 
   /** Draw line, 1 pixel wide
    *
-   * _Warning_: Does not support batching, use sparingly or only for
-   * debugging.
+   * Supports batching: Consecutive calls to drawRectangle() and drawLine()
+   * will be combined into a single OpenGL draw call.
+   * Changing any state will interrupt the current batch.
    *
    * Coordinates are modified by the current global scale and
    * translation.
@@ -173,10 +192,44 @@ public:
    */
   void submitBatch();
 
+  /** Enable/disable reordering of draw calls for better batching
+   *
+   * When enabled, drawTexture() calls are recorded instead of being
+   * batched immediately. When the recorded draws are submitted (on
+   * swapBuffers(), submitBatch(), a render target change, or any drawing
+   * function other than drawTexture()), they are grouped by texture and
+   * renderer state, and each group is rendered with a single draw call.
+   * State changes between drawTexture() calls don't interrupt batching in
+   * this mode.
+   *
+   * Draws are only moved in front of other draws which they don't
+   * overlap, so the result is the same as without reordering.
+   *
+   * Disabled by default.
+   */
+  void setDeferredBatchingEnabled(bool enabled);
+
+  /** Enable/disable batching of draws using different textures
+   *
+   * When enabled, drawTexture() calls using up to MAX_MULTI_TEXTURES
+   * different textures are combined into a single draw call, by binding
+   * each texture to its own texture unit. Switching textures then doesn't
+   * interrupt the current batch anymore.
+   *
+   * Only applies while no color modulation, overlay color or texture
+   * repeat is active, drawTexture() calls made with any of these use
+   * regular batching.
+   *
+   * Disabled by default.
+   */
+  void setMultiTextureBatchingEnabled(bool enabled);
+
   // Resource management API
   ////////////////////////////////////////////////////////////////////////
 
-  VertexBufferId createVertexBuffer(base::ArrayView<float> vertices);
+  VertexBufferId createVertexBuffer(
+    base::ArrayView<float> vertices,
+    VertexLayout layout = VertexLayout::PositionAndTexCoords);
   void destroyVertexBuffer(const VertexBufferId buffer);
 
   /** Create a texture
@@ -208,6 +261,26 @@ public:
     int height,
     base::ArrayView<std::uint8_t> data);
 
+  /** Create a texture holding arbitrary data for use by custom shaders
+   *
+   * The data is given as 4 bytes (RGBA) per texel. In contrast to
+   * createTexture(), it's uploaded as is without flipping, so the first row
+   * of data ends up at texture coordinate 0.
+   */
+  TextureId createDataTexture(
+    int width,
+    int height,
+    base::ArrayView<std::uint8_t> rgbaData);
+
+  /** Replace part of a texture created via createDataTexture()
+   *
+   * The data must contain 4 bytes for each texel in the given area.
+   */
+  void updateDataTexture(
+    TextureId texture,
+    const base::Rect<int>& area,
+    base::ArrayView<std::uint8_t> rgbaData);
+
   /** Destroy a previously created texture or render target
    *
    * This is a low-level API. Using the Texture and RenderTarget classes
@@ -372,6 +445,27 @@ public:
   base::Vec2f globalScale() const;
   std::optional<base::Rect<int>> clipRect() const;
 
+  // Debugging API
+  ////////////////////////////////////////////////////////////////////////
+
+  /** Record all draw calls and state changes of the next frame
+   *
+   * Recording starts with the next call to swapBuffers(), and ends with
+   * the one after that. The result can then be retrieved via
+   * takeFrameCapture(). See frame_capture.hpp.
+   *
+   * Call sites are determined via the profiler, so profiling is enabled
+   * while recording, if it isn't already.
+   */
+  void requestFrameCapture();
+
+  /** Returns the most recently finished capture, if any
+   *
+   * A capture can only be taken once, subsequent calls return nothing until
+   * another capture has finished.
+   */
+  std::optional<FrameCapture> takeFrameCapture();
+
 private:
   struct Impl;
   std::unique_ptr<Impl> mpImpl;
@@ -19,6 +19,7 @@
 #include "base/array_view.hpp"
 #include "base/spatial_types.hpp"
 
+#include <array>
 #include <cstdint>
 
 
@@ -34,6 +35,16 @@ constexpr auto MAX_MULTI_TEXTURES = 8;
 
 using TextureId = std::uint32_t;
 
+
+enum class VertexLayout
+{
+  PositionAndTexCoords,
+  PositionAndColor,
+  PositionTexCoordsAndTextureIndex,
+  PositionTexCoordsAndAnimationType
+};
+
+
 /** Texture coordinates for Renderer::drawTexture()
  *
  * Values should be in range [0.0, 1.0] - unless texture repeat is
@@ -167,6 +167,18 @@ Shader::Shader(const ShaderSpec& spec)
       glBindAttribLocation(mProgram.mHandle, 0, "position");
       glBindAttribLocation(mProgram.mHandle, 1, "color");
       break;
+
+    case VertexLayout::PositionTexCoordsAndTextureIndex:
+      glBindAttribLocation(mProgram.mHandle, 0, "position");
+      glBindAttribLocation(mProgram.mHandle, 1, "texCoord");
+      glBindAttribLocation(mProgram.mHandle, 2, "textureIndex");
+      break;
+
+    case VertexLayout::PositionTexCoordsAndAnimationType:
+      glBindAttribLocation(mProgram.mHandle, 0, "position");
+      glBindAttribLocation(mProgram.mHandle, 1, "texCoord");
+      glBindAttribLocation(mProgram.mHandle, 2, "animationType");
+      break;
   }
 
   glLinkProgram(mProgram.mHandle);
@@ -21,6 +21,7 @@
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "renderer/opengl.hpp"
+#include "renderer/renderer_support.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <glm/gtc/type_ptr.hpp>
@@ -69,13 +70,6 @@ private:
 };
 
 
-enum class VertexLayout
-{
-  PositionAndTexCoords,
-  PositionAndColor
-};
-
-
 struct ShaderSpec
 {
   VertexLayout mVertexLayout;
@@ -16,6 +16,8 @@
 
 #include "shader_code.hpp"
 
+#include "renderer/renderer_support.hpp"
+
 #include <array>
 
 
@@ -67,6 +69,64 @@ void main() {
 }
 )shd";
 
+const char* VERTEX_SOURCE_MULTI_TEXTURED = R"shd(
+ATTRIBUTE HIGHP vec2 position;
+ATTRIBUTE HIGHP vec2 texCoord;
+ATTRIBUTE float textureIndex;
+
+OUT HIGHP vec2 texCoordFrag;
+OUT float textureIndexFrag;
+
+uniform mat4 transform;
+
+void main() {
+  gl_Position = transform * vec4(position, 0.0, 1.0);
+  texCoordFrag = vec2(texCoord.x, 1.0 - texCoord.y);
+  textureIndexFrag = textureIndex;
+}
+)shd";
+
+
+const char* FRAGMENT_SOURCE_MULTI_TEXTURED = R"shd(
+DEFAULT_PRECISION_DECLARATION
+OUTPUT_COLOR_DECLARATION
+
+IN HIGHP vec2 texCoordFrag;
+IN float textureIndexFrag;
+
+uniform sampler2D textureData0;
+uniform sampler2D textureData1;
+uniform sampler2D textureData2;
+uniform sampler2D textureData3;
+uniform sampler2D textureData4;
+uniform sampler2D textureData5;
+uniform sampler2D textureData6;
+uniform sampler2D textureData7;
+
+void main() {
+  // GLSL 1.30 and GLSL ES 1.00 only allow selecting a sampler via constant
+  // expressions, so we can't use an array indexed by textureIndexFrag.
+  if (textureIndexFrag < 0.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData0, texCoordFrag);
+  } else if (textureIndexFrag < 1.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData1, texCoordFrag);
+  } else if (textureIndexFrag < 2.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData2, texCoordFrag);
+  } else if (textureIndexFrag < 3.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData3, texCoordFrag);
+  } else if (textureIndexFrag < 4.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData4, texCoordFrag);
+  } else if (textureIndexFrag < 5.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData5, texCoordFrag);
+  } else if (textureIndexFrag < 6.5) {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData6, texCoordFrag);
+  } else {
+    OUTPUT_COLOR = TEXTURE_LOOKUP(textureData7, texCoordFrag);
+  }
+}
+)shd";
+
+
 const char* VERTEX_SOURCE_SOLID = R"shd(
 ATTRIBUTE vec2 position;
 ATTRIBUTE vec4 color;
@@ -96,6 +156,19 @@ void main() {
 
 constexpr auto TEXTURED_QUAD_TEXTURE_UNIT_NAMES = std::array{"textureData"};
 
+constexpr auto MULTI_TEXTURED_QUAD_TEXTURE_UNIT_NAMES = std::array{
+  "textureData0",
+  "textureData1",
+  "textureData2",
+  "textureData3",
+  "textureData4",
+  "textureData5",
+  "textureData6",
+  "textureData7"};
+
+static_assert(
+  MULTI_TEXTURED_QUAD_TEXTURE_UNIT_NAMES.size() == MAX_MULTI_TEXTURES);
+
 } // namespace
 
 
@@ -128,6 +201,13 @@ const ShaderSpec SIMPLE_TEXTURED_QUAD_SHADER{
   FRAGMENT_SOURCE_SIMPLE};
 
 
+const ShaderSpec MULTI_TEXTURED_QUAD_SHADER{
+  VertexLayout::PositionTexCoordsAndTextureIndex,
+  MULTI_TEXTURED_QUAD_TEXTURE_UNIT_NAMES,
+  VERTEX_SOURCE_MULTI_TEXTURED,
+  FRAGMENT_SOURCE_MULTI_TEXTURED};
+
+
 const ShaderSpec SOLID_COLOR_SHADER{
   VertexLayout::PositionAndColor,
   {},
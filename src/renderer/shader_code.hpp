@@ -26,6 +26,7 @@ extern const char* STANDARD_VERTEX_SOURCE;
 
 extern const ShaderSpec TEXTURED_QUAD_SHADER;
 extern const ShaderSpec SIMPLE_TEXTURED_QUAD_SHADER;
+extern const ShaderSpec MULTI_TEXTURED_QUAD_SHADER;
 extern const ShaderSpec SOLID_COLOR_SHADER;
 
 } // namespace rigel::renderer
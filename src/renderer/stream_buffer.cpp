@@ -0,0 +1,269 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stream_buffer.hpp"
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <SDL_video.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cassert>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+
+namespace rigel::renderer
+{
+
+namespace
+{
+
+#ifndef RIGEL_USE_GL_ES
+
+constexpr auto SEGMENT_SIZE = StreamBuffer::MAX_UPLOAD_SIZE;
+constexpr auto BUFFER_SIZE = SEGMENT_SIZE * StreamBuffer::NUM_SEGMENTS;
+constexpr auto UPLOAD_ALIGNMENT = std::size_t{16};
+constexpr auto WAIT_TIMEOUT_NS = GLuint64{1'000'000'000};
+
+// Our GL loader is generated for OpenGL 3.0, which doesn't include the
+// functionality needed for persistent mapping. We load it ourselves if the
+// driver offers it.
+constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+constexpr GLenum SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+constexpr GLenum TIMEOUT_EXPIRED = 0x911B;
+constexpr GLbitfield SYNC_FLUSH_COMMANDS_BIT = 0x0001;
+
+using BufferStorageFunc =
+  void(KHRONOS_APIENTRY*)(GLenum, GLsizeiptr, const void*, GLbitfield);
+using FenceSyncFunc = GLsync(KHRONOS_APIENTRY*)(GLenum, GLbitfield);
+using ClientWaitSyncFunc =
+  GLenum(KHRONOS_APIENTRY*)(GLsync, GLbitfield, GLuint64);
+using DeleteSyncFunc = void(KHRONOS_APIENTRY*)(GLsync);
+
+BufferStorageFunc gBufferStorage = nullptr;
+FenceSyncFunc gFenceSync = nullptr;
+ClientWaitSyncFunc gClientWaitSync = nullptr;
+DeleteSyncFunc gDeleteSync = nullptr;
+
+
+template <typename FuncT>
+void loadFunction(FuncT& pFunction, const char* name)
+{
+  pFunction = reinterpret_cast<FuncT>(SDL_GL_GetProcAddress(name));
+}
+
+
+bool loadPersistentMappingFunctions()
+{
+  GLint majorVersion = 0;
+  GLint minorVersion = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+  glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+  const auto version = std::tie(majorVersion, minorVersion);
+  const auto hasBufferStorage = version >= std::tuple{4, 4} ||
+    SDL_GL_ExtensionSupported("GL_ARB_buffer_storage");
+  const auto hasSync =
+    version >= std::tuple{3, 2} || SDL_GL_ExtensionSupported("GL_ARB_sync");
+
+  if (!hasBufferStorage || !hasSync)
+  {
+    return false;
+  }
+
+  loadFunction(gBufferStorage, "glBufferStorage");
+  loadFunction(gFenceSync, "glFenceSync");
+  loadFunction(gClientWaitSync, "glClientWaitSync");
+  loadFunction(gDeleteSync, "glDeleteSync");
+
+  return gBufferStorage && gFenceSync && gClientWaitSync && gDeleteSync;
+}
+
+
+std::size_t alignedOffset(const std::size_t offset)
+{
+  return (offset + UPLOAD_ALIGNMENT - 1) / UPLOAD_ALIGNMENT * UPLOAD_ALIGNMENT;
+}
+
+#endif
+
+} // namespace
+
+
+StreamBuffer::StreamBuffer()
+{
+  glGenBuffers(1, &mBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+
+#ifndef RIGEL_USE_GL_ES
+  if (loadPersistentMappingFunctions())
+  {
+    const auto flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+    gBufferStorage(GL_ARRAY_BUFFER, BUFFER_SIZE, nullptr, flags);
+    mpMappedData = static_cast<std::uint8_t*>(
+      glMapBufferRange(GL_ARRAY_BUFFER, 0, BUFFER_SIZE, flags));
+
+    if (mpMappedData)
+    {
+      mMode = Mode::PersistentMapping;
+      return;
+    }
+
+    // Storage created via glBufferStorage is immutable, so we need a new
+    // buffer for the fallback
+    glDeleteBuffers(1, &mBuffer);
+    glGenBuffers(1, &mBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+  }
+
+  glBufferData(GL_ARRAY_BUFFER, BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+  mMode = Mode::UnsynchronizedMapping;
+#endif
+}
+
+
+StreamBuffer::~StreamBuffer()
+{
+#ifndef RIGEL_USE_GL_ES
+  for (const auto fence : mSegmentFences)
+  {
+    if (fence)
+    {
+      gDeleteSync(fence);
+    }
+  }
+#endif
+
+  glDeleteBuffers(1, &mBuffer);
+}
+
+
+std::uintptr_t StreamBuffer::upload(const void* pData, const std::size_t size)
+{
+  assert(size <= MAX_UPLOAD_SIZE);
+
+  mStats.mBytesUploaded += size;
+
+  if (mMode == Mode::Respecify)
+  {
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size), pData, GL_STREAM_DRAW);
+    return 0;
+  }
+
+#ifdef RIGEL_USE_GL_ES
+  return 0;
+#else
+  if (size == 0)
+  {
+    return 0;
+  }
+
+  auto offset = alignedOffset(mWritePosition);
+
+  if (mMode == Mode::PersistentMapping)
+  {
+    // Uploads must not straddle a segment boundary. Otherwise, the fence for
+    // the segment the upload starts in would be inserted before the draw
+    // call reading the upload, and could signal before the GPU is done with
+    // the data. Since uploads are never larger than a segment, moving on to
+    // the start of the next segment is always sufficient.
+    const auto firstSegment = offset / SEGMENT_SIZE;
+    if ((offset + size - 1) / SEGMENT_SIZE != firstSegment)
+    {
+      offset = (firstSegment + 1) * SEGMENT_SIZE;
+    }
+  }
+
+  if (offset + size > BUFFER_SIZE)
+  {
+    offset = 0;
+    ++mStats.mNumWraps;
+
+    if (mMode == Mode::UnsynchronizedMapping)
+    {
+      // Orphan the buffer. The driver gives us new storage, and keeps the
+      // old one around until the GPU is done with it.
+      glBufferData(GL_ARRAY_BUFFER, BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+    }
+  }
+
+  if (mMode == Mode::PersistentMapping)
+  {
+    const auto segment = offset / SEGMENT_SIZE;
+    while (mCurrentSegment != segment)
+    {
+      enterNextSegment();
+    }
+
+    std::memcpy(mpMappedData + offset, pData, size);
+  }
+  else
+  {
+    auto pTarget = glMapBufferRange(
+      GL_ARRAY_BUFFER,
+      GLintptr(offset),
+      GLsizeiptr(size),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+        GL_MAP_UNSYNCHRONIZED_BIT);
+    std::memcpy(pTarget, pData, size);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+  }
+
+  mWritePosition = offset + size;
+  return offset;
+#endif
+}
+
+
+StreamBufferStats StreamBuffer::finishFrame()
+{
+  return std::exchange(mStats, StreamBufferStats{});
+}
+
+
+void StreamBuffer::enterNextSegment()
+{
+#ifndef RIGEL_USE_GL_ES
+  // All draw calls reading from the current segment have been issued by now,
+  // so the fence tells us when the GPU is done with it
+  mSegmentFences[mCurrentSegment] = gFenceSync(SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  mCurrentSegment = (mCurrentSegment + 1) % NUM_SEGMENTS;
+
+  if (const auto fence = std::exchange(mSegmentFences[mCurrentSegment], {}))
+  {
+    auto result = gClientWaitSync(fence, 0, 0);
+    if (result == TIMEOUT_EXPIRED)
+    {
+      ++mStats.mNumStalls;
+
+      while (result == TIMEOUT_EXPIRED)
+      {
+        result =
+          gClientWaitSync(fence, SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS);
+      }
+    }
+
+    gDeleteSync(fence);
+  }
+#endif
+}
+
+} // namespace rigel::renderer
@@ -0,0 +1,110 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "renderer/opengl.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rigel::renderer
+{
+
+struct StreamBufferStats
+{
+  std::size_t mBytesUploaded = 0;
+
+  /** Number of times we had to wait for the GPU before reusing a part of the
+   * buffer. Only measured when using persistent mapping.
+   */
+  int mNumStalls = 0;
+
+  /** Number of times writing wrapped around to the start of the buffer */
+  int mNumWraps = 0;
+};
+
+
+/** Ring buffer for streaming vertex data to the GPU
+ *
+ * Instead of re-specifying the buffer for each draw call, data is appended
+ * to a large preallocated buffer. upload() returns the byte offset where the
+ * data was placed, which must be used when setting up vertex attributes.
+ *
+ * Depending on what's available, one of three strategies is used:
+ *
+ * With OpenGL 4.4 or ARB_buffer_storage, the buffer is persistently mapped.
+ * It's divided into segments, and a fence is inserted each time writing
+ * moves on to the next segment. Uploads never straddle two segments, so
+ * all draw calls reading from a segment have been issued by then. Before a
+ * segment is written to again, we wait for its fence, so that data still in
+ * use by the GPU is never overwritten.
+ *
+ * Otherwise, each upload maps just the range it needs, with
+ * GL_MAP_UNSYNCHRONIZED_BIT. A range is never written twice until the buffer
+ * wraps around, at which point the buffer is orphaned, so no synchronization
+ * is required.
+ *
+ * OpenGL ES 2.0 can't map buffers, so each upload re-specifies the buffer
+ * via glBufferData, like a plain streaming VBO. The offset is always 0 then.
+ *
+ * The buffer must be bound to GL_ARRAY_BUFFER when calling upload().
+ */
+class StreamBuffer
+{
+public:
+  static constexpr auto MAX_UPLOAD_SIZE = std::size_t{1024 * 1024};
+  static constexpr auto NUM_SEGMENTS = std::size_t{4};
+
+  StreamBuffer();
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  GLuint handle() const { return mBuffer; }
+
+  /** Copy data into the buffer, returns offset of the data in bytes
+   *
+   * Size must not exceed MAX_UPLOAD_SIZE.
+   */
+  std::uintptr_t upload(const void* pData, std::size_t size);
+
+  /** Returns stats collected since the last call, and resets them */
+  StreamBufferStats finishFrame();
+
+private:
+  enum class Mode : std::uint8_t
+  {
+    PersistentMapping,
+    UnsynchronizedMapping,
+    Respecify
+  };
+
+  void enterNextSegment();
+
+  std::array<GLsync, NUM_SEGMENTS> mSegmentFences{};
+  StreamBufferStats mStats;
+  std::size_t mWritePosition = 0;
+  std::size_t mCurrentSegment = 0;
+  std::uint8_t* mpMappedData = nullptr;
+  GLuint mBuffer = 0;
+  Mode mMode = Mode::Respecify;
+};
+
+} // namespace rigel::renderer
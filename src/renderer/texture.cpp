@@ -160,4 +160,26 @@ MonoTexture::MonoTexture(
 {
 }
 
+
+DataTexture::DataTexture(
+  Renderer* pRenderer,
+  base::ArrayView<std::uint8_t> rgbaData,
+  const int width,
+  const int height)
+  : Texture(
+      pRenderer,
+      pRenderer->createDataTexture(width, height, rgbaData),
+      width,
+      height)
+{
+}
+
+
+void DataTexture::update(
+  const base::Rect<int>& area,
+  base::ArrayView<std::uint8_t> rgbaData)
+{
+  mpRenderer->updateDataTexture(mId, area, rgbaData);
+}
+
 } // namespace rigel::renderer
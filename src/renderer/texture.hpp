@@ -205,4 +205,24 @@ public:
     int height);
 };
 
+
+/** Texture holding arbitrary RGBA data for use by custom shaders
+ *
+ * See Renderer::createDataTexture().
+ */
+class DataTexture : public Texture
+{
+public:
+  DataTexture() = default;
+  DataTexture(
+    Renderer* renderer,
+    base::ArrayView<std::uint8_t> rgbaData,
+    int width,
+    int height);
+
+  /** Replace the given area with new data (4 bytes per texel) */
+  void
+    update(const base::Rect<int>& area, base::ArrayView<std::uint8_t> rgbaData);
+};
+
 } // namespace rigel::renderer
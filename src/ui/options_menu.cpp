@@ -383,6 +383,14 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt)
       ImGui::Checkbox("Show FPS", &mpOptions->mShowFpsCounter);
       ImGui::Checkbox(
         "Enable screen flashing", &mpOptions->mEnableScreenFlashes);
+      ImGui::Checkbox(
+        "Reorder draw calls (experimental)", &mpOptions->mDeferredDrawBatching);
+      ImGui::Checkbox(
+        "Multi-texture batching (experimental)",
+        &mpOptions->mMultiTextureBatching);
+      ImGui::Checkbox(
+        "Single-pass map rendering (experimental)",
+        &mpOptions->mSinglePassMapRendering);
 
       if (mpOptions->mUpscalingFilter == data::UpscalingFilter::PixelPerfect)
       {
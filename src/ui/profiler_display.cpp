@@ -0,0 +1,357 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler_display.hpp"
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <imgui.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+
+namespace rigel::ui
+{
+
+namespace
+{
+
+constexpr auto FRAME_TIME_CHART_HEIGHT = 80.0f;
+constexpr auto FLAME_CHART_ROW_HEIGHT = 18.0f;
+constexpr auto FLAME_CHART_LANE_SPACING = 6.0f;
+constexpr auto TEXT_PADDING = 2.0f;
+
+const ImU32 SCOPE_COLORS[] = {
+  IM_COL32(70, 130, 180, 255),
+  IM_COL32(60, 160, 110, 255),
+  IM_COL32(190, 120, 50, 255),
+  IM_COL32(150, 90, 170, 255),
+  IM_COL32(170, 70, 80, 255),
+  IM_COL32(100, 140, 60, 255),
+  IM_COL32(60, 140, 160, 255),
+  IM_COL32(160, 140, 50, 255),
+};
+
+
+struct ScopeStats
+{
+  std::string_view mName;
+  double mTotalMsInFrame = 0.0;
+  int mCountInFrame = 0;
+  double mTotalMsAllFrames = 0.0;
+};
+
+
+double toMs(const std::int64_t nanoseconds)
+{
+  return static_cast<double>(nanoseconds) / 1'000'000.0;
+}
+
+
+ImU32 colorForScope(const std::string_view name)
+{
+  // Color is derived from the name, so that a scope keeps its color across
+  // frames
+  const auto hash = std::hash<std::string_view>{}(name);
+  return SCOPE_COLORS[hash % std::size(SCOPE_COLORS)];
+}
+
+
+void drawFlameChart(const base::profiler::Frame& frame)
+{
+  // Each thread gets its own lane, with one row per nesting level
+  auto maxDepthPerThread = std::vector<int>{};
+  for (const auto& sample : frame.mSamples)
+  {
+    if (sample.mThreadIndex >= int(maxDepthPerThread.size()))
+    {
+      maxDepthPerThread.resize(sample.mThreadIndex + 1, -1);
+    }
+
+    maxDepthPerThread[sample.mThreadIndex] =
+      std::max(maxDepthPerThread[sample.mThreadIndex], sample.mDepth);
+  }
+
+  auto laneOffsets = std::vector<float>{};
+  auto totalHeight = 0.0f;
+  for (const auto maxDepth : maxDepthPerThread)
+  {
+    laneOffsets.push_back(totalHeight);
+    if (maxDepth >= 0)
+    {
+      totalHeight +=
+        (maxDepth + 1) * FLAME_CHART_ROW_HEIGHT + FLAME_CHART_LANE_SPACING;
+    }
+  }
+
+  const auto origin = ImGui::GetCursorScreenPos();
+  const auto width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+
+  // Reserves the space for the chart, and allows hover detection
+  ImGui::InvisibleButton(
+    "##flame_chart", ImVec2{width, std::max(totalHeight, 1.0f)});
+  const auto isHovered = ImGui::IsItemHovered();
+  const auto mousePos = ImGui::GetIO().MousePos;
+
+  auto pDrawList = ImGui::GetWindowDrawList();
+  const auto frameDuration =
+    static_cast<double>(std::max(frame.mDurationNs, std::int64_t{1}));
+
+  auto relativeX = [&](const std::int64_t timeNs) {
+    const auto relative = (timeNs - frame.mStartNs) / frameDuration;
+    return origin.x + float(std::clamp(relative, 0.0, 1.0)) * width;
+  };
+
+  for (const auto& sample : frame.mSamples)
+  {
+    const auto left = relativeX(sample.mStartNs);
+    const auto right = std::max(
+      relativeX(sample.mStartNs + sample.mDurationNs), left + 1.0f);
+    const auto top = origin.y + laneOffsets[sample.mThreadIndex] +
+      sample.mDepth * FLAME_CHART_ROW_HEIGHT;
+    const auto bottom = top + FLAME_CHART_ROW_HEIGHT - 1.0f;
+
+    pDrawList->AddRectFilled(
+      ImVec2{left, top}, ImVec2{right, bottom}, colorForScope(sample.mpName));
+
+    const auto textSize = ImGui::CalcTextSize(sample.mpName);
+    if (right - left > textSize.x + TEXT_PADDING * 2.0f)
+    {
+      pDrawList->AddText(
+        ImVec2{left + TEXT_PADDING, top + TEXT_PADDING},
+        IM_COL32_WHITE,
+        sample.mpName);
+    }
+
+    if (
+      isHovered && mousePos.x >= left && mousePos.x < right &&
+      mousePos.y >= top && mousePos.y < bottom)
+    {
+      ImGui::SetTooltip(
+        "%s\n%.3f ms\n%s",
+        sample.mpName,
+        toMs(sample.mDurationNs),
+        sample.mThreadIndex == 0 ? "Main thread" : "Other thread");
+    }
+  }
+}
+
+
+std::vector<ScopeStats> collectScopeStats(
+  const std::vector<base::profiler::Frame>& frames,
+  const base::profiler::Frame& selectedFrame)
+{
+  auto statsByName = std::unordered_map<std::string_view, ScopeStats>{};
+
+  for (const auto& frame : frames)
+  {
+    for (const auto& sample : frame.mSamples)
+    {
+      auto& stats = statsByName[sample.mpName];
+      stats.mName = sample.mpName;
+      stats.mTotalMsAllFrames += toMs(sample.mDurationNs);
+    }
+  }
+
+  for (const auto& sample : selectedFrame.mSamples)
+  {
+    auto& stats = statsByName[sample.mpName];
+    stats.mTotalMsInFrame += toMs(sample.mDurationNs);
+    ++stats.mCountInFrame;
+  }
+
+  auto result = std::vector<ScopeStats>{};
+  result.reserve(statsByName.size());
+  for (auto& [name, stats] : statsByName)
+  {
+    result.push_back(std::move(stats));
+  }
+
+  std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.mTotalMsAllFrames > rhs.mTotalMsAllFrames;
+  });
+
+  return result;
+}
+
+} // namespace
+
+
+ProfilerDisplay::ProfilerDisplay(std::filesystem::path traceExportPath)
+  : mTraceExportPath(std::move(traceExportPath))
+{
+}
+
+
+void ProfilerDisplay::toggleVisibility()
+{
+  mIsVisible = !mIsVisible;
+  base::profiler::setEnabled(mIsVisible && !mIsPaused);
+}
+
+
+void ProfilerDisplay::updateAndRender()
+{
+  if (!mIsVisible)
+  {
+    return;
+  }
+
+  if (!mIsPaused)
+  {
+    mFrames = base::profiler::recordedFrames();
+    mSelectedFrame = int(mFrames.size()) - 1;
+  }
+
+  ImGui::SetMouseCursor(ImGuiMouseCursor_Arrow);
+  ImGui::SetNextWindowSize(ImVec2{700, 500}, ImGuiCond_FirstUseEver);
+
+  const auto isExpanded = ImGui::Begin("Profiler", &mIsVisible);
+  if (!mIsVisible)
+  {
+    base::profiler::setEnabled(false);
+  }
+
+  if (!isExpanded)
+  {
+    ImGui::End();
+    return;
+  }
+
+  if (auto paused = mIsPaused; ImGui::Checkbox("Pause", &paused))
+  {
+    setPaused(paused);
+  }
+
+  ImGui::SameLine();
+  if (ImGui::Button("Export Chrome trace"))
+  {
+    exportTrace();
+  }
+
+  if (!mStatusMessage.empty())
+  {
+    ImGui::SameLine();
+    ImGui::TextUnformatted(mStatusMessage.c_str());
+  }
+
+  if (mFrames.empty())
+  {
+    ImGui::TextUnformatted("No frames recorded yet");
+    ImGui::End();
+    return;
+  }
+
+  auto frameTimes = std::vector<float>{};
+  frameTimes.reserve(mFrames.size());
+  for (const auto& frame : mFrames)
+  {
+    frameTimes.push_back(float(toMs(frame.mDurationNs)));
+  }
+
+  const auto maxFrameTime =
+    *std::max_element(frameTimes.begin(), frameTimes.end());
+  ImGui::PlotHistogram(
+    "##frame_times",
+    frameTimes.data(),
+    int(frameTimes.size()),
+    0,
+    "Frame times (click to select)",
+    0.0f,
+    std::max(maxFrameTime, 1.0f),
+    ImVec2{ImGui::GetContentRegionAvail().x, FRAME_TIME_CHART_HEIGHT});
+
+  if (ImGui::IsItemClicked())
+  {
+    const auto chartLeft = ImGui::GetItemRectMin().x;
+    const auto chartWidth = std::max(ImGui::GetItemRectSize().x, 1.0f);
+    const auto relativeX = (ImGui::GetIO().MousePos.x - chartLeft) / chartWidth;
+
+    setPaused(true);
+    mSelectedFrame = int(relativeX * frameTimes.size());
+  }
+
+  if (mIsPaused)
+  {
+    ImGui::SliderInt("Frame", &mSelectedFrame, 0, int(mFrames.size()) - 1);
+  }
+
+  mSelectedFrame = std::clamp(mSelectedFrame, 0, int(mFrames.size()) - 1);
+  const auto& selectedFrame = mFrames[mSelectedFrame];
+
+  ImGui::Text(
+    "Frame %d: %.3f ms, %d samples",
+    mSelectedFrame,
+    toMs(selectedFrame.mDurationNs),
+    int(selectedFrame.mSamples.size()));
+  drawFlameChart(selectedFrame);
+
+  for (const auto& counter : selectedFrame.mCounters)
+  {
+    ImGui::Text(
+      "%s: %lld", counter.mpName, static_cast<long long>(counter.mValue));
+  }
+
+  ImGui::Separator();
+  ImGui::TextUnformatted("Scope                               Frame (ms)  "
+                         "Calls  Average (ms)");
+
+  const auto numFrames = double(mFrames.size());
+  for (const auto& stats : collectScopeStats(mFrames, selectedFrame))
+  {
+    ImGui::Text(
+      "%-35.*s %10.3f %6d %13.3f",
+      int(stats.mName.size()),
+      stats.mName.data(),
+      stats.mTotalMsInFrame,
+      stats.mCountInFrame,
+      stats.mTotalMsAllFrames / numFrames);
+  }
+
+  ImGui::End();
+}
+
+
+void ProfilerDisplay::setPaused(const bool paused)
+{
+  mIsPaused = paused;
+  base::profiler::setEnabled(mIsVisible && !mIsPaused);
+}
+
+
+void ProfilerDisplay::exportTrace()
+{
+  try
+  {
+    base::profiler::writeChromeTrace(mTraceExportPath);
+    mStatusMessage = "Saved to " + mTraceExportPath.u8string();
+  }
+  catch (const std::exception& ex)
+  {
+    mStatusMessage = std::string{"Export failed: "} + ex.what();
+  }
+}
+
+} // namespace rigel::ui
@@ -0,0 +1,56 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/profiler.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace rigel::ui
+{
+
+/** Debug window showing the data recorded by base::profiler
+ *
+ * Shows a bar chart of the frame times of all recorded frames, and a flame
+ * chart plus a per-scope summary of the selected frame. Profiling is enabled
+ * while the window is visible. Pausing stops recording, so that the recorded
+ * frames can be inspected and exported as a Chrome trace.
+ */
+class ProfilerDisplay
+{
+public:
+  explicit ProfilerDisplay(std::filesystem::path traceExportPath);
+
+  void toggleVisibility();
+  void updateAndRender();
+
+private:
+  void setPaused(bool paused);
+  void exportTrace();
+
+  std::filesystem::path mTraceExportPath;
+  std::vector<base::profiler::Frame> mFrames;
+  std::string mStatusMessage;
+  int mSelectedFrame = 0;
+  bool mIsVisible = false;
+  bool mIsPaused = false;
+};
+
+} // namespace rigel::ui
@@ -0,0 +1,82 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/bit_scan.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+bool anyBitSetReference(
+  const std::vector<std::uint64_t>& words,
+  const std::size_t first,
+  const std::size_t last)
+{
+  for (auto bit = first; bit <= last; ++bit)
+  {
+    if ((words[bit / 64] >> (bit % 64)) & 1)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace
+
+
+TEST_CASE("Bit scanning gives the same results as testing each bit")
+{
+  constexpr auto NUM_WORDS = std::size_t{80};
+  constexpr auto NUM_BITS = NUM_WORDS * 64;
+
+  // Test with a single bit set at various positions, including ones in the
+  // middle of long ranges, which are tested a whole word at a time.
+  const auto bitsToTest = std::vector<std::size_t>{
+    0, 63, 64, 100, 1100, 2047, 4000, NUM_BITS - 1};
+
+  for (const auto setBit : bitsToTest)
+  {
+    auto words = std::vector<std::uint64_t>(NUM_WORDS);
+    words[setBit / 64] = std::uint64_t{1} << (setBit % 64);
+
+    auto allMatch = true;
+    for (auto first = std::size_t{0}; first < NUM_BITS; first += 37)
+    {
+      for (auto last = first; last < NUM_BITS; last += 61)
+      {
+        allMatch = allMatch &&
+          base::anyBitSet(words.data(), first, last) ==
+            anyBitSetReference(words, first, last);
+      }
+    }
+
+    INFO("bit " << setBit);
+    CHECK(allMatch);
+  }
+}
@@ -0,0 +1,147 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+TEST_CASE("Collision checker finds solid bodies")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  data::map::Map map{100, 100, data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+
+  auto solidBody = entities.create();
+  solidBody.assign<BoundingBox>(BoundingBox{{0, 0}, {4, 2}});
+  solidBody.assign<WorldPosition>(40, 40);
+  solidBody.assign<SolidBody>();
+
+  auto& position = *solidBody.component<WorldPosition>();
+
+  // A 2x2 object standing on top of the given position
+  const auto isObjectOnGroundAt = [&](const base::Vec2& groundPosition) {
+    return collisionChecker.isOnSolidGround(
+      BoundingBox{{groundPosition.x, groundPosition.y - 2}, {2, 2}});
+  };
+
+
+  SECTION("Solid body is found")
+  {
+    CHECK(isObjectOnGroundAt({40, 39}));
+    CHECK(isObjectOnGroundAt({42, 39}));
+    CHECK(!isObjectOnGroundAt({45, 39}));
+    CHECK(!isObjectOnGroundAt({10, 39}));
+  }
+
+  SECTION("Solid body is found after updating it")
+  {
+    position = {80, 80};
+    collisionChecker.updateSolidBody(solidBody);
+
+    CHECK(!isObjectOnGroundAt({40, 39}));
+    CHECK(isObjectOnGroundAt({80, 79}));
+  }
+
+  SECTION("Solid body is found after synchronizing")
+  {
+    position = {8, 90};
+    collisionChecker.synchronizeSolidBodies();
+
+    CHECK(!isObjectOnGroundAt({40, 39}));
+    CHECK(isObjectOnGroundAt({8, 89}));
+  }
+
+  SECTION("Changed bounding box is taken into account")
+  {
+    solidBody.component<BoundingBox>()->size.width = 40;
+    collisionChecker.updateSolidBody(solidBody);
+
+    CHECK(isObjectOnGroundAt({75, 39}));
+  }
+
+  SECTION("Solid body is not found anymore when removed")
+  {
+    SECTION("By removing the component")
+    {
+      solidBody.remove<SolidBody>();
+      CHECK(!isObjectOnGroundAt({40, 39}));
+    }
+
+    SECTION("By destroying the entity")
+    {
+      solidBody.destroy();
+      CHECK(!isObjectOnGroundAt({40, 39}));
+    }
+  }
+
+  SECTION("Moving solid bodies are always found at their current position")
+  {
+    solidBody.assign<MovingBody>(base::Vec2f{}, false);
+
+    position = {20, 60};
+    CHECK(!isObjectOnGroundAt({40, 39}));
+    CHECK(isObjectOnGroundAt({20, 59}));
+
+    SECTION("Body becomes static again when MovingBody is removed")
+    {
+      solidBody.remove<MovingBody>();
+      CHECK(isObjectOnGroundAt({20, 59}));
+    }
+  }
+
+  SECTION("Solid body outside of the map is found")
+  {
+    position = {40, 130};
+    collisionChecker.updateSolidBody(solidBody);
+
+    CHECK(isObjectOnGroundAt({40, 129}));
+    CHECK(!isObjectOnGroundAt({40, 39}));
+  }
+
+  SECTION("Solid body is found when position is assigned after SolidBody")
+  {
+    auto secondBody = entities.create();
+    secondBody.assign<SolidBody>();
+    secondBody.assign<BoundingBox>(BoundingBox{{0, 0}, {4, 2}});
+    secondBody.assign<WorldPosition>(60, 20);
+
+    CHECK(isObjectOnGroundAt({60, 19}));
+  }
+
+  SECTION("Solid bodies existing before creation are found")
+  {
+    CollisionChecker secondChecker{&map, entityx.entities, entityx.events};
+
+    CHECK(secondChecker.isOnSolidGround(BoundingBox{{40, 37}, {2, 2}}));
+  }
+}
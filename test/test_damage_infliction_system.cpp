@@ -0,0 +1,103 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils.hpp"
+
+#include <data/player_model.hpp>
+#include <engine/base_components.hpp>
+#include <engine/physical_components.hpp>
+#include <game_logic/damage_infliction_system.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine::components;
+using namespace game_logic::components;
+
+namespace ex = entityx;
+
+
+namespace
+{
+
+/** Spawns a new damage inflictor whenever a shootable is killed */
+struct InflictorSpawner : public ex::Receiver<InflictorSpawner>
+{
+  explicit InflictorSpawner(ex::EntityManager* pEntities)
+    : mpEntities(pEntities)
+  {
+  }
+
+  void receive(const game_logic::events::ShootableKilled&)
+  {
+    auto inflictor = mpEntities->create();
+    inflictor.assign<DamageInflicting>(1);
+    inflictor.assign<WorldPosition>(mSpawnPosition);
+    inflictor.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+  }
+
+  ex::EntityManager* mpEntities;
+  WorldPosition mSpawnPosition;
+};
+
+
+ex::Entity createShootable(
+  ex::EntityManager& entities,
+  const WorldPosition& position)
+{
+  auto entity = entities.create();
+  entity.assign<Shootable>(1);
+  entity.assign<WorldPosition>(position);
+  entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+  entity.assign<Active>();
+  return entity;
+}
+
+} // namespace
+
+
+TEST_CASE("Damage inflictors spawned during an update are taken into account")
+{
+  ex::EntityX entityx;
+  data::PersistentPlayerState playerState;
+  MockServiceProvider serviceProvider;
+
+  game_logic::DamageInflictionSystem damageInflictionSystem{
+    &playerState, &serviceProvider, &entityx.events};
+
+  InflictorSpawner spawner{&entityx.entities};
+  spawner.mSpawnPosition = WorldPosition{50, 10};
+  entityx.events.subscribe<game_logic::events::ShootableKilled>(spawner);
+
+  auto first = createShootable(entityx.entities, {10, 10});
+  auto second = createShootable(entityx.entities, {50, 10});
+
+  auto inflictor = entityx.entities.create();
+  inflictor.assign<DamageInflicting>(1);
+  inflictor.assign<WorldPosition>(10, 10);
+  inflictor.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+
+  damageInflictionSystem.update(entityx.entities);
+
+  // The first shootable's death spawns an inflictor at the second one's
+  // position, which must damage it within the same update.
+  CHECK(!first.valid());
+  CHECK(!second.valid());
+}
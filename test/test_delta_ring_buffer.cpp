@@ -0,0 +1,134 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/delta_ring_buffer.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using base::DeltaRingBuffer;
+
+using Bytes = std::vector<std::uint8_t>;
+
+
+TEST_CASE("Delta ring buffer restores states in reverse order")
+{
+  DeltaRingBuffer buffer{10};
+
+  const auto first = Bytes{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  auto second = first;
+  second[2] = 42;
+  auto third = second;
+  third[9] = 0;
+  third[0] = 0xFF;
+
+  buffer.push(first);
+  buffer.push(second);
+  buffer.push(third);
+
+  REQUIRE(buffer.size() == 3);
+  CHECK(buffer.newest() == third);
+
+  buffer.dropNewest();
+  CHECK(buffer.newest() == second);
+
+  buffer.dropNewest();
+  CHECK(buffer.newest() == first);
+
+  buffer.dropNewest();
+  CHECK(buffer.empty());
+}
+
+
+TEST_CASE("Delta ring buffer handles states of different size")
+{
+  DeltaRingBuffer buffer{10};
+
+  const auto small = Bytes{1, 2, 3};
+  const auto large = Bytes{1, 2, 3, 0, 0, 0, 0, 0, 0, 7, 8};
+  const auto empty = Bytes{};
+
+  buffer.push(small);
+  buffer.push(large);
+  buffer.push(empty);
+  buffer.push(small);
+
+  CHECK(buffer.newest() == small);
+  buffer.dropNewest();
+  CHECK(buffer.newest() == empty);
+  buffer.dropNewest();
+  CHECK(buffer.newest() == large);
+  buffer.dropNewest();
+  CHECK(buffer.newest() == small);
+}
+
+
+TEST_CASE("Delta ring buffer discards oldest states beyond capacity")
+{
+  DeltaRingBuffer buffer{3};
+
+  for (std::uint8_t i = 0; i < 5; ++i)
+  {
+    buffer.push(Bytes{i, i, i, i});
+  }
+
+  REQUIRE(buffer.size() == 3);
+  CHECK(buffer.newest() == Bytes{4, 4, 4, 4});
+
+  buffer.dropNewest();
+  buffer.dropNewest();
+  CHECK(buffer.newest() == Bytes{2, 2, 2, 2});
+
+  buffer.dropNewest();
+  CHECK(buffer.empty());
+}
+
+
+TEST_CASE("Delta ring buffer stores mostly unchanged states compactly")
+{
+  DeltaRingBuffer buffer{100};
+
+  auto state = Bytes(64 * 1024, 0xAB);
+  std::vector<Bytes> history;
+
+  for (auto i = 0; i < 100; ++i)
+  {
+    // A few scattered changes per step
+    state[static_cast<std::size_t>(i * 7)] = static_cast<std::uint8_t>(i);
+    state[state.size() - 1 - static_cast<std::size_t>(i)] ^= 0x0F;
+    state[32 * 1024 + static_cast<std::size_t>(i % 3)] += 1;
+
+    history.push_back(state);
+    buffer.push(state);
+  }
+
+  CHECK(buffer.storageSize() < state.size() + 100 * 32);
+
+  for (auto i = history.size(); i > 0; --i)
+  {
+    REQUIRE(buffer.newest() == history[i - 1]);
+    buffer.dropNewest();
+  }
+
+  CHECK(buffer.empty());
+}
@@ -0,0 +1,231 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <assets/bitwise_iter.hpp>
+#include <assets/ega_image_decoder.hpp>
+#include <data/unit_conversions.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <random>
+
+
+using namespace rigel;
+using namespace rigel::assets;
+using data::GameTraits;
+using data::Pixel;
+
+
+namespace
+{
+
+// Straightforward bit-by-bit decoders, used as reference for the
+// table-driven implementation.
+
+data::PixelBuffer referenceDecodeSimplePlanar(
+  const ByteBuffer& data,
+  const data::Palette16& palette)
+{
+  const auto numPixels =
+    data.size() / GameTraits::egaPlanes * GameTraits::pixelsPerEgaByte;
+
+  std::vector<std::uint8_t> indices(numPixels, 0);
+  BitWiseIterator<ByteBufferCIter> bitsIter(data.data());
+  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+  {
+    for (auto& index : indices)
+    {
+      index |= *bitsIter++ << plane;
+    }
+  }
+
+  data::PixelBuffer pixels;
+  for (const auto index : indices)
+  {
+    pixels.push_back(palette[index]);
+  }
+
+  return pixels;
+}
+
+
+data::PixelBuffer referenceDecodeTiled(
+  const ByteBuffer& data,
+  const std::size_t widthInTiles,
+  const std::size_t heightInTiles,
+  const data::Palette16* pPalette,
+  const bool isMasked)
+{
+  const auto width = data::tilesToPixels(widthInTiles);
+  data::PixelBuffer pixels(width * data::tilesToPixels(heightInTiles));
+
+  BitWiseIterator<ByteBufferCIter> bitsIter(data.data());
+  for (auto row = 0u; row < heightInTiles; ++row)
+  {
+    for (auto col = 0u; col < widthInTiles; ++col)
+    {
+      for (auto y = 0u; y < GameTraits::tileSize; ++y)
+      {
+        auto pTarget = pixels.data() + data::tilesToPixels(col) +
+          (data::tilesToPixels(row) + y) * width;
+
+        std::array<bool, GameTraits::tileSize> mask{};
+        if (isMasked)
+        {
+          for (auto& bit : mask)
+          {
+            bit = *bitsIter++;
+          }
+        }
+
+        if (pPalette)
+        {
+          std::array<std::uint8_t, GameTraits::tileSize> indices{};
+          for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+          {
+            for (auto& index : indices)
+            {
+              index |= *bitsIter++ << plane;
+            }
+          }
+
+          for (auto x = 0u; x < GameTraits::tileSize; ++x)
+          {
+            pTarget[x] = (*pPalette)[indices[x]];
+          }
+        }
+        else
+        {
+          for (auto x = 0u; x < GameTraits::tileSize; ++x)
+          {
+            pTarget[x] =
+              *bitsIter++ ? Pixel{255, 255, 255, 255} : Pixel{0, 0, 0, 255};
+          }
+        }
+
+        for (auto x = 0u; x < GameTraits::tileSize; ++x)
+        {
+          if (mask[x])
+          {
+            pTarget[x].a = 0;
+          }
+        }
+      }
+    }
+  }
+
+  return pixels;
+}
+
+
+ByteBuffer randomBytes(const std::size_t count)
+{
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<int> distribution{0, 255};
+
+  ByteBuffer result(count);
+  for (auto& byte : result)
+  {
+    byte = static_cast<std::uint8_t>(distribution(generator));
+  }
+
+  return result;
+}
+
+
+data::Palette16 testPalette()
+{
+  data::Palette16 palette;
+  for (auto i = 0u; i < palette.size(); ++i)
+  {
+    const auto value = static_cast<std::uint8_t>(i * 16);
+    palette[i] = Pixel{value, std::uint8_t(255 - value), std::uint8_t(i), 255};
+  }
+
+  return palette;
+}
+
+} // namespace
+
+
+TEST_CASE("Simple planar EGA data is decoded correctly")
+{
+  const auto palette = testPalette();
+  const auto data = randomBytes(320 * 200 / 2);
+
+  const auto pixels = decodeSimplePlanarEgaBuffer(
+    data.data(), data.data() + data.size(), palette);
+
+  CHECK(pixels == referenceDecodeSimplePlanar(data, palette));
+}
+
+
+TEST_CASE("Tiled EGA data is decoded correctly")
+{
+  const auto palette = testPalette();
+  const auto widthInTiles = std::size_t{5};
+  const auto heightInTiles = std::size_t{3};
+
+  SECTION("Unmasked")
+  {
+    const auto data = randomBytes(
+      widthInTiles * heightInTiles *
+      GameTraits::bytesPerTile(data::TileImageType::Unmasked));
+
+    const auto image = loadTiledImage(
+      data, widthInTiles, palette, data::TileImageType::Unmasked);
+
+    CHECK(image.width() == data::tilesToPixels(widthInTiles));
+    CHECK(image.height() == data::tilesToPixels(heightInTiles));
+    CHECK(
+      image.pixelData() ==
+      referenceDecodeTiled(data, widthInTiles, heightInTiles, &palette, false));
+  }
+
+  SECTION("Masked")
+  {
+    const auto data = randomBytes(
+      widthInTiles * heightInTiles *
+      GameTraits::bytesPerTile(data::TileImageType::Masked));
+
+    const auto image =
+      loadTiledImage(data, widthInTiles, palette, data::TileImageType::Masked);
+
+    CHECK(image.height() == data::tilesToPixels(heightInTiles));
+    CHECK(
+      image.pixelData() ==
+      referenceDecodeTiled(data, widthInTiles, heightInTiles, &palette, true));
+  }
+
+  SECTION("Font bitmap")
+  {
+    const auto data = randomBytes(
+      widthInTiles * heightInTiles * GameTraits::bytesPerFontTile());
+
+    const auto image = loadTiledFontBitmap(
+      data.data(), data.data() + data.size(), widthInTiles);
+
+    CHECK(image.height() == data::tilesToPixels(heightInTiles));
+    CHECK(
+      image.pixelData() ==
+      referenceDecodeTiled(data, widthInTiles, heightInTiles, nullptr, true));
+  }
+}
@@ -0,0 +1,181 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <engine/base_components.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/visual_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+TEST_CASE("Entity activation system")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  data::map::Map map{200, 100, data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  const auto viewportSize = base::Size{32, 20};
+
+  auto createEntity = [&](const base::Vec2& position) {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(position);
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+    return entity;
+  };
+
+  auto isActive = [](ex::Entity entity) {
+    return entity.has_component<Active>();
+  };
+
+  auto entityOnScreen = createEntity({10, 10});
+  auto entityOffScreen = createEntity({150, 60});
+
+  EntityActivationSystem activationSystem{
+    &map, entityx.entities, entityx.events};
+
+  activationSystem.markActiveEntities({0, 0}, viewportSize);
+
+  SECTION("Only on-screen entities are active")
+  {
+    CHECK(isActive(entityOnScreen));
+    CHECK(entityOnScreen.component<Active>()->mIsOnScreen);
+    CHECK(!isActive(entityOffScreen));
+  }
+
+  SECTION("Entities are (de-)activated when camera moves")
+  {
+    activationSystem.markActiveEntities({140, 50}, viewportSize);
+
+    CHECK(!isActive(entityOnScreen));
+    CHECK(isActive(entityOffScreen));
+
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+
+    CHECK(isActive(entityOnScreen));
+    CHECK(!isActive(entityOffScreen));
+  }
+
+  SECTION("Entities created later are handled")
+  {
+    auto newEntity = createEntity({20, 5});
+    auto newEntityOffScreen = createEntity({100, 5});
+
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+
+    CHECK(isActive(newEntity));
+    CHECK(!isActive(newEntityOffScreen));
+
+    activationSystem.markActiveEntities({90, 0}, viewportSize);
+
+    CHECK(!isActive(newEntity));
+    CHECK(isActive(newEntityOffScreen));
+  }
+
+  SECTION("Destroyed entities are handled")
+  {
+    entityOffScreen.destroy();
+    entityOnScreen.destroy();
+    auto newEntity = createEntity({150, 60});
+
+    activationSystem.markActiveEntities({140, 50}, viewportSize);
+
+    CHECK(isActive(newEntity));
+  }
+
+  SECTION("Moving entities stay tracked while inactive")
+  {
+    entityOnScreen.assign<MovingBody>(base::Vec2f{}, false);
+    activationSystem.markActiveEntities({100, 0}, viewportSize);
+    CHECK(!isActive(entityOnScreen));
+
+    *entityOnScreen.component<WorldPosition>() = {110, 10};
+    activationSystem.markActiveEntities({100, 0}, viewportSize);
+    CHECK(isActive(entityOnScreen));
+  }
+
+  SECTION("Animated entities stay tracked while inactive")
+  {
+    // Sprite animations run for inactive entities as well, and update the
+    // bounding box to match the current animation frame. Here, the bounding
+    // box grows from a grid block outside of the active region into it.
+    auto entity = createEntity({40, 10});
+    entity.assign<AnimationLoop>(1);
+
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+    REQUIRE(!isActive(entity));
+
+    *entity.component<BoundingBox>() = BoundingBox{{-20, 0}, {22, 2}};
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+    const auto activeAfterIncrementalUpdate = isActive(entity);
+
+    engine::markActiveEntities(entities, {0, 0}, viewportSize);
+    CHECK(isActive(entity));
+    CHECK(activeAfterIncrementalUpdate == isActive(entity));
+  }
+
+  SECTION("Active tag is removed from off-screen entities")
+  {
+    entityOffScreen.assign<Active>();
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+
+    CHECK(!isActive(entityOffScreen));
+  }
+
+  SECTION("Activation policies are respected")
+  {
+    using Policy = ActivationSettings::Policy;
+
+    entityOnScreen.assign<ActivationSettings>(
+      Policy::AlwaysAfterFirstActivation);
+    entityOffScreen.assign<ActivationSettings>(Policy::Always);
+
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+    CHECK(isActive(entityOnScreen));
+    CHECK(isActive(entityOffScreen));
+    CHECK(!entityOffScreen.component<Active>()->mIsOnScreen);
+
+    activationSystem.markActiveEntities({100, 50}, viewportSize);
+    CHECK(isActive(entityOnScreen));
+    CHECK(!entityOnScreen.component<Active>()->mIsOnScreen);
+    CHECK(isActive(entityOffScreen));
+  }
+
+  SECTION("Entities outside of the map are handled")
+  {
+    auto entity = createEntity({-5, 5});
+    entity.component<BoundingBox>()->size.width = 10;
+
+    activationSystem.markActiveEntities({0, 0}, viewportSize);
+    CHECK(isActive(entity));
+
+    activationSystem.markActiveEntities({100, 0}, viewportSize);
+    CHECK(!isActive(entity));
+  }
+}
@@ -0,0 +1,163 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <renderer/frame_capture.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <filesystem>
+#include <sstream>
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+namespace
+{
+
+CaptureEvent makeEvent(
+  const CaptureEventType type,
+  const BatchBreakReason reason = BatchBreakReason::None,
+  const std::uint32_t resourceId = 0,
+  const std::uint32_t pixelsCovered = 0,
+  const char* pCallSite = "")
+{
+  CaptureEvent event;
+  event.mType = type;
+  event.mBreakReason = reason;
+  event.mResourceId = resourceId;
+  event.mVertexCount = 6;
+  event.mPixelsCovered = pixelsCovered;
+  event.mCallSite = pCallSite;
+  return event;
+}
+
+} // namespace
+
+
+TEST_CASE("Frame capture summary")
+{
+  auto renderTargetSwitch = makeEvent(CaptureEventType::SetRenderTarget);
+  renderTargetSwitch.mResourceId = 7;
+  renderTargetSwitch.mSize = {10, 10};
+
+  const auto capture = FrameCapture{
+    {20, 10},
+    {
+      makeEvent(CaptureEventType::PushState),
+      renderTargetSwitch,
+      makeEvent(
+        CaptureEventType::DrawSprites,
+        BatchBreakReason::TextureChange,
+        1,
+        100,
+        "HUD"),
+      makeEvent(
+        CaptureEventType::DrawSprites,
+        BatchBreakReason::StateChange,
+        2,
+        50,
+        "HUD"),
+      makeEvent(CaptureEventType::PopState),
+      makeEvent(CaptureEventType::SelectShader),
+      makeEvent(
+        CaptureEventType::DrawTriangles,
+        BatchBreakReason::EndOfFrame,
+        0,
+        400,
+        "Map"),
+    }};
+
+  const auto summary = summarizeFrameCapture(capture);
+
+  CHECK(summary.mNumDrawCalls == 3);
+  CHECK(summary.mNumVertices == 18);
+  CHECK(summary.mNumRenderTargetSwitches == 1);
+  CHECK(summary.mNumShaderSwitches == 1);
+  CHECK(summary.mMaxStateStackDepth == 1);
+
+  REQUIRE(summary.mCallSites.size() == 2);
+  CHECK(summary.mCallSites[0].mCallSite == "HUD");
+  CHECK(summary.mCallSites[0].mNumDrawCalls == 2);
+  CHECK(
+    summary.mCallSites[0]
+      .mBatchBreaks[std::size_t(BatchBreakReason::TextureChange)] == 1);
+  CHECK(
+    summary.mCallSites[0]
+      .mBatchBreaks[std::size_t(BatchBreakReason::StateChange)] == 1);
+  CHECK(summary.mCallSites[1].mCallSite == "Map");
+
+  SECTION("Overdraw is tracked per render target")
+  {
+    REQUIRE(summary.mRenderTargets.size() == 2);
+
+    // The last draw call happens after the render target switch, so it's
+    // still attributed to render target 7
+    CHECK(summary.mRenderTargets[0].mRenderTarget == 0);
+    CHECK(summary.mRenderTargets[0].mNumDrawCalls == 0);
+    CHECK(summary.mRenderTargets[1].mRenderTarget == 7);
+    CHECK(summary.mRenderTargets[1].mNumDrawCalls == 3);
+    CHECK(summary.mRenderTargets[1].overdraw() == 5.5);
+  }
+
+  SECTION("Report can be printed")
+  {
+    std::stringstream stream;
+    printFrameCaptureSummary(stream, summary);
+    CHECK(stream.str().find("HUD") != std::string::npos);
+  }
+}
+
+
+TEST_CASE("Frame capture can be saved and loaded")
+{
+  auto capture = FrameCapture{{320, 200}, {}};
+  capture.mEvents.push_back(makeEvent(
+    CaptureEventType::DrawMultiTexturedSprites,
+    BatchBreakReason::BatchFull,
+    0,
+    12345,
+    "Renderer::flushDeferredDraws"));
+  capture.mEvents.push_back(makeEvent(CaptureEventType::Clear));
+  capture.mEvents.back().mSize = {320, 200};
+
+  const auto path =
+    std::filesystem::temp_directory_path() / "rigel_test_capture.rfc";
+  writeFrameCapture(path, capture);
+  const auto loaded = loadFrameCapture(path);
+  std::filesystem::remove(path);
+
+  CHECK(loaded.mWindowSize == capture.mWindowSize);
+  REQUIRE(loaded.mEvents.size() == 2);
+
+  for (auto i = 0u; i < loaded.mEvents.size(); ++i)
+  {
+    const auto& expected = capture.mEvents[i];
+    const auto& actual = loaded.mEvents[i];
+
+    CHECK(actual.mType == expected.mType);
+    CHECK(actual.mBreakReason == expected.mBreakReason);
+    CHECK(actual.mResourceId == expected.mResourceId);
+    CHECK(actual.mVertexCount == expected.mVertexCount);
+    CHECK(actual.mPixelsCovered == expected.mPixelsCovered);
+    CHECK(actual.mSize == expected.mSize);
+    CHECK(actual.mCallSite == expected.mCallSite);
+  }
+}
@@ -0,0 +1,68 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/image.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using data::Image;
+using data::Pixel;
+
+
+TEST_CASE("Copies of an image share pixel data until modified")
+{
+  const auto red = Pixel{255, 0, 0, 255};
+  const auto blue = Pixel{0, 0, 255, 255};
+
+  Image original{data::PixelBuffer(4, red), 2, 2};
+  auto copy = original;
+
+  CHECK(&copy.pixelData() == &original.pixelData());
+
+  SECTION("Modifying the copy leaves the original unchanged")
+  {
+    copy.insertImage(1, 1, data::PixelBuffer{blue}, 1);
+
+    CHECK(&copy.pixelData() != &original.pixelData());
+    CHECK(copy.pixelData()[3] == blue);
+    CHECK(original.pixelData()[3] == red);
+  }
+
+  SECTION("Modifying the original leaves the copy unchanged")
+  {
+    original.insertImage(0, 0, data::PixelBuffer{blue}, 1);
+
+    CHECK(original.pixelData()[0] == blue);
+    CHECK(copy.pixelData()[0] == red);
+  }
+}
+
+
+TEST_CASE("Modifying an unshared image doesn't copy its pixel data")
+{
+  Image image{2, 2};
+  const auto pPixelsBefore = &image.pixelData();
+
+  image.insertImage(0, 0, data::PixelBuffer{Pixel{1, 2, 3, 4}}, 1);
+
+  CHECK(&image.pixelData() == pPixelsBefore);
+}
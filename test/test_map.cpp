@@ -0,0 +1,129 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace data::map;
+
+
+TEST_CASE("Map span tests match per-tile collision data")
+{
+  // Tile 1: solid top, tile 2: solid left + right, tile 3: fully solid
+  Map map{150, 70, TileAttributeDict{{0x0, 0x1, 0xC, 0xF}}};
+
+  map.setTileAt(0, 3, 5, 1);
+  map.setTileAt(0, 64, 5, 2);
+  map.setTileAt(1, 100, 5, 3);
+  map.setTileAt(0, 130, 66, 3);
+
+  // Composite tile, not solid
+  map.setTileAt(0, 40, 5, 3);
+  map.setTileAt(1, 40, 5, 1);
+
+  const auto allEdges = {
+    SolidEdge::top(),
+    SolidEdge::bottom(),
+    SolidEdge::left(),
+    SolidEdge::right(),
+    SolidEdge::any()};
+
+  const auto rowMatches = [&](int startX, int endX, int y) {
+    for (const auto edge : allEdges)
+    {
+      auto expected = false;
+      for (auto x = startX; x <= endX; ++x)
+      {
+        expected = expected || map.collisionData(x, y).isSolidOn(edge);
+      }
+
+      if (map.isSolidInRow(startX, endX, y, edge) != expected)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  const auto columnMatches = [&](int x, int startY, int endY) {
+    for (const auto edge : allEdges)
+    {
+      auto expected = false;
+      for (auto y = startY; y <= endY; ++y)
+      {
+        expected = expected || map.collisionData(x, y).isSolidOn(edge);
+      }
+
+      if (map.isSolidInColumn(x, startY, endY, edge) != expected)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  SECTION("Horizontal spans")
+  {
+    CHECK(map.isSolidInRow(0, 10, 5, SolidEdge::top()));
+    CHECK(!map.isSolidInRow(0, 10, 5, SolidEdge::left()));
+    CHECK(!map.isSolidInRow(4, 63, 5, SolidEdge::any()));
+    CHECK(map.isSolidInRow(4, 64, 5, SolidEdge::right()));
+
+    for (auto start = -2; start < 152; start += 7)
+    {
+      for (auto length : {0, 1, 5, 63, 64, 65, 140})
+      {
+        for (auto y : {-1, 4, 5, 66, 70})
+        {
+          CHECK(rowMatches(start, start + length - 1, y));
+        }
+      }
+    }
+  }
+
+  SECTION("Vertical spans")
+  {
+    for (auto start = -3; start < 72; start += 5)
+    {
+      for (auto length : {0, 1, 5, 63, 64, 65, 80})
+      {
+        for (auto x : {-1, 3, 64, 100, 130, 150})
+        {
+          CHECK(columnMatches(x, start, start + length - 1));
+        }
+      }
+    }
+  }
+
+  SECTION("Span tests reflect changes to the map")
+  {
+    map.clearSection(0, 0, 150, 70);
+    CHECK(!map.isSolidInRow(0, 149, 5, SolidEdge::any()));
+    CHECK(!map.isSolidInColumn(130, 0, 69, SolidEdge::any()));
+
+    map.setTileAt(1, 149, 0, 3);
+    CHECK(map.isSolidInRow(0, 149, 0, SolidEdge::bottom()));
+    CHECK(map.isSolidInColumn(149, 0, 69, SolidEdge::bottom()));
+  }
+}
@@ -0,0 +1,73 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <assets/file_utils.hpp>
+#include <assets/mapped_file.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <filesystem>
+#include <stdexcept>
+
+
+using namespace rigel;
+using assets::ByteBuffer;
+using assets::MappedFile;
+
+namespace fs = std::filesystem;
+
+
+TEST_CASE("Mapped file gives access to file contents")
+{
+  const auto path = fs::temp_directory_path() / "rigel_test_mapped_file.bin";
+
+  SECTION("Regular file")
+  {
+    const auto contents = ByteBuffer{0x52, 0x69, 0x67, 0x65, 0x6C, 0x00, 0xFF};
+    assets::saveToFile(contents, path);
+
+    {
+      const auto file = MappedFile{path};
+      const auto data = file.data();
+
+      CHECK(ByteBuffer(data.begin(), data.end()) == contents);
+    }
+
+    fs::remove(path);
+  }
+
+  SECTION("Empty file")
+  {
+    assets::saveToFile(ByteBuffer{}, path);
+
+    {
+      const auto file = MappedFile{path};
+      CHECK(file.data().empty());
+    }
+
+    fs::remove(path);
+  }
+
+  SECTION("Missing file")
+  {
+    fs::remove(path);
+    CHECK_THROWS_AS(MappedFile{path}, std::runtime_error);
+  }
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/parallel_for.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <stdexcept>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("parallelFor invokes function once for each index")
+{
+  SECTION("Many indices")
+  {
+    auto counts = std::vector<int>(1000, 0);
+    base::parallelFor(counts.size(), [&](const std::size_t i) { ++counts[i]; });
+
+    CHECK(counts == std::vector<int>(1000, 1));
+  }
+
+  SECTION("Single index")
+  {
+    auto counts = std::vector<int>(1, 0);
+    base::parallelFor(counts.size(), [&](const std::size_t i) { ++counts[i]; });
+
+    CHECK(counts == std::vector<int>{1});
+  }
+
+  SECTION("No indices")
+  {
+    auto numCalls = 0;
+    base::parallelFor(0, [&](std::size_t) { ++numCalls; });
+
+    CHECK(numCalls == 0);
+  }
+}
+
+
+TEST_CASE("parallelFor propagates exceptions")
+{
+  auto invoke = []() {
+    base::parallelFor(100, [](const std::size_t i) {
+      if (i == 42)
+      {
+        throw std::runtime_error("Failed");
+      }
+    });
+  };
+
+  CHECK_THROWS_AS(invoke(), std::runtime_error);
+}
@@ -0,0 +1,130 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/profiler.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <string>
+
+
+using namespace rigel;
+namespace profiler = base::profiler;
+
+
+TEST_CASE("Profiler records nested scopes per frame")
+{
+  // Enabling starts recording the first frame
+  profiler::setEnabled(true);
+
+  {
+    RIGEL_PROFILE_SCOPE("Outer");
+    {
+      RIGEL_PROFILE_SCOPE("Inner");
+    }
+  }
+  profiler::beginFrame();
+
+  profiler::setEnabled(false);
+
+  const auto frames = profiler::recordedFrames();
+  REQUIRE(frames.size() == 1);
+
+  const auto& samples = frames[0].mSamples;
+  REQUIRE(samples.size() == 2);
+
+  // Samples are recorded when the scope ends, so the inner one comes first
+  CHECK(std::string{samples[0].mpName} == "Inner");
+  CHECK(samples[0].mDepth == 1);
+  CHECK(std::string{samples[1].mpName} == "Outer");
+  CHECK(samples[1].mDepth == 0);
+
+  CHECK(samples[1].mStartNs <= samples[0].mStartNs);
+  CHECK(samples[1].mDurationNs >= samples[0].mDurationNs);
+  CHECK(samples[0].mThreadIndex == 0);
+}
+
+
+TEST_CASE("Profiler keeps only the most recent frames")
+{
+  profiler::setEnabled(true);
+
+  for (auto i = 0; i < profiler::NUM_RECORDED_FRAMES + 10; ++i)
+  {
+    if (i % 2 == 0)
+    {
+      RIGEL_PROFILE_SCOPE("Even");
+    }
+
+    profiler::beginFrame();
+  }
+
+  profiler::setEnabled(false);
+
+  const auto frames = profiler::recordedFrames();
+  REQUIRE(frames.size() == profiler::NUM_RECORDED_FRAMES);
+
+  for (auto i = 1u; i < frames.size(); ++i)
+  {
+    CHECK(frames[i - 1].mStartNs <= frames[i].mStartNs);
+  }
+
+  // The last frame recorded was an odd one
+  CHECK(frames.back().mSamples.empty());
+  CHECK(frames[frames.size() - 2].mSamples.size() == 1);
+}
+
+
+TEST_CASE("Profiler doesn't record anything when disabled")
+{
+  profiler::setEnabled(true);
+  profiler::setEnabled(false);
+
+  profiler::beginFrame();
+  {
+    RIGEL_PROFILE_SCOPE("Ignored");
+  }
+  profiler::beginFrame();
+
+  CHECK(profiler::recordedFrames().empty());
+}
+
+
+TEST_CASE("Profiler keeps track of the innermost active scope")
+{
+  profiler::setEnabled(true);
+
+  CHECK(profiler::currentScope() == nullptr);
+
+  {
+    RIGEL_PROFILE_SCOPE("Outer");
+    CHECK(std::string{profiler::currentScope()} == "Outer");
+
+    {
+      RIGEL_PROFILE_SCOPE("Inner");
+      CHECK(std::string{profiler::currentScope()} == "Inner");
+    }
+
+    CHECK(std::string{profiler::currentScope()} == "Outer");
+  }
+
+  CHECK(profiler::currentScope() == nullptr);
+
+  profiler::setEnabled(false);
+}
@@ -0,0 +1,112 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <data/player_model.hpp>
+#include <game_logic_common/rewind_history.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using game_logic::RewindHistory;
+
+using Bytes = std::vector<std::uint8_t>;
+
+
+TEST_CASE("Rewinding restores the player's inventory")
+{
+  RewindHistory history{10};
+  data::PersistentPlayerState playerState;
+
+  history.push(Bytes{1, 2, 3}, playerState);
+
+  // Picking up an item changes only the persistent player state
+  playerState.giveItem(data::InventoryItemType::BlueKey);
+  history.push(Bytes{1, 2, 3}, playerState);
+
+  playerState.giveItem(data::InventoryItemType::CircuitBoard);
+
+  REQUIRE(history.size() == 2);
+
+  playerState = history.newestPlayerState();
+  history.dropNewest();
+  CHECK(playerState.hasItem(data::InventoryItemType::BlueKey));
+  CHECK(!playerState.hasItem(data::InventoryItemType::CircuitBoard));
+
+  playerState = history.newestPlayerState();
+  history.dropNewest();
+  CHECK(playerState.inventory().empty());
+  CHECK(history.empty());
+}
+
+
+TEST_CASE("Rewind history discards player state along with oldest entry")
+{
+  RewindHistory history{2};
+  data::PersistentPlayerState playerState;
+
+  playerState.giveScore(1);
+  history.push(Bytes{1}, playerState);
+  playerState.giveScore(1);
+  history.push(Bytes{2}, playerState);
+  playerState.giveScore(1);
+  history.push(Bytes{3}, playerState);
+
+  REQUIRE(history.size() == 2);
+  CHECK(history.newestState() == Bytes{3});
+  CHECK(history.newestPlayerState().score() == 3);
+
+  history.dropNewest();
+  CHECK(history.newestState() == Bytes{2});
+  CHECK(history.newestPlayerState().score() == 2);
+}
+
+
+TEST_CASE("Map tiles are restored, reporting only changed tiles")
+{
+  data::map::Map map{20, 10, data::map::TileAttributeDict{{0x0, 0x0, 0x0}}};
+  map.setTileAt(0, 3, 4, 1);
+  map.setTileAt(1, 5, 6, 2);
+
+  Bytes buffer{0xAB};
+  game_logic::appendMapTiles(map, buffer);
+
+  map.setTileAt(0, 3, 4, 0);
+  map.setTileAt(1, 5, 6, 1);
+  map.setTileAt(1, 7, 2, 2);
+
+  std::vector<base::Vec2> changedPositions;
+  const auto pEnd = game_logic::restoreMapTiles(
+    buffer.data() + 1, map, [&](const base::Vec2& position) {
+      changedPositions.push_back(position);
+    });
+
+  CHECK(pEnd == buffer.data() + buffer.size());
+  CHECK(map.tileAt(0, 3, 4) == 1);
+  CHECK(map.tileAt(1, 5, 6) == 2);
+  CHECK(map.tileAt(1, 7, 2) == 0);
+
+  const auto expected = std::vector<base::Vec2>{
+    base::Vec2{3, 4}, base::Vec2{7, 2}, base::Vec2{5, 6}};
+  CHECK(changedPositions == expected);
+}
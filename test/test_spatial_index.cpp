@@ -0,0 +1,111 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/spatial_index.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch2/catch_test_macros.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+TEST_CASE("Spatial index finds intersecting entities")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  auto entity1 = entities.create();
+  auto entity2 = entities.create();
+  auto entity3 = entities.create();
+  auto entity4 = entities.create();
+
+  SpatialIndex index;
+
+  using Result = std::vector<ex::Entity>;
+
+  SECTION("Empty index returns nothing")
+  {
+    index.build();
+    CHECK(index.empty());
+    CHECK(index.entitiesIntersecting(BoundingBox{{0, 0}, {10, 10}}).empty());
+  }
+
+  SECTION("Only intersecting entities are returned")
+  {
+    index.insert(entity1, BoundingBox{{0, 0}, {2, 2}});
+    index.insert(entity2, BoundingBox{{100, 50}, {3, 1}});
+    index.insert(entity3, BoundingBox{{4, 0}, {2, 2}});
+    index.build();
+
+    CHECK(index.entitiesIntersecting(BoundingBox{{1, 1}, {2, 2}}) ==
+      Result{entity1});
+    CHECK(index.entitiesIntersecting(BoundingBox{{102, 50}, {1, 1}}) ==
+      Result{entity2});
+    CHECK(index.entitiesIntersecting(BoundingBox{{2, 0}, {2, 2}}).empty());
+    CHECK(index.entitiesIntersecting(BoundingBox{{0, 0}, {6, 1}}) ==
+      Result{entity1, entity3});
+  }
+
+  SECTION("Results are in insertion order")
+  {
+    index.insert(entity4, BoundingBox{{30, 30}, {2, 2}});
+    index.insert(entity2, BoundingBox{{0, 0}, {40, 40}});
+    index.insert(entity1, BoundingBox{{5, 5}, {1, 1}});
+    index.insert(entity3, BoundingBox{{31, 0}, {1, 32}});
+    index.build();
+
+    CHECK(index.entitiesIntersecting(BoundingBox{{0, 0}, {40, 40}}) ==
+      Result{entity4, entity2, entity1, entity3});
+    CHECK(index.entitiesIntersecting(BoundingBox{{31, 31}, {1, 1}}) ==
+      Result{entity4, entity2, entity3});
+  }
+
+  SECTION("Query areas outside of the indexed area work")
+  {
+    index.insert(entity1, BoundingBox{{10, 10}, {2, 2}});
+    index.insert(entity2, BoundingBox{{-20, -5}, {30, 2}});
+    index.build();
+
+    CHECK(index.entitiesIntersecting(BoundingBox{{-100, -100}, {5, 5}})
+            .empty());
+    CHECK(index.entitiesIntersecting(BoundingBox{{-50, -4}, {40, 1}}) ==
+      Result{entity2});
+    CHECK(index.entitiesIntersecting(BoundingBox{{0, 0}, {500, 500}}) ==
+      Result{entity1});
+  }
+
+  SECTION("Index can be rebuilt")
+  {
+    index.insert(entity1, BoundingBox{{0, 0}, {2, 2}});
+    index.build();
+    index.clear();
+    index.insert(entity2, BoundingBox{{0, 0}, {2, 2}});
+    index.build();
+
+    CHECK(index.entitiesIntersecting(BoundingBox{{0, 0}, {1, 1}}) ==
+      Result{entity2});
+  }
+}